@@ -0,0 +1,62 @@
+#include <bench_utils.hh>
+#include <random>
+#include <ray.hh>
+#include <vector>
+using namespace RayTracer;
+
+/*
+  Micro benchmark of the indexed accessors and of `Ray` construction.
+  The same source is built twice: `bench_access_checked` keeps the bounds and
+  argument checks, `bench_access_unchecked` defines RAYTRACER_UNCHECKED to
+  get raw accesses, compare the two outputs side by side.
+*/
+int main() {
+  constexpr std::size_t count = 1 << 12;
+  constexpr std::size_t iterations = 1 << 22;
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<Real> dist(-10.0, 10.0);
+
+  std::vector<Tuple> points(count), vectors(count);
+  std::vector<Vec<Real, 8>> wide(count);
+  std::vector<TransformMatrix> matrices(count);
+  for (std::size_t i = 0; i < count; i++) {
+    points[i] = MakePoint(dist(gen), dist(gen), dist(gen));
+    vectors[i] = MakeVector(dist(gen), dist(gen), dist(gen));
+    for (std::size_t j = 0; j < wide[i].size(); j++)
+      wide[i][j] = dist(gen);
+    matrices[i] = MatrixUtils::RotateY(dist(gen)) *
+                  MatrixUtils::Translation(dist(gen), dist(gen), dist(gen));
+  }
+  const auto at = [](const auto& list, std::size_t i) -> decltype(auto) {
+    return list[i & (count - 1)];
+  };
+  const auto run = [](const char* name, auto&& op) {
+    const double ns = BenchUtils::MeasureNs(
+        [&](std::size_t i) { BenchUtils::DoNotOptimize(op(i)); }, iterations);
+    BenchUtils::Report(name, ns);
+  };
+
+  std::printf("Checks: %s\n", Checks::Enabled ? "on" : "off");
+  // clang-format off
+  run("Tuple lane sum", [&](std::size_t i) {
+    const Tuple& t = at(points, i);
+    return t[0] + t[1] + t[2] + t[3];
+  });
+  run("Vec<8> dot", [&](std::size_t i) { return at(wide, i).DotProduct(at(wide, i + 1)); });
+  run("Vec<8> indexed write", [&](std::size_t i) {
+    Vec<Real, 8> v = at(wide, i);
+    for (std::size_t j = 0; j < v.size(); j++)
+      v[j] *= v[(j + 1) % v.size()];
+    return v;
+  });
+  run("Matrix row x column", [&](std::size_t i) {
+    const TransformMatrix& m = at(matrices, i);
+    return m.Row(i & 3).DotProduct(m.Column((i + 1) & 3));
+  });
+  run("Matrix * Tuple", [&](std::size_t i) { return at(matrices, i) * at(points, i); });
+  run("Ray construct", [&](std::size_t i) { return Ray(at(points, i), at(vectors, i)); });
+  run("Ray transform", [&](std::size_t i) {
+    return Ray(at(points, i), at(vectors, i)).Transform(Transform(at(matrices, i)));
+  });
+  // clang-format on
+}
@@ -0,0 +1,77 @@
+#include <accel/bvh.hh>
+#include <accel/wide_bvh.hh>
+#include <bench_utils.hh>
+#include <camera.hh>
+#include <vector>
+#include <world.hh>
+using namespace RayTracer;
+
+/*
+  Frame time of a World against its number of shapes, with the linear scan,
+  the SAH BVH, the Morton LBVH and the 4/8-wide BVHs collapsed from the SAH
+  one. Random spheres fill a fixed cube above a
+  floor plane, their radius shrinking with the count so that the image stays
+  comparable. Prints one CSV row per shape count, ready to be plotted as
+  ms/frame against objects (the linear scan is skipped past `maxLinear`
+  shapes), along with the build time of both hierarchies and their build
+  throughput in millions of shapes per second on all cores.
+*/
+namespace {
+
+constexpr std::size_t width = 64;
+constexpr std::size_t height = 48;
+constexpr std::size_t maxLinear = 1 << 14;
+
+}  // namespace
+
+int main() {
+  using Shapes = std::vector<ShapeWrapper>;
+  using Lights = std::array<PointLight, 1>;
+  const Lights lights = {
+      PointLight(MakePoint(-20, 30, -30), MakeColour(1, 1, 1))};
+  const Camera camera{
+      width, height, MathUtils::MathConstants::PI<Real> / 3,
+      MatrixUtils::ViewTransform(MakePoint(0, 5, -30), MakePoint(0, 0, 0),
+                                 MakeVector(0, 1, 0))};
+
+  std::printf("# %zux%zu frame, ms/frame, %zu threads\n", width, height,
+              ParallelUtils::NumThreads());
+  std::printf(
+      "objects,linear_ms,bvh_ms,lbvh_ms,bvh4_ms,bvh8_ms,bvh_build_ms,"
+      "lbvh_build_ms,bvh_mprims_per_s,lbvh_mprims_per_s\n");
+  for (std::size_t count = 16; count <= (1 << 18); count *= 4) {
+    const Shapes shapes = BenchUtils::MakeShapes(count);
+    const auto buildMs = [&](auto accel) {
+      using Accel = decltype(accel);
+      return BenchUtils::MeasureNs(
+                 [&](std::size_t) { BenchUtils::DoNotOptimize(Accel{shapes}); },
+                 1, 3) /
+             1e6;
+    };
+    const double bvhBuildMs = buildMs(BVH{});
+    const double lbvhBuildMs = buildMs(LBVH{});
+    const World<Shapes, Lights, 10, BVH> bvhWorld{Shapes(shapes),
+                                                  Lights(lights)};
+    const World<Shapes, Lights, 10, LBVH> lbvhWorld{Shapes(shapes),
+                                                    Lights(lights)};
+    const World<Shapes, Lights, 10, BVH4> bvh4World{Shapes(shapes),
+                                                    Lights(lights)};
+    const World<Shapes, Lights, 10, BVH8> bvh8World{Shapes(shapes),
+                                                    Lights(lights)};
+    const auto frameMs = [&](const auto& world) {
+      return BenchUtils::FrameMs(world, camera, width, height);
+    };
+    const double bvhMs = frameMs(bvhWorld);
+    const double lbvhMs = frameMs(lbvhWorld);
+    const double bvh4Ms = frameMs(bvh4World);
+    const double bvh8Ms = frameMs(bvh8World);
+    std::printf("%zu,", count);
+    if (count <= maxLinear) {
+      const World<Shapes, Lights> linearWorld{Shapes(shapes), Lights(lights)};
+      std::printf("%.3f", frameMs(linearWorld));
+    }
+    std::printf(",%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,%.2f\n", bvhMs, lbvhMs,
+                bvh4Ms, bvh8Ms, bvhBuildMs, lbvhBuildMs,
+                count / bvhBuildMs / 1e3, count / lbvhBuildMs / 1e3);
+  }
+}
@@ -0,0 +1,98 @@
+#include <accel/bvh.hh>
+#include <accel/grid.hh>
+#include <bench_utils.hh>
+#include <camera.hh>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <world.hh>
+using namespace RayTracer;
+
+/*
+  Particle scenes: spheres of one size, either filling a cube ("uniform") or
+  gathered in a few small clusters far apart ("clusters"), rendered with the
+  linear scan (skipped past `maxLinear` particles), the dense and hashed grids
+  and the SAH BVH for reference. Prints one CSV row per scene and particle
+  count, with the frame and build times of each structure.
+*/
+namespace {
+
+constexpr std::size_t width = 64;
+constexpr std::size_t height = 48;
+constexpr std::size_t maxLinear = 1 << 12;
+constexpr std::size_t numClusters = 6;
+
+std::vector<ShapeWrapper> MakeParticles(std::size_t count, bool clustered) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<Real> position(-10, 10);
+  std::uniform_real_distribution<Real> spread(-1, 1);
+  std::vector<Tuple> centres;
+  for (std::size_t i = 0; i < numClusters; i++)
+    centres.push_back(MakePoint(position(gen), position(gen), position(gen)));
+  // same particle count per unit volume in both scenes
+  const Real side = clustered ? 2 * std::cbrt(Real(numClusters)) : 20;
+  const Real radius = side / 10 / std::cbrt(static_cast<Real>(count));
+  std::vector<ShapeWrapper> shapes;
+  shapes.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    const Tuple centre =
+        clustered ? centres[i % numClusters] +
+                        MakeVector(spread(gen), spread(gen), spread(gen))
+                  : MakePoint(position(gen), position(gen), position(gen));
+    shapes.emplace_back(Sphere{Transform(
+        MatrixUtils::Translation(centre[0], centre[1], centre[2]) *
+        MatrixUtils::Scale(radius, radius, radius))});
+  }
+  return shapes;
+}
+
+}  // namespace
+
+int main() {
+  using Shapes = std::vector<ShapeWrapper>;
+  using Lights = std::array<PointLight, 1>;
+  const Lights lights = {
+      PointLight(MakePoint(-20, 30, -30), MakeColour(1, 1, 1))};
+  const Camera camera{
+      width, height, MathUtils::MathConstants::PI<Real> / 3,
+      MatrixUtils::ViewTransform(MakePoint(0, 5, -30), MakePoint(0, 0, 0),
+                                 MakeVector(0, 1, 0))};
+
+  const auto frameMs = [&](const auto& world) {
+    return BenchUtils::FrameMs(world, camera, width, height);
+  };
+
+  std::printf("# %zux%zu frame, ms/frame\n", width, height);
+  std::printf(
+      "scene,objects,linear_ms,grid_ms,hashed_ms,bvh_ms,grid_build_ms,"
+      "hashed_build_ms,bvh_build_ms\n");
+  for (const bool clustered : {false, true}) {
+    for (std::size_t count = 1 << 10; count <= (1 << 18); count *= 4) {
+      const Shapes shapes = MakeParticles(count, clustered);
+      const auto buildMs = [&](auto accel) {
+        using Accel = decltype(accel);
+        return BenchUtils::MeasureNs(
+                   [&](std::size_t) {
+                     BenchUtils::DoNotOptimize(Accel{shapes});
+                   },
+                   1, 3) /
+               1e6;
+      };
+      const World<Shapes, Lights, 10, UniformGrid> gridWorld{Shapes(shapes),
+                                                             Lights(lights)};
+      const World<Shapes, Lights, 10, HashedGrid> hashedWorld{Shapes(shapes),
+                                                              Lights(lights)};
+      const World<Shapes, Lights, 10, BVH> bvhWorld{Shapes(shapes),
+                                                    Lights(lights)};
+      std::printf("%s,%zu,", clustered ? "clusters" : "uniform", count);
+      if (count <= maxLinear) {
+        const World<Shapes, Lights> linearWorld{Shapes(shapes), Lights(lights)};
+        std::printf("%.3f", frameMs(linearWorld));
+      }
+      std::printf(",%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+                  frameMs(gridWorld), frameMs(hashedWorld), frameMs(bvhWorld),
+                  buildMs(UniformGrid{}),
+                  buildMs(HashedGrid{}), buildMs(BVH{}));
+    }
+  }
+}
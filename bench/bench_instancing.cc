@@ -0,0 +1,127 @@
+#include <accel/bvh.hh>
+#include <accel/instancing.hh>
+#include <bench_utils.hh>
+#include <camera.hh>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <world.hh>
+using namespace RayTracer;
+
+/*
+  An asset of `assetSize` spheres scattered many times, either flattened
+  into one world holding a transformed copy of every sphere, or referenced by
+  one `Instance` per copy over a shared geometry. Reports the build time and
+  memory of the hierarchies and shapes, and the frame time of each world.
+*/
+namespace {
+
+constexpr std::size_t assetSize = 200;
+constexpr std::size_t width = 64;
+constexpr std::size_t height = 48;
+
+using Shapes = std::vector<ShapeWrapper>;
+using Lights = std::array<PointLight, 1>;
+
+/* A rough ball of spheres of radius 1 around the origin */
+Shapes MakeAsset() {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<Real> position(-0.8, 0.8);
+  Shapes shapes;
+  for (std::size_t i = 0; i < assetSize; i++) {
+    shapes.emplace_back(Sphere{Transform(
+        MatrixUtils::Translation(position(gen), position(gen), position(gen)) *
+        MatrixUtils::Scale(0.15, 0.15, 0.15))});
+  }
+  return shapes;
+}
+
+std::vector<Transform> MakePlacements(std::size_t count) {
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<Real> position(-10, 10);
+  std::uniform_real_distribution<Real> angle(0, 6.28);
+  const Real scale = Real(4) / std::cbrt(static_cast<Real>(count));
+  std::vector<Transform> placements;
+  for (std::size_t i = 0; i < count; i++) {
+    placements.push_back(Transform(
+        MatrixUtils::Translation(position(gen), position(gen), position(gen)) *
+        MatrixUtils::RotateY(angle(gen)) *
+        MatrixUtils::Scale(scale, scale, scale)));
+  }
+  return placements;
+}
+
+Shapes Flatten(const Shapes& asset, const std::vector<Transform>& placements) {
+  Shapes shapes;
+  shapes.reserve(asset.size() * placements.size());
+  for (const Transform& placement : placements) {
+    for (const ShapeWrapper& shape : asset) {
+      ShapeWrapper copy = shape;
+      copy.SetTransform(Transform(placement * shape.GetTransform()));
+      shapes.push_back(copy);
+    }
+  }
+  return shapes;
+}
+
+Shapes Instantiate(const Geometry& geometry,
+                   const std::vector<Transform>& placements) {
+  Shapes shapes;
+  shapes.reserve(placements.size());
+  for (const Transform& placement : placements)
+    shapes.emplace_back(Instance{geometry, placement});
+  return shapes;
+}
+
+/* Bytes held by the shapes and the hierarchy over them */
+std::size_t MemoryBytes(const Shapes& shapes, const BVH& bvh) {
+  return shapes.size() * sizeof(ShapeWrapper) +
+         bvh.GetNodes().size() * sizeof(BVHNode) +
+         (bvh.GetShapeIndices().size() + bvh.GetUnbounded().size()) *
+             sizeof(std::uint32_t);
+}
+
+}  // namespace
+
+int main() {
+  const Camera camera{
+      width, height, MathUtils::MathConstants::PI<Real> / 3,
+      MatrixUtils::ViewTransform(MakePoint(0, 5, -30), MakePoint(0, 0, 0),
+                                 MakeVector(0, 1, 0))};
+  const Lights lights{PointLight(MakePoint(-20, 30, -30), MakeColour(1, 1, 1))};
+  const Shapes asset = MakeAsset();
+  const SharedGeometry geometry{asset};
+  const std::size_t geometryBytes =
+      MemoryBytes(geometry.GetShapes(), geometry.GetAccelerator());
+
+  std::printf("# asset of %zu spheres, build ms, memory KiB, ms per frame\n",
+              assetSize);
+  std::printf(
+      "copies,flat_build_ms,instanced_build_ms,flat_kib,instanced_kib,"
+      "flat_frame_ms,instanced_frame_ms\n");
+  for (std::size_t copies : {10, 100, 1000, 5000}) {
+    const std::vector<Transform> placements = MakePlacements(copies);
+    const Shapes flat = Flatten(asset, placements);
+    const Shapes instances = Instantiate(geometry, placements);
+    const auto timeMs = [](auto&& func) {
+      return BenchUtils::MeasureNs([&](std::size_t) { func(); }, 1, 3) / 1e6;
+    };
+    const double flatBuildMs =
+        timeMs([&] { BenchUtils::DoNotOptimize(BVH{flat}); });
+    const double instancedBuildMs =
+        timeMs([&] { BenchUtils::DoNotOptimize(BVH{instances}); });
+
+    World<Shapes, Lights, 10, BVH> flatWorld{Shapes(flat), Lights(lights)};
+    World<Shapes, Lights, 10, BVH> instancedWorld{Shapes(instances),
+                                                  Lights(lights)};
+    const double flatKiB = MemoryBytes(flatWorld.shapes, flatWorld.accel) / 1024.;
+    const double instancedKiB =
+        (MemoryBytes(instancedWorld.shapes, instancedWorld.accel) +
+         geometryBytes) /
+        1024.;
+    std::printf("%zu,%.3f,%.3f,%.1f,%.1f,%.3f,%.3f\n", copies, flatBuildMs,
+                instancedBuildMs, flatKiB, instancedKiB,
+                BenchUtils::FrameMs(flatWorld, camera, width, height),
+                BenchUtils::FrameMs(instancedWorld, camera, width, height));
+  }
+}
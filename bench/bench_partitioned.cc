@@ -0,0 +1,64 @@
+#include <accel/linear.hh>
+#include <accel/partitioned.hh>
+#include <bench_utils.hh>
+#include <random>
+#include <vector>
+using namespace RayTracer;
+
+/*
+  Cost of one closest-hit and one shadow-ray query against every shape, with
+  the shapes visited through their `ShapeWrapper` (LinearAccel) or through
+  the per-type SoA buffers of PartitionedAccel. Random spheres fill a cube
+  above a floor plane; prints ns per ray as CSV against the shape count.
+*/
+namespace {
+
+constexpr std::size_t numRays = 256;
+
+std::vector<Ray> MakeRays() {
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<Real> offset(-10, 10);
+  std::vector<Ray> rays;
+  for (std::size_t i = 0; i < numRays; i++) {
+    rays.emplace_back(MakePoint(0, 5, -30),
+                      ToNormalizedVector(MakePoint(offset(gen), offset(gen), 0) -
+                                         MakePoint(0, 5, -30)),
+                      Real(EPSILON), Real(40));
+  }
+  return rays;
+}
+
+template <typename Accel>
+std::pair<double, double> QueryNs(const std::vector<ShapeWrapper>& shapes,
+                                  const std::vector<Ray>& rays) {
+  const Accel accel{shapes};
+  const double closestNs = BenchUtils::MeasureNs(
+      [&](std::size_t i) {
+        BenchUtils::DoNotOptimize(accel.ClosestHit(shapes, rays[i % numRays]));
+      },
+      numRays * 4);
+  const double occludedNs = BenchUtils::MeasureNs(
+      [&](std::size_t i) {
+        BenchUtils::DoNotOptimize(accel.Occluded(shapes, rays[i % numRays]));
+      },
+      numRays * 4);
+  return {closestNs, occludedNs};
+}
+
+}  // namespace
+
+int main() {
+  const std::vector<Ray> rays = MakeRays();
+  std::printf("# ns per ray\n");
+  std::printf(
+      "objects,linear_closest_ns,partitioned_closest_ns,linear_occluded_ns,"
+      "partitioned_occluded_ns\n");
+  for (std::size_t count = 16; count <= 4096; count *= 4) {
+    const std::vector<ShapeWrapper> shapes = BenchUtils::MakeShapes(count);
+    const auto [linearClosest, linearOccluded] =
+        QueryNs<LinearAccel>(shapes, rays);
+    const auto [closest, occluded] = QueryNs<PartitionedAccel>(shapes, rays);
+    std::printf("%zu,%.1f,%.1f,%.1f,%.1f\n", count, linearClosest, closest,
+                linearOccluded, occluded);
+  }
+}
@@ -0,0 +1,69 @@
+#include <accel/bvh.hh>
+#include <bench_utils.hh>
+#include <camera.hh>
+#include <random>
+#include <vector>
+#include <world.hh>
+using namespace RayTracer;
+
+/*
+  Per-frame cost of keeping a hierarchy up to date in an animated scene of
+  `numShapes` spheres, every one of them moving a little between frames:
+  full SAH and LBVH builds against `Refit`, and the frame time of the
+  refitted tree against a freshly built one over the last frame.
+*/
+namespace {
+
+constexpr std::size_t numShapes = 100000;
+constexpr std::size_t numFrames = 8;
+constexpr std::size_t width = 64;
+constexpr std::size_t height = 48;
+
+/* Move every sphere by a small random step, as one frame of animation */
+void Animate(std::vector<ShapeWrapper>& shapes, std::mt19937& gen) {
+  std::uniform_real_distribution<Real> step(-0.05, 0.05);
+  for (std::size_t i = 1; i < shapes.size(); i++) {
+    shapes[i].SetTransform(
+        MatrixUtils::Translation(step(gen), step(gen), step(gen)) *
+        shapes[i].GetTransform());
+  }
+}
+
+}  // namespace
+
+int main() {
+  using Shapes = std::vector<ShapeWrapper>;
+  using Lights = std::array<PointLight, 1>;
+  const Camera camera{
+      width, height, MathUtils::MathConstants::PI<Real> / 3,
+      MatrixUtils::ViewTransform(MakePoint(0, 5, -30), MakePoint(0, 0, 0),
+                                 MakeVector(0, 1, 0))};
+  World<Shapes, Lights, 10, BVH> world{
+      BenchUtils::MakeShapes(numShapes),
+      Lights{PointLight(MakePoint(-20, 30, -30), MakeColour(1, 1, 1))}};
+
+  std::printf("# %zu shapes, %zu threads, ms per frame\n", numShapes,
+              ParallelUtils::NumThreads());
+  std::printf("frame,bvh_build_ms,lbvh_build_ms,refit_ms,rebuilt,sah_ratio\n");
+  std::mt19937 gen(7);
+  for (std::size_t frame = 0; frame < numFrames; frame++) {
+    Animate(world.shapes, gen);
+    const auto timeMs = [](auto&& func) {
+      return BenchUtils::MeasureNs([&](std::size_t) { func(); }, 1, 3) / 1e6;
+    };
+    const double bvhBuildMs =
+        timeMs([&] { BenchUtils::DoNotOptimize(BVH{world.shapes}); });
+    const double lbvhBuildMs =
+        timeMs([&] { BenchUtils::DoNotOptimize(LBVH{world.shapes}); });
+    const double refitMs = timeMs([&] { world.accel.Refit(world.shapes); });
+    const bool rebuilt = world.UpdateAccelerator();
+    const BVH& bvh = world.GetAccelerator();
+    std::printf("%zu,%.3f,%.3f,%.3f,%d,%.3f\n", frame, bvhBuildMs, lbvhBuildMs,
+                refitMs, rebuilt, bvh.SAHCost() / bvh.BuiltSAHCost());
+  }
+
+  const double refittedMs = BenchUtils::FrameMs(world, camera, width, height);
+  world.accel.Build(world.shapes);
+  std::printf("# frame time, refitted %.3f ms, rebuilt %.3f ms\n", refittedMs,
+              BenchUtils::FrameMs(world, camera, width, height));
+}
@@ -0,0 +1,74 @@
+#include <bench_utils.hh>
+#include <camera.hh>
+#include <cmath>
+#include <world.hh>
+using namespace RayTracer;
+
+/*
+  Fixed scenes of `N` spheres in a ring above a floor and in front of a back
+  wall, rendered by a `World` of `ShapeWrapper`s and by a `TypedWorld` of the
+  same shapes grouped by type. Prints ms per frame as CSV against `N`.
+*/
+namespace {
+
+constexpr std::size_t width = 160;
+constexpr std::size_t height = 120;
+
+template <std::size_t N>
+std::array<Sphere, N> MakeSpheres() {
+  std::array<Sphere, N> spheres;
+  const Real radius = Real(4) / static_cast<Real>(N);
+  for (std::size_t i = 0; i < N; i++) {
+    const Real angle = 2 * MathUtils::MathConstants::PI<Real> *
+                       static_cast<Real>(i) / static_cast<Real>(N);
+    spheres[i] = Sphere{Transform(
+        MatrixUtils::Translation(3 * std::cos(angle), radius,
+                                 3 * std::sin(angle)) *
+        MatrixUtils::Scale(radius, radius, radius))};
+  }
+  return spheres;
+}
+
+std::array<Plane, 2> MakePlanes() {
+  return {Plane{},
+          Plane{Transform(MatrixUtils::Translation(0, 0, 8) *
+                          MatrixUtils::RotateX(
+                              MathUtils::MathConstants::PI<Real> / 2))}};
+}
+
+template <std::size_t N>
+void Report(const Camera& camera) {
+  using Lights = std::array<PointLight, 1>;
+  const Lights lights = {
+      PointLight(MakePoint(-10, 10, -10), MakeColour(1, 1, 1))};
+  const std::array<Sphere, N> spheres = MakeSpheres<N>();
+  const std::array<Plane, 2> planes = MakePlanes();
+
+  auto wrapped = [&]<std::size_t... I>(std::index_sequence<I...>) {
+    return std::array<ShapeWrapper, N + 2>{ShapeWrapper{spheres[I]}...,
+                                           ShapeWrapper{planes[0]},
+                                           ShapeWrapper{planes[1]}};
+  }(std::make_index_sequence<N>{});
+  using Shapes = std::tuple<std::array<Sphere, N>, std::array<Plane, 2>>;
+  using Typed = TypedWorld<Shapes, Lights>;
+  const World<std::array<ShapeWrapper, N + 2>, Lights, Typed::NumXS> world{
+      std::move(wrapped), Lights(lights)};
+  const Typed typed{Shapes{spheres, planes}, Lights(lights)};
+  std::printf("%zu,%.3f,%.3f\n", N,
+              BenchUtils::FrameMs(world, camera, width, height, 5),
+              BenchUtils::FrameMs(typed, camera, width, height, 5));
+}
+
+}  // namespace
+
+int main() {
+  const Camera camera{
+      width, height, MathUtils::MathConstants::PI<Real> / 3,
+      MatrixUtils::ViewTransform(MakePoint(0, 4, -8), MakePoint(0, 0, 0),
+                                 MakeVector(0, 1, 0))};
+  std::printf("# %zux%zu frame, ms/frame\n", width, height);
+  std::printf("spheres,world_ms,typed_world_ms\n");
+  Report<4>(camera);
+  Report<16>(camera);
+  Report<64>(camera);
+}
@@ -0,0 +1,89 @@
+#ifndef BENCH_UTILS_HH
+#define BENCH_UTILS_HH
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <primitives.hh>
+#include <random>
+#include <string>
+#include <vector>
+namespace RayTracer {
+namespace BenchUtils {
+
+/* Keep the compiler from discarding a value computed inside a benchmark loop */
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/*!
+ * \brief Time `func` and return the best average wall time per call (in ns).
+ *
+ * \param func callable executed `iterations` times per repetition
+ * \param iterations number of calls per repetition
+ * \param repetitions number of repetitions, the fastest one is reported
+ */
+template <typename Func>
+double MeasureNs(Func&& func, std::size_t iterations,
+                 std::size_t repetitions = 5) {
+  using Clock = std::chrono::steady_clock;
+  double best = std::numeric_limits<double>::max();
+  for (std::size_t rep = 0; rep < repetitions; rep++) {
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < iterations; i++)
+      func(i);
+    const auto stop = Clock::now();
+    const double elapsed =
+        std::chrono::duration<double, std::nano>(stop - start).count();
+    best = std::min(best, elapsed / static_cast<double>(iterations));
+  }
+  return best;
+}
+
+/*!
+ * \brief Best wall time (in ms) to render a `width` x `height` frame of
+ * `world` through `camera`, one `ColorAt` per pixel.
+ */
+template <typename World, typename Camera>
+double FrameMs(const World& world, const Camera& camera, std::size_t width,
+               std::size_t height, std::size_t repetitions = 3) {
+  const double ns = MeasureNs(
+      [&](std::size_t) {
+        for (std::size_t y = 0; y < height; y++) {
+          for (std::size_t x = 0; x < width; x++)
+            DoNotOptimize(world.ColorAt(camera.RayForPixel(x, y)));
+        }
+      },
+      1, repetitions);
+  return ns / 1e6;
+}
+
+/*!
+ * \brief Scene of the acceleration structure benchmarks: a floor plane, then
+ * `count` random spheres filling a fixed cube above it, their radius
+ * shrinking with the count so that the image stays comparable.
+ */
+inline std::vector<ShapeWrapper> MakeShapes(std::size_t count) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<Real> position(-10, 10);
+  const Real radius = Real(2) / std::cbrt(static_cast<Real>(count));
+  std::vector<ShapeWrapper> shapes;
+  shapes.reserve(count + 1);
+  shapes.emplace_back(Plane{MatrixUtils::Translation(0, -11, 0)});
+  for (std::size_t i = 0; i < count; i++) {
+    shapes.emplace_back(Sphere{Transform(
+        MatrixUtils::Translation(position(gen), position(gen), position(gen)) *
+        MatrixUtils::Scale(radius, radius, radius))});
+  }
+  return shapes;
+}
+
+inline void Report(const std::string& name, double nsPerOp) {
+  std::printf("%-32s %10.3f ns/op\n", name.c_str(), nsPerOp);
+}
+
+}  // namespace BenchUtils
+}  // namespace RayTracer
+#endif
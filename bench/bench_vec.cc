@@ -0,0 +1,52 @@
+#include <bench_utils.hh>
+#include <random>
+#include <vec.hh>
+#include <vector>
+using namespace RayTracer;
+
+/*
+  Micro benchmark of the run-time `Tuple`/`Colour` operators.
+  The same source is built twice: `bench_vec_simd` uses the SIMD kernels and
+  `bench_vec_scalar` defines RAYTRACER_NO_SIMD to get the scalar fallback,
+  compare the two outputs side by side. Arithmetic yields lazy expressions,
+  so every case converts its result to force the evaluation.
+*/
+int main() {
+  constexpr std::size_t count = 1 << 12;
+  constexpr std::size_t iterations = 1 << 22;
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(-10.0, 10.0);
+
+  std::vector<Tuple> points(count), vectors(count);
+  std::vector<Colour> colours(count);
+  for (std::size_t i = 0; i < count; i++) {
+    points[i] = MakePoint(dist(gen), dist(gen), dist(gen));
+    vectors[i] = MakeVector(dist(gen), dist(gen), dist(gen));
+    colours[i] = MakeColour(dist(gen), dist(gen), dist(gen));
+  }
+  const auto at = [](const auto& list, std::size_t i) -> decltype(auto) {
+    return list[i & (count - 1)];
+  };
+  const auto run = [](const char* name, auto&& op) {
+    const double ns = BenchUtils::MeasureNs(
+        [&](std::size_t i) { BenchUtils::DoNotOptimize(op(i)); }, iterations);
+    BenchUtils::Report(name, ns);
+  };
+
+  std::printf("SIMD kernels: %s\n", SimdUtils::Enabled ? "on" : "off");
+  // clang-format off
+  run("Tuple add", [&](std::size_t i) { return Tuple(at(points, i) + at(vectors, i)); });
+  run("Tuple sub", [&](std::size_t i) { return Tuple(at(points, i) - at(vectors, i)); });
+  run("Tuple scale", [&](std::size_t i) { return Tuple(at(vectors, i) * 0.75); });
+  run("Tuple offset", [&](std::size_t i) { return Tuple(at(points, i) + at(vectors, i) * 0.75); });
+  run("Tuple over point", [&](std::size_t i) { return Tuple(at(points, i) - at(vectors, i) * 0.75 + at(vectors, i + 1) * 0.25); });
+  run("Tuple dot", [&](std::size_t i) { return at(vectors, i).DotProduct(at(vectors, i + 1)); });
+  run("Tuple cross", [&](std::size_t i) { return at(vectors, i).CrossProduct(at(vectors, i + 1)); });
+  run("Tuple normalize", [&](std::size_t i) { return at(vectors, i).Normalize(); });
+  run("Tuple reflect", [&](std::size_t i) { return at(vectors, i).Reflect(at(vectors, i + 1)); });
+  run("Colour add", [&](std::size_t i) { return Colour(at(colours, i) + at(colours, i + 1)); });
+  run("Colour hadamard", [&](std::size_t i) { return Colour(at(colours, i) * at(colours, i + 1)); });
+  run("Colour scale", [&](std::size_t i) { return Colour(at(colours, i) * 0.5); });
+  run("Colour phong sum", [&](std::size_t i) { return Colour(at(colours, i) * 0.1 + at(colours, i + 1) * 0.9 + at(colours, i + 2) * 0.3); });
+  // clang-format on
+}
@@ -0,0 +1,781 @@
+#ifndef ACCEL_BVH_HH
+#define ACCEL_BVH_HH
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <bounding_box.hh>
+#include <cstdint>
+#include <optional>
+#include <primitives.hh>
+#include <primitives/static_vector.hh>
+#include <type_traits>
+#include <utility>
+#include <utils/parallel.hh>
+#include <vector>
+namespace RayTracer {
+
+/*!
+ * \brief Node of a flattened BVH.
+ *
+ * Nodes are stored in depth-first order: the first child of an interior node
+ * directly follows it, so only the index of the second child is kept.
+ */
+struct BVHNode {
+  BoundingBox bounds;
+  /// leaf: first entry of its shapes in the BVH shape index list,
+  /// interior: index of the second child
+  std::uint32_t offset{0};
+  /// number of shapes of a leaf, 0 for an interior node
+  std::uint16_t count{0};
+  /// axis the children of an interior node were split along
+  std::uint8_t axis{0};
+
+  constexpr bool IsLeaf() const noexcept { return count > 0; }
+};
+
+namespace BVHUtils {
+
+/* Shape bounds and centroid, as seen by the builders */
+struct BuildEntry {
+  BoundingBox bounds;
+  Tuple centroid;
+  std::uint32_t index;
+};
+
+/* Depth of the traversal stack. Builders fall back to median splits past half
+ * of it, which keeps any tree shallower than that. */
+inline constexpr std::size_t MaxDepth = 128;
+
+/* Number of nodes of a binary tree over `numShapes` leaves of one shape,
+ * which bounds the node count of any BVH over them */
+constexpr std::size_t MaxNodes(std::size_t numShapes) noexcept {
+  return numShapes > 0 ? 2 * numShapes - 1 : 1;
+}
+
+/* Morton code of a centroid: 3 x 10 bits in 30 bits when Real is float,
+ * 3 x 21 bits in 63 bits when it is double */
+using MortonCode = std::conditional_t<std::is_same_v<Real, float>,
+                                      std::uint32_t, std::uint64_t>;
+inline constexpr std::size_t MortonBitsPerAxis =
+    std::is_same_v<MortonCode, std::uint32_t> ? 10 : 21;
+
+/* Insert two zero bits above each of the low `MortonBitsPerAxis` bits */
+constexpr MortonCode SpreadBits(MortonCode v) noexcept {
+  if constexpr (std::is_same_v<MortonCode, std::uint32_t>) {
+    v &= 0x3ff;
+    v = (v | (v << 16)) & 0x030000ff;
+    v = (v | (v << 8)) & 0x0300f00f;
+    v = (v | (v << 4)) & 0x030c30c3;
+    v = (v | (v << 2)) & 0x09249249;
+  } else {
+    v &= 0x1fffff;
+    v = (v | (v << 32)) & 0x1f00000000ffff;
+    v = (v | (v << 16)) & 0x1f0000ff0000ff;
+    v = (v | (v << 8)) & 0x100f00f00f00f00f;
+    v = (v | (v << 4)) & 0x10c30c30c30c30c3;
+    v = (v | (v << 2)) & 0x1249249249249249;
+  }
+  return v;
+}
+
+/* Interleave quantized coordinates, x taking the highest bit of each triple */
+constexpr MortonCode EncodeMorton(MortonCode x, MortonCode y,
+                                  MortonCode z) noexcept {
+  return SpreadBits(x) << 2 | SpreadBits(y) << 1 | SpreadBits(z);
+}
+
+/* Axis that bit `bit` of a Morton code was taken from */
+constexpr std::size_t MortonAxis(std::size_t bit) noexcept {
+  return 2 - bit % 3;
+}
+
+/* Morton code of a `BuildEntry`, by position in the list of entries */
+struct MortonEntry {
+  MortonCode code;
+  std::uint32_t entry;
+};
+
+/*!
+ * \brief Stable LSD radix sort of Morton entries by code, 8 bits per pass.
+ *
+ * The input is cut into chunks which count their digits and scatter their
+ * entries in parallel. Offsets are laid out digit-major then chunk by chunk
+ * so that the order of equal digits is kept. Passes where every code shares
+ * the same digit are skipped.
+ */
+inline void RadixSort(std::vector<MortonEntry>& items) {
+  constexpr std::size_t DigitBits = 8;
+  constexpr std::size_t NumDigits = std::size_t{1} << DigitBits;
+  constexpr std::size_t NumPasses =
+      (3 * MortonBitsPerAxis + DigitBits - 1) / DigitBits;
+  // below this many entries per chunk, a single thread is faster
+  constexpr std::size_t MinChunkSize = 1 << 14;
+  const std::size_t n = items.size();
+  const std::size_t numChunks = std::clamp<std::size_t>(
+      n / MinChunkSize, 1, 4 * ParallelUtils::NumThreads());
+  const std::size_t chunkSize = (n + numChunks - 1) / numChunks;
+  const auto chunkEnd = [&](std::size_t chunk) {
+    return std::min(n, (chunk + 1) * chunkSize);
+  };
+
+  std::vector<MortonEntry> scratch(n);
+  std::vector<std::array<std::size_t, NumDigits>> offsets(numChunks);
+  for (std::size_t pass = 0; pass < NumPasses; pass++) {
+    const std::size_t shift = pass * DigitBits;
+    const auto digitOf = [&](const MortonEntry& item) {
+      return static_cast<std::size_t>((item.code >> shift) & (NumDigits - 1));
+    };
+    ParallelUtils::ParallelFor(numChunks, [&](std::size_t chunk) {
+      offsets[chunk].fill(0);
+      for (std::size_t i = chunk * chunkSize; i < chunkEnd(chunk); i++)
+        offsets[chunk][digitOf(items[i])]++;
+    });
+    bool sorted = false;
+    std::size_t total = 0;
+    for (std::size_t digit = 0; digit < NumDigits; digit++) {
+      const std::size_t digitBegin = total;
+      for (std::size_t chunk = 0; chunk < numChunks; chunk++) {
+        const std::size_t count = offsets[chunk][digit];
+        offsets[chunk][digit] = total;
+        total += count;
+      }
+      sorted = sorted || total - digitBegin == n;
+    }
+    if (sorted)
+      continue;
+    ParallelUtils::ParallelFor(numChunks, [&](std::size_t chunk) {
+      auto& next = offsets[chunk];
+      for (std::size_t i = chunk * chunkSize; i < chunkEnd(chunk); i++)
+        scratch[next[digitOf(items[i])]++] = items[i];
+    });
+    items.swap(scratch);
+  }
+}
+
+/* Sort by code, then by entry like the stable radix sort does at run time */
+constexpr void SortMorton(std::vector<MortonEntry>& items) {
+  if (std::is_constant_evaluated()) {
+    std::sort(items.begin(), items.end(),
+              [](const MortonEntry& lhs, const MortonEntry& rhs) {
+                return lhs.code < rhs.code ||
+                       (lhs.code == rhs.code && lhs.entry < rhs.entry);
+              });
+  } else {
+    RadixSort(items);
+  }
+}
+
+/*!
+ * \brief Split the sorted entries [begin, end) at the highest bit in which
+ * their codes differ.
+ *
+ * \return The first entry with that bit set and the axis of the bit, or the
+ * middle entry (and axis x) when all codes are equal
+ */
+constexpr std::pair<std::size_t, std::size_t> MortonSplit(
+    const std::vector<MortonEntry>& items, std::size_t begin,
+    std::size_t end) {
+  const MortonCode diff = items[begin].code ^ items[end - 1].code;
+  if (diff == 0)
+    return {begin + (end - begin) / 2, TupleConstants::x};
+  const std::size_t bit = std::bit_width(diff) - 1;
+  const MortonCode mask = MortonCode{1} << bit;
+  // codes share every bit above, those with this one clear come first
+  const auto split =
+      std::partition_point(items.begin() + begin, items.begin() + end,
+                           [&](const MortonEntry& item) {
+                             return (item.code & mask) == 0;
+                           });
+  return {static_cast<std::size_t>(split - items.begin()), MortonAxis(bit)};
+}
+
+}  // namespace BVHUtils
+
+/*!
+ * \brief How a `BasicBVH` is built.
+ *
+ * `SAH` gives the best trees for static scenes. `Morton` builds a linear BVH
+ * (LBVH) from shape centroids sorted along a Morton curve, in a fraction of
+ * the time, for scenes rebuilt every frame.
+ */
+enum class BVHBuilder { SAH, Morton };
+
+/*!
+ * \brief Bounding volume hierarchy over the shapes of a `World`, built with
+ * the surface area heuristic (SAH).
+ *
+ * Shapes with infinite bounds (planes) cannot be placed in a hierarchy, they
+ * are kept aside in a list that every query tests linearly. The tree itself is
+ * flattened into a contiguous node array visited front to back, and only shape
+ * indices are stored so the world may be copied or moved freely.
+ *
+ * Build and traversal are constexpr. The storage types decide where the tree
+ * lives: `BVH` uses `std::vector` for run-time worlds of any size, and
+ * `StaticBVH<N>` fixed-capacity `StaticVector`s sized from the shape count so
+ * that it can be built inside, and embedded in, a `constexpr World`.
+ *
+ * Used as the `AccelType` of a `World`, see `LinearAccel` for the interface.
+ *
+ * With `BVHBuilder::Morton`, the hierarchy follows the binary radix tree of
+ * the sorted Morton codes and has the same node layout, so queries and
+ * `World` do not tell the two apart. At run time its codes are computed and
+ * radix-sorted on every core, and the subtrees below the top levels are
+ * emitted in parallel then spliced in depth-first order.
+ *
+ * Animated scenes whose shapes only change transform between frames call
+ * `Update` instead of rebuilding: it refits the node bounds in a linear pass
+ * and only rebuilds once the tree quality has degraded too much.
+ *
+ * \tparam NodeStorage container of `BVHNode`
+ * \tparam IndexStorage container of `std::uint32_t` shape indices
+ * \tparam Builder construction algorithm, see `BVHBuilder`
+ */
+template <typename NodeStorage, typename IndexStorage,
+          BVHBuilder Builder = BVHBuilder::SAH>
+class BasicBVH final {
+ public:
+  /// leaves hold at most this many shapes
+  static constexpr std::size_t MaxLeafSize = 4;
+  /// candidate split positions per axis of the binned SAH
+  static constexpr std::size_t NumBuckets = 12;
+  /// cost of visiting a node, relative to intersecting one shape
+  static constexpr Real TraversalCost = 0.125;
+  /// Morton build: smallest subtree emitted by one parallel task
+  static constexpr std::size_t MinTreeletSize = 1024;
+  /// `Update` rebuilds once refitting raised the SAH cost past this factor of
+  /// its value right after the last build
+  static constexpr Real RebuildThreshold = 1.5;
+
+  constexpr BasicBVH() noexcept = default;
+
+  template <typename ShapeContType>
+  constexpr explicit BasicBVH(const ShapeContType& shapes) {
+    Build(shapes);
+  }
+
+  /* (Re)build the hierarchy over the world space bounds of `shapes` */
+  template <typename ShapeContType>
+  constexpr void Build(const ShapeContType& shapes) {
+    nodes.clear();
+    shapeIndices.clear();
+    unbounded.clear();
+    std::vector<BVHUtils::BuildEntry> entries(shapes.size());
+    const auto gather = [&](std::size_t i) {
+      // e.g planes by their traits, or a shape under a degenerate transform
+      const BoundingBox bounds = shapes[i].IsBounded()
+                                     ? shapes[i].WorldBounds()
+                                     : BoundingBox::Infinite();
+      entries[i].bounds = bounds;
+      entries[i].index = static_cast<std::uint32_t>(i);
+      if (bounds.IsFinite())
+        entries[i].centroid = bounds.Centroid();
+    };
+    if (std::is_constant_evaluated()) {
+      for (std::size_t i = 0; i < shapes.size(); i++)
+        gather(i);
+    } else {
+      ParallelUtils::ParallelFor(shapes.size(), gather, 1024);
+    }
+    for (const auto& entry : entries) {
+      if (!entry.bounds.IsFinite())
+        unbounded.push_back(entry.index);
+    }
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [](const BVHUtils::BuildEntry& entry) {
+                                   return !entry.bounds.IsFinite();
+                                 }),
+                  entries.end());
+    if (entries.empty())
+      return;
+    if constexpr (requires { nodes.reserve(std::size_t{}); }) {
+      nodes.reserve(BVHUtils::MaxNodes(entries.size()));
+      shapeIndices.reserve(entries.size());
+    }
+    if constexpr (Builder == BVHBuilder::Morton) {
+      BuildMorton(entries);
+    } else {
+      BuildRecursive(entries, 0, entries.size(), 0);
+      for (const auto& entry : entries)
+        shapeIndices.push_back(entry.index);
+    }
+    builtCost = SAHCost();
+  }
+
+  /*!
+   * \brief Recompute the node bounds after the transforms of `shapes`
+   * changed, keeping the topology of the tree.
+   *
+   * The world bounds of the shapes are first gathered in memory order, then
+   * leaves take the bounds of their shapes and interior nodes the union of
+   * their children in a single bottom-up pass. At run time both are spread
+   * over every core, the latter one subtree below the top levels per task.
+   *
+   * \return false, leaving the tree unusable until the next `Build`, when
+   * `shapes` is not the container the tree was built from (the shape count
+   * differs) or a shape of the hierarchy lost its finite bounds
+   */
+  template <typename ShapeContType>
+  constexpr bool Refit(const ShapeContType& shapes) {
+    if (shapeIndices.size() + unbounded.size() != shapes.size())
+      return false;
+    if (nodes.empty())
+      return true;
+    // leaves visit their shapes in no particular order, reading the bounds
+    // from here rather than from the shapes saves most cache misses
+    std::vector<BoundingBox> shapeBounds(shapes.size());
+    const auto gather = [&](std::size_t i) {
+      shapeBounds[i] = shapes[i].IsBounded() ? shapes[i].WorldBounds()
+                                             : BoundingBox::Infinite();
+    };
+    // below this many nodes, starting threads costs more than the refit
+    constexpr std::size_t MinParallelNodes = 4096;
+    std::size_t maxDepth = 0;
+    if (std::is_constant_evaluated()) {
+      for (std::size_t i = 0; i < shapes.size(); i++)
+        gather(i);
+    } else {
+      ParallelUtils::ParallelFor(shapes.size(), gather, 1024);
+      if (nodes.size() >= MinParallelNodes)
+        maxDepth = std::bit_width(4 * ParallelUtils::NumThreads());
+    }
+    std::vector<std::uint32_t> top;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> subtrees;
+    PartitionForRefit(0, 0, maxDepth, top, subtrees);
+
+    // one flag per subtree, written by a single task each
+    std::vector<std::uint8_t> finite(subtrees.size(), 1);
+    const auto refitSubtree = [&](std::size_t t) {
+      // children always follow their parent, a reverse sweep is bottom-up
+      const auto [begin, end] = subtrees[t];
+      for (std::uint32_t i = end; i-- > begin;) {
+        if (!RefitNode(shapeBounds, i))
+          finite[t] = 0;
+      }
+    };
+    if (std::is_constant_evaluated()) {
+      for (std::size_t t = 0; t < subtrees.size(); t++)
+        refitSubtree(t);
+    } else {
+      ParallelUtils::ParallelFor(subtrees.size(), refitSubtree);
+    }
+    for (auto i = top.rbegin(); i != top.rend(); ++i)
+      RefitNode(shapeBounds, *i);
+    return std::all_of(finite.begin(), finite.end(),
+                       [](std::uint8_t flag) { return flag != 0; });
+  }
+
+  /*!
+   * \brief Bring the hierarchy up to date after the transforms of `shapes`
+   * changed: refit it, or rebuild it when the refit fails or leaves a tree
+   * whose SAH cost degraded past `RebuildThreshold`.
+   *
+   * \return Whether the hierarchy was rebuilt
+   */
+  template <typename ShapeContType>
+  constexpr bool Update(const ShapeContType& shapes) {
+    if (Refit(shapes) && SAHCost() <= RebuildThreshold * builtCost)
+      return false;
+    Build(shapes);
+    return true;
+  }
+
+  template <typename ShapeContType>
+  constexpr std::optional<Hit> ClosestHit(const ShapeContType& shapes,
+                                          const Ray& ray) const {
+    std::optional<Hit> closest = std::nullopt;
+    Ray clipped = ray;
+    // clipping the ray to the nearest hit so far prunes every farther node
+    const auto intersect = [&](std::uint32_t index) {
+      HitBuffer<ShapeWrapper::MaxHits> hits;
+      shapes[index].IntersectInto(clipped, index, hits);
+      if (!hits.empty()) {
+        closest = hits[0];
+        clipped.ClipTo(hits[0].t);
+      }
+      return false;
+    };
+    for (const std::uint32_t index : unbounded)
+      intersect(index);
+    Traverse(clipped, intersect);
+    return closest;
+  }
+
+  template <typename ShapeContType>
+  constexpr bool Occluded(const ShapeContType& shapes, const Ray& ray) const {
+    const auto occludes = [&](std::uint32_t index) {
+      return shapes[index].Occludes(ray);
+    };
+    for (const std::uint32_t index : unbounded) {
+      if (occludes(index))
+        return true;
+    }
+    return Traverse(ray, occludes);
+  }
+
+  /* Expected cost of a ray query according to the SAH, 0 when empty */
+  constexpr Real SAHCost() const noexcept {
+    if (nodes.empty())
+      return 0;
+    const Real rootArea = nodes[0].bounds.SurfaceArea();
+    Real cost = 0;
+    for (const BVHNode& node : nodes) {
+      const Real weight = node.bounds.SurfaceArea() / rootArea;
+      cost += weight * (node.IsLeaf() ? Real(node.count) : TraversalCost);
+    }
+    return cost;
+  }
+
+  constexpr const NodeStorage& GetNodes() const noexcept { return nodes; }
+
+  /* Shape indices in leaf order, a leaf refers to a range of this list */
+  constexpr const IndexStorage& GetShapeIndices() const noexcept {
+    return shapeIndices;
+  }
+
+  /* Shapes with infinite bounds, kept out of the hierarchy */
+  constexpr const IndexStorage& GetUnbounded() const noexcept {
+    return unbounded;
+  }
+
+  /* SAH cost of the tree right after its last build, see `Update` */
+  constexpr Real BuiltSAHCost() const noexcept { return builtCost; }
+
+ private:
+  /*!
+   * \brief Emit the subtree over entries [begin, end) in depth-first order and
+   * return the index of its root node.
+   *
+   * Splits are chosen among `NumBuckets` bins along the longest axis of the
+   * centroid bounds, and entries are partitioned in place so that a leaf
+   * refers to a contiguous range of them. Past half of `BVHUtils::MaxDepth`
+   * the entries are split at their median instead, bounding the tree depth.
+   */
+  constexpr std::uint32_t BuildRecursive(
+      std::vector<BVHUtils::BuildEntry>& entries, std::size_t begin,
+      std::size_t end, std::size_t depth) {
+    const auto nodeIndex = static_cast<std::uint32_t>(nodes.size());
+    nodes.push_back(BVHNode{});
+    BoundingBox bounds, centroidBounds;
+    for (std::size_t i = begin; i < end; i++) {
+      bounds = Union(bounds, entries[i].bounds);
+      centroidBounds = Union(centroidBounds, entries[i].centroid);
+    }
+    nodes[nodeIndex].bounds = bounds;
+
+    const std::size_t count = end - begin;
+    const auto makeLeaf = [&] {
+      nodes[nodeIndex].offset = static_cast<std::uint32_t>(begin);
+      nodes[nodeIndex].count = static_cast<std::uint16_t>(count);
+      return nodeIndex;
+    };
+    if (count == 1)
+      return makeLeaf();
+
+    const std::size_t axis = centroidBounds.MaximumExtent();
+    const Real axisMin = centroidBounds.lower[axis];
+    const Real axisMax = centroidBounds.upper[axis];
+    std::size_t mid = begin + count / 2;
+    if (axisMax > axisMin && depth >= BVHUtils::MaxDepth / 2) {
+      std::nth_element(entries.begin() + begin, entries.begin() + mid,
+                       entries.begin() + end,
+                       [&](const auto& lhs, const auto& rhs) {
+                         return lhs.centroid[axis] < rhs.centroid[axis];
+                       });
+    } else if (axisMax > axisMin) {
+      const Real scale = NumBuckets / (axisMax - axisMin);
+      const auto bucketOf = [&](const BVHUtils::BuildEntry& entry) {
+        const auto bucket =
+            static_cast<std::size_t>((entry.centroid[axis] - axisMin) * scale);
+        return std::min(bucket, NumBuckets - 1);
+      };
+      std::array<std::size_t, NumBuckets> bucketCount{};
+      std::array<BoundingBox, NumBuckets> bucketBounds{};
+      for (std::size_t i = begin; i < end; i++) {
+        const std::size_t bucket = bucketOf(entries[i]);
+        bucketCount[bucket]++;
+        bucketBounds[bucket] = Union(bucketBounds[bucket], entries[i].bounds);
+      }
+      // sweep from the right to get the area and count above every split
+      std::array<Real, NumBuckets> areaAbove{};
+      std::array<std::size_t, NumBuckets> countAbove{};
+      BoundingBox above;
+      std::size_t numAbove = 0;
+      for (std::size_t i = NumBuckets - 1; i > 0; i--) {
+        above = Union(above, bucketBounds[i]);
+        numAbove += bucketCount[i];
+        areaAbove[i - 1] = above.SurfaceArea();
+        countAbove[i - 1] = numAbove;
+      }
+      // then from the left, splitting after bucket i
+      std::size_t bestSplit = 0;
+      Real bestCost = MathUtils::MathConstants::INF<Real>;
+      BoundingBox below;
+      std::size_t numBelow = 0;
+      for (std::size_t i = 0; i + 1 < NumBuckets; i++) {
+        below = Union(below, bucketBounds[i]);
+        numBelow += bucketCount[i];
+        const Real cost = numBelow * below.SurfaceArea() +
+                          countAbove[i] * areaAbove[i];
+        if (cost < bestCost) {
+          bestCost = cost;
+          bestSplit = i;
+        }
+      }
+      const Real area = bounds.SurfaceArea();
+      const Real splitCost =
+          TraversalCost + (area > 0 ? bestCost / area : Real(0));
+      if (count <= MaxLeafSize && splitCost >= Real(count))
+        return makeLeaf();
+      const auto split = std::partition(
+          entries.begin() + begin, entries.begin() + end,
+          [&](const auto& entry) { return bucketOf(entry) <= bestSplit; });
+      mid = static_cast<std::size_t>(split - entries.begin());
+      // a non-empty bucket always lies on each side of the best split, but
+      // fall back to an even split should rounding put everything on one
+      if (mid == begin || mid == end)
+        mid = begin + count / 2;
+    } else if (count <= MaxLeafSize) {
+      // all centroids coincide, no split can separate the shapes
+      return makeLeaf();
+    }
+
+    nodes[nodeIndex].axis = static_cast<std::uint8_t>(axis);
+    BuildRecursive(entries, begin, mid, depth + 1);
+    nodes[nodeIndex].offset = BuildRecursive(entries, mid, end, depth + 1);
+    return nodeIndex;
+  }
+
+  /*!
+   * \brief Linear BVH build: sort the entries along a Morton curve over their
+   * centroid bounds and split every range at the highest differing bit.
+   *
+   * Ranges of at most a treelet size are emitted as standalone subtrees,
+   * one task each, and the top levels above them are then emitted with the
+   * subtrees copied in place. The tree is identical whatever the number of
+   * threads, a single treelet covers everything at compile time.
+   */
+  constexpr void BuildMorton(const std::vector<BVHUtils::BuildEntry>& entries) {
+    using BVHUtils::MortonCode;
+    const std::size_t n = entries.size();
+    BoundingBox centroidBounds;
+    for (const auto& entry : entries)
+      centroidBounds = Union(centroidBounds, entry.centroid);
+    // quantize the centroids on a grid of 2^MortonBitsPerAxis cells per axis
+    constexpr MortonCode gridMax =
+        (MortonCode{1} << BVHUtils::MortonBitsPerAxis) - 1;
+    std::array<Real, 3> scale{};
+    for (std::size_t axis = 0; axis < 3; axis++) {
+      const Real extent =
+          centroidBounds.upper[axis] - centroidBounds.lower[axis];
+      scale[axis] = extent > 0 ? Real(gridMax + 1) / extent : Real(0);
+    }
+    std::vector<BVHUtils::MortonEntry> items(n);
+    const auto encode = [&](std::size_t i) {
+      const auto quantize = [&](std::size_t axis) {
+        const Real cell =
+            (entries[i].centroid[axis] - centroidBounds.lower[axis]) *
+            scale[axis];
+        return std::min(static_cast<MortonCode>(cell), gridMax);
+      };
+      items[i] = {BVHUtils::EncodeMorton(quantize(TupleConstants::x),
+                                         quantize(TupleConstants::y),
+                                         quantize(TupleConstants::z)),
+                  static_cast<std::uint32_t>(i)};
+    };
+    if (std::is_constant_evaluated()) {
+      for (std::size_t i = 0; i < n; i++)
+        encode(i);
+    } else {
+      ParallelUtils::ParallelFor(n, encode, 4096);
+    }
+    BVHUtils::SortMorton(items);
+    for (const auto& item : items)
+      shapeIndices.push_back(entries[item.entry].index);
+
+    const std::size_t treeletSize =
+        std::is_constant_evaluated()
+            ? n
+            : std::max(n / (4 * ParallelUtils::NumThreads()), MinTreeletSize);
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+    CollectTreelets(items, 0, n, treeletSize, ranges);
+    std::vector<std::vector<BVHNode>> treelets(ranges.size());
+    const auto emit = [&](std::size_t t) {
+      const auto [begin, end] = ranges[t];
+      treelets[t].reserve(BVHUtils::MaxNodes(end - begin));
+      EmitMorton(items, entries, begin, end, treelets[t]);
+    };
+    if (std::is_constant_evaluated()) {
+      for (std::size_t t = 0; t < ranges.size(); t++)
+        emit(t);
+    } else {
+      ParallelUtils::ParallelFor(ranges.size(), emit);
+    }
+    std::size_t nextTreelet = 0;
+    SpliceMorton(items, 0, n, treeletSize, treelets, nextTreelet);
+  }
+
+  /* Ranges of the sorted entries emitted as standalone subtrees, in
+   * depth-first order */
+  static constexpr void CollectTreelets(
+      const std::vector<BVHUtils::MortonEntry>& items, std::size_t begin,
+      std::size_t end, std::size_t treeletSize,
+      std::vector<std::pair<std::size_t, std::size_t>>& ranges) {
+    if (end - begin <= treeletSize) {
+      ranges.emplace_back(begin, end);
+      return;
+    }
+    const std::size_t mid = BVHUtils::MortonSplit(items, begin, end).first;
+    CollectTreelets(items, begin, mid, treeletSize, ranges);
+    CollectTreelets(items, mid, end, treeletSize, ranges);
+  }
+
+  /* Emit the subtree over the sorted entries [begin, end) at the end of
+   * `out`, and return the index of its root in `out` */
+  static constexpr std::uint32_t EmitMorton(
+      const std::vector<BVHUtils::MortonEntry>& items,
+      const std::vector<BVHUtils::BuildEntry>& entries, std::size_t begin,
+      std::size_t end, std::vector<BVHNode>& out) {
+    const auto nodeIndex = static_cast<std::uint32_t>(out.size());
+    out.push_back(BVHNode{});
+    if (end - begin <= MaxLeafSize) {
+      BoundingBox bounds;
+      for (std::size_t i = begin; i < end; i++)
+        bounds = Union(bounds, entries[items[i].entry].bounds);
+      out[nodeIndex] = BVHNode{bounds, static_cast<std::uint32_t>(begin),
+                               static_cast<std::uint16_t>(end - begin), 0};
+      return nodeIndex;
+    }
+    const auto [mid, axis] = BVHUtils::MortonSplit(items, begin, end);
+    const std::uint32_t first = EmitMorton(items, entries, begin, mid, out);
+    const std::uint32_t second = EmitMorton(items, entries, mid, end, out);
+    out[nodeIndex] = BVHNode{Union(out[first].bounds, out[second].bounds),
+                             second, 0, static_cast<std::uint8_t>(axis)};
+    return nodeIndex;
+  }
+
+  /* Emit the top levels over [begin, end) into `nodes`, copying the next
+   * treelet in place of every range `CollectTreelets` stopped at */
+  constexpr std::uint32_t SpliceMorton(
+      const std::vector<BVHUtils::MortonEntry>& items, std::size_t begin,
+      std::size_t end, std::size_t treeletSize,
+      const std::vector<std::vector<BVHNode>>& treelets,
+      std::size_t& nextTreelet) {
+    const auto nodeIndex = static_cast<std::uint32_t>(nodes.size());
+    if (end - begin <= treeletSize) {
+      // child offsets of a treelet are relative to its root
+      for (BVHNode node : treelets[nextTreelet++]) {
+        if (!node.IsLeaf())
+          node.offset += nodeIndex;
+        nodes.push_back(node);
+      }
+      return nodeIndex;
+    }
+    nodes.push_back(BVHNode{});
+    const auto [mid, axis] = BVHUtils::MortonSplit(items, begin, end);
+    const std::uint32_t first =
+        SpliceMorton(items, begin, mid, treeletSize, treelets, nextTreelet);
+    const std::uint32_t second =
+        SpliceMorton(items, mid, end, treeletSize, treelets, nextTreelet);
+    nodes[nodeIndex] = BVHNode{Union(nodes[first].bounds, nodes[second].bounds),
+                               second, 0, static_cast<std::uint8_t>(axis)};
+    return nodeIndex;
+  }
+
+  /* One past the last node of the subtree rooted at `root`, which occupies
+   * a contiguous range in depth-first order */
+  constexpr std::uint32_t SubtreeEnd(std::uint32_t root) const noexcept {
+    while (!nodes[root].IsLeaf())
+      root = nodes[root].offset;
+    return root + 1;
+  }
+
+  /* Interior nodes above `maxDepth` in pre-order, and the node ranges of the
+   * subtrees they stop at */
+  constexpr void PartitionForRefit(
+      std::uint32_t root, std::size_t depth, std::size_t maxDepth,
+      std::vector<std::uint32_t>& top,
+      std::vector<std::pair<std::uint32_t, std::uint32_t>>& subtrees) const {
+    if (depth == maxDepth || nodes[root].IsLeaf()) {
+      subtrees.emplace_back(root, SubtreeEnd(root));
+      return;
+    }
+    top.push_back(root);
+    PartitionForRefit(root + 1, depth + 1, maxDepth, top, subtrees);
+    PartitionForRefit(nodes[root].offset, depth + 1, maxDepth, top, subtrees);
+  }
+
+  /* Bounds of node `i` from the bounds of its shapes or from its already
+   * refitted children. Returns false if a shape of the leaf has no finite
+   * bounds. */
+  constexpr bool RefitNode(const std::vector<BoundingBox>& shapeBounds,
+                           std::uint32_t i) {
+    BVHNode& node = nodes[i];
+    if (!node.IsLeaf()) {
+      node.bounds = Union(nodes[i + 1].bounds, nodes[node.offset].bounds);
+      return true;
+    }
+    BoundingBox bounds;
+    for (std::size_t j = 0; j < node.count; j++)
+      bounds = Union(bounds, shapeBounds[shapeIndices[node.offset + j]]);
+    node.bounds = bounds;
+    return bounds.IsFinite();
+  }
+
+  /*!
+   * \brief Visit the shapes of every leaf crossed by the ray, nearest child
+   * first, until `visit(shapeIndex)` returns true.
+   *
+   * \return Whether the traversal was stopped by `visit`
+   */
+  template <typename Visitor>
+  constexpr bool Traverse(const Ray& ray, Visitor&& visit) const {
+    if (nodes.empty())
+      return false;
+    std::array<std::uint32_t, BVHUtils::MaxDepth> stack{};
+    std::size_t stackSize = 0;
+    std::uint32_t current = 0;
+    while (true) {
+      const BVHNode& node = nodes[current];
+      // `ray` may be clipped by `visit` in between two slab tests
+      if (node.bounds.IntersectP(ray)) {
+        if (node.IsLeaf()) {
+          for (std::size_t i = 0; i < node.count; i++) {
+            if (visit(shapeIndices[node.offset + i]))
+              return true;
+          }
+        } else {
+          // visit first the child on the side the ray comes from
+          const bool dirIsNeg = ray.IsNegative(node.axis);
+          stack[stackSize++] = dirIsNeg ? current + 1 : node.offset;
+          current = dirIsNeg ? node.offset : current + 1;
+          continue;
+        }
+      }
+      if (stackSize == 0)
+        return false;
+      current = stack[--stackSize];
+    }
+  }
+
+  NodeStorage nodes;
+  IndexStorage shapeIndices;
+  IndexStorage unbounded;
+  Real builtCost{0};
+};
+
+/* BVH of a run-time world, of any size */
+using BVH = BasicBVH<std::vector<BVHNode>, std::vector<std::uint32_t>>;
+
+/* Linear BVH of a run-time world, for scenes rebuilt every frame */
+using LBVH = BasicBVH<std::vector<BVHNode>, std::vector<std::uint32_t>,
+                      BVHBuilder::Morton>;
+
+/* BVH with storage for `NumShapes` shapes, usable in a `constexpr World` */
+template <std::size_t NumShapes, BVHBuilder Builder = BVHBuilder::SAH>
+using StaticBVH =
+    BasicBVH<StaticVector<BVHNode, BVHUtils::MaxNodes(NumShapes)>,
+             StaticVector<std::uint32_t, std::max<std::size_t>(NumShapes, 1)>,
+             Builder>;
+
+}  // namespace RayTracer
+#endif
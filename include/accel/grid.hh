@@ -0,0 +1,495 @@
+#ifndef ACCEL_GRID_HH
+#define ACCEL_GRID_HH
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <primitives.hh>
+#include <utils/parallel.hh>
+#include <vector>
+namespace RayTracer {
+
+/* How the cells of a `BasicGrid` are stored */
+enum class GridLayout {
+  /// every cell of the grid, sized from the number of shapes
+  Dense,
+  /// only the occupied cells, found through a hash table: cells can be sized
+  /// from the shapes rather than from the whole scene
+  Hashed
+};
+
+namespace GridUtils {
+
+/* Cube root by Newton iterations, usable at compile time */
+constexpr Real CubeRoot(Real x) noexcept {
+  if (x <= 0)
+    return 0;
+  Real y = x > 1 ? x : Real(1);
+  for (int i = 0; i < 200; i++) {
+    const Real next = (2 * y + x / (y * y)) / 3;
+    if (next >= y)
+      break;
+    y = next;
+  }
+  return y;
+}
+
+/* Spatial hash of a cell, scattering neighbouring cells over the table */
+constexpr std::uint32_t HashCell(std::int32_t x, std::int32_t y,
+                                 std::int32_t z) noexcept {
+  return (static_cast<std::uint32_t>(x) * 73856093u) ^
+         (static_cast<std::uint32_t>(y) * 19349663u) ^
+         (static_cast<std::uint32_t>(z) * 83492791u);
+}
+
+}  // namespace GridUtils
+
+/*!
+ * \brief Acceleration structure of a `World` splitting the bounds of its
+ * shapes into a grid of equal cells, each listing the shapes overlapping it.
+ *
+ * Meant for scenes of many small shapes of similar size, e.g particles, where
+ * it is built in two linear passes and no hierarchy has to be walked: a ray
+ * steps through the cells it crosses from near to far (3D-DDA) and stops at
+ * the first cell holding a hit. The `Hashed` layout only stores occupied
+ * cells, so they can be sized from the crowding of the shapes rather than
+ * from the volume of the scene, and suits sparse or clustered scenes whose
+ * dense grid would pack every cluster into a few crowded cells.
+ *
+ * Shapes with infinite bounds are kept aside and tested on every query, like
+ * in a `BVH`, and so are the few shapes spanning more than `MaxCellsPerShape`
+ * cells, e.g one large sphere among small particles, which would otherwise
+ * be listed in millions of fine cells. Should more than one shape in
+ * `LargeShapeRatio` be that large, the cells are coarsened instead, which
+ * bounds the cell references to `MaxCellsPerShape` per shape.
+ *
+ * Cells of both layouts are stored in CSR form: shapes of key `k` (the index
+ * of a dense cell, or the entry of an occupied cell in the hash table) are
+ * `cellShapes[cellStart[k] .. cellStart[k + 1])`.
+ */
+template <GridLayout Layout>
+class BasicGrid final {
+ public:
+  /// dense layout: number of cells per bounded shape
+  static constexpr Real CellsPerShape = 2;
+  /// bounds the number of cells a ray can step through along an axis
+  static constexpr std::int32_t MaxResolution =
+      Layout == GridLayout::Dense ? 512 : 4096;
+  /// shapes spanning more cells are tested on every query
+  static constexpr std::size_t MaxCellsPerShape = 64;
+  /// at most one bounded shape in `LargeShapeRatio` is kept out of the cells
+  static constexpr std::size_t LargeShapeRatio = 64;
+
+  constexpr BasicGrid() = default;
+
+  template <typename ShapeContType>
+  constexpr explicit BasicGrid(const ShapeContType& shapes) {
+    Build(shapes);
+  }
+
+  /* (Re)build the grid over the world space bounds of `shapes` */
+  template <typename ShapeContType>
+  constexpr void Build(const ShapeContType& shapes) {
+    cellStart.clear();
+    cellShapes.clear();
+    unbounded.clear();
+    large.clear();
+    slots.clear();
+    cellCoords.clear();
+    bounds = BoundingBox{};
+    std::vector<BoundingBox> shapeBounds(shapes.size());
+    const auto gather = [&](std::size_t i) {
+      shapeBounds[i] = shapes[i].IsBounded() ? shapes[i].WorldBounds()
+                                             : BoundingBox::Infinite();
+    };
+    if (std::is_constant_evaluated()) {
+      for (std::size_t i = 0; i < shapes.size(); i++)
+        gather(i);
+    } else {
+      ParallelUtils::ParallelFor(shapes.size(), gather, 1024);
+    }
+    Real extentSum = 0;
+    std::size_t numBounded = 0;
+    for (std::size_t i = 0; i < shapeBounds.size(); i++) {
+      if (!shapeBounds[i].IsFinite()) {
+        unbounded.push_back(static_cast<std::uint32_t>(i));
+        continue;
+      }
+      bounds = Union(bounds, shapeBounds[i]);
+      const Tuple diagonal = shapeBounds[i].Diagonal();
+      extentSum += std::max({diagonal[0], diagonal[1], diagonal[2]});
+      numBounded++;
+    }
+    if (numBounded == 0)
+      return;
+    Real cellsPerUnit =
+        ChooseResolution(shapeBounds, numBounded, extentSum / numBounded);
+    const auto isLarge = [&](const BoundingBox& box) {
+      return box.IsFinite() && NumCells(box) > MaxCellsPerShape;
+    };
+    while (LargeShapeRatio * static_cast<std::size_t>(std::count_if(
+                                 shapeBounds.begin(), shapeBounds.end(),
+                                 isLarge)) >
+           numBounded) {
+      // a single cell holds every shape at worst, which ends the loop
+      cellsPerUnit /= 2;
+      SetCellsPerUnit(cellsPerUnit);
+    }
+    std::vector<std::uint32_t> binned;
+    for (std::uint32_t i = 0; i < shapeBounds.size(); i++) {
+      if (isLarge(shapeBounds[i]))
+        large.push_back(i);
+      else if (shapeBounds[i].IsFinite())
+        binned.push_back(i);
+    }
+
+    // the cells overlapped by a shape
+    const auto forEachCell = [&](std::uint32_t i, auto&& func) {
+      const BoundingBox& box = shapeBounds[i];
+      const std::array<std::int32_t, 3> lo = CellOf(box.lower);
+      const std::array<std::int32_t, 3> hi = CellOf(box.upper);
+      for (std::int32_t z = lo[2]; z <= hi[2]; z++) {
+        for (std::int32_t y = lo[1]; y <= hi[1]; y++) {
+          for (std::int32_t x = lo[0]; x <= hi[0]; x++)
+            func(x, y, z);
+        }
+      }
+    };
+    std::vector<std::uint32_t> counts;
+    if constexpr (Layout == GridLayout::Dense) {
+      counts.assign(static_cast<std::size_t>(resolution[0]) * resolution[1] *
+                        resolution[2],
+                    0);
+      for (const std::uint32_t i : binned) {
+        forEachCell(i, [&](std::int32_t x, std::int32_t y, std::int32_t z) {
+          counts[KeyOf(x, y, z)]++;
+        });
+      }
+    } else {
+      std::size_t numRefs = 0;
+      for (const std::uint32_t i : binned)
+        numRefs += NumCells(shapeBounds[i]);
+      // at most half of the slots are taken, probe sequences stay short
+      slots.assign(std::bit_ceil(2 * numRefs), EmptySlot);
+      for (const std::uint32_t i : binned) {
+        forEachCell(i, [&](std::int32_t x, std::int32_t y, std::int32_t z) {
+          const std::uint32_t key = Insert(x, y, z);
+          if (key == counts.size())
+            counts.push_back(0);
+          counts[key]++;
+        });
+      }
+    }
+
+    // shapes of every key are scattered once the offsets are known
+    cellStart.assign(counts.size() + 1, 0);
+    for (std::size_t key = 0; key < counts.size(); key++)
+      cellStart[key + 1] = cellStart[key] + counts[key];
+    cellShapes.resize(cellStart.back());
+    std::vector<std::uint32_t> next(cellStart.begin(), cellStart.end() - 1);
+    for (const std::uint32_t i : binned) {
+      forEachCell(i, [&](std::int32_t x, std::int32_t y, std::int32_t z) {
+        cellShapes[next[KeyOf(x, y, z)]++] = i;
+      });
+    }
+  }
+
+  /* A grid has no bounds to refit, shapes that moved change cells */
+  template <typename ShapeContType>
+  constexpr bool Update(const ShapeContType& shapes) {
+    Build(shapes);
+    return true;
+  }
+
+  template <typename ShapeContType>
+  constexpr std::optional<Hit> ClosestHit(const ShapeContType& shapes,
+                                          const Ray& ray) const {
+    std::optional<Hit> closest = std::nullopt;
+    Ray clipped = ray;
+    // once clipped to a hit, the ray stops at the end of the cell holding it
+    const auto intersect = [&](std::uint32_t index) {
+      HitBuffer<ShapeWrapper::MaxHits> hits;
+      shapes[index].IntersectInto(clipped, index, hits);
+      if (!hits.empty()) {
+        closest = hits[0];
+        clipped.ClipTo(hits[0].t);
+      }
+      return false;
+    };
+    for (const std::uint32_t index : unbounded)
+      intersect(index);
+    for (const std::uint32_t index : large)
+      intersect(index);
+    Traverse(clipped, intersect);
+    return closest;
+  }
+
+  template <typename ShapeContType>
+  constexpr bool Occluded(const ShapeContType& shapes, const Ray& ray) const {
+    const auto occludes = [&](std::uint32_t index) {
+      return shapes[index].Occludes(ray);
+    };
+    for (const std::uint32_t index : unbounded) {
+      if (occludes(index))
+        return true;
+    }
+    for (const std::uint32_t index : large) {
+      if (occludes(index))
+        return true;
+    }
+    return Traverse(ray, occludes);
+  }
+
+  /* Cells along each axis, 0 when no shape is bounded */
+  constexpr const std::array<std::int32_t, 3>& GetResolution() const noexcept {
+    return resolution;
+  }
+
+  /* Number of stored cells, every cell when dense, occupied ones if hashed */
+  constexpr std::size_t NumKeys() const noexcept {
+    return cellStart.empty() ? 0 : cellStart.size() - 1;
+  }
+
+  /* Shape indices of every key, a shape spanning many cells is in each */
+  constexpr const std::vector<std::uint32_t>& GetCellShapes() const noexcept {
+    return cellShapes;
+  }
+
+  /* Shapes with infinite bounds, kept out of the grid */
+  constexpr const std::vector<std::uint32_t>& GetUnbounded() const noexcept {
+    return unbounded;
+  }
+
+  /* Shapes spanning more than `MaxCellsPerShape` cells, kept out of them */
+  constexpr const std::vector<std::uint32_t>& GetLarge() const noexcept {
+    return large;
+  }
+
+ private:
+  /*!
+   * \brief Dense grids get about `CellsPerShape` cells per shape, as cubic
+   * as the bounds allow.
+   *
+   * Hashed grids first bin the shape centroids into such a dense grid to
+   * measure how crowded the occupied cells are, and shrink their cells until
+   * a shape shares its cell with about one other, but not below the mean
+   * extent of the shapes. Clustered scenes get fine cells where the shapes
+   * are, only those being stored.
+   *
+   * \return The number of cells per unit length
+   */
+  constexpr Real ChooseResolution(const std::vector<BoundingBox>& shapeBounds,
+                                  std::size_t numBounded, Real meanExtent) {
+    const Tuple diagonal = bounds.Diagonal();
+    const Real maxExtent = std::max({diagonal[0], diagonal[1], diagonal[2]});
+    if (maxExtent <= 0) {
+      SetCellsPerUnit(0);
+      return 0;
+    }
+    const Real volume = std::max(diagonal[0], maxExtent / MaxResolution) *
+                        std::max(diagonal[1], maxExtent / MaxResolution) *
+                        std::max(diagonal[2], maxExtent / MaxResolution);
+    const Real cellsPerUnit =
+        GridUtils::CubeRoot(CellsPerShape * numBounded / volume);
+    SetCellsPerUnit(cellsPerUnit);
+    if constexpr (Layout == GridLayout::Hashed) {
+      std::vector<std::uint32_t> counts(static_cast<std::size_t>(
+                                            resolution[0]) *
+                                        resolution[1] * resolution[2]);
+      for (const BoundingBox& box : shapeBounds) {
+        if (box.IsFinite()) {
+          const std::array<std::int32_t, 3> cell = CellOf(box.Centroid());
+          counts[(static_cast<std::size_t>(cell[2]) * resolution[1] +
+                  cell[1]) * resolution[0] + cell[0]]++;
+        }
+      }
+      // other shapes in the cell of a shape, on average
+      Real crowding = 0;
+      for (const std::uint32_t count : counts)
+        crowding += Real(count) * (count - Real(1));
+      crowding = std::max(crowding / numBounded, Real(1));
+      Real finer = cellsPerUnit * GridUtils::CubeRoot(crowding);
+      if (meanExtent > 0)
+        finer = std::min(finer, std::max(1 / meanExtent, cellsPerUnit));
+      SetCellsPerUnit(finer);
+      return finer;
+    }
+    return cellsPerUnit;
+  }
+
+  constexpr void SetCellsPerUnit(Real cellsPerUnit) {
+    const Tuple diagonal = bounds.Diagonal();
+    for (std::size_t axis = 0; axis < 3; axis++) {
+      const Real cells = MathUtils::ConstExpr::Ceil(
+          std::min(diagonal[axis] * cellsPerUnit, Real(MaxResolution)));
+      resolution[axis] = std::max(static_cast<std::int32_t>(cells), 1);
+      cellSize[axis] =
+          diagonal[axis] > 0 ? diagonal[axis] / resolution[axis] : Real(1);
+      invCellSize[axis] = 1 / cellSize[axis];
+    }
+  }
+
+  /* Cell holding a point, clamped to the grid */
+  constexpr std::int32_t CellOf(Real value, std::size_t axis) const noexcept {
+    const Real cell = (value - bounds.lower[axis]) * invCellSize[axis];
+    if (cell <= 0)
+      return 0;
+    if (cell >= resolution[axis] - 1)
+      return resolution[axis] - 1;
+    return static_cast<std::int32_t>(cell);
+  }
+
+  constexpr std::array<std::int32_t, 3> CellOf(
+      const Tuple& point) const noexcept {
+    return {CellOf(point[0], 0), CellOf(point[1], 1), CellOf(point[2], 2)};
+  }
+
+  /* Number of cells a box overlaps */
+  constexpr std::size_t NumCells(const BoundingBox& box) const noexcept {
+    const std::array<std::int32_t, 3> lo = CellOf(box.lower);
+    const std::array<std::int32_t, 3> hi = CellOf(box.upper);
+    return static_cast<std::size_t>(hi[0] - lo[0] + 1) * (hi[1] - lo[1] + 1) *
+           (hi[2] - lo[2] + 1);
+  }
+
+  /* Key of a cell: its index when dense, its slot entry when hashed, where
+   * `EmptySlot` stands for an unoccupied cell */
+  constexpr std::uint32_t KeyOf(std::int32_t x, std::int32_t y,
+                                std::int32_t z) const noexcept {
+    if constexpr (Layout == GridLayout::Dense) {
+      return static_cast<std::uint32_t>((z * resolution[1] + y) *
+                                            resolution[0] +
+                                        x);
+    } else {
+      return slots[FindSlot(x, y, z)];
+    }
+  }
+
+  /* Slot of a cell in the hash table, or the empty slot ending its probe
+   * sequence */
+  constexpr std::size_t FindSlot(std::int32_t x, std::int32_t y,
+                                 std::int32_t z) const noexcept {
+    const std::size_t mask = slots.size() - 1;
+    std::size_t slot = GridUtils::HashCell(x, y, z) & mask;
+    while (slots[slot] != EmptySlot &&
+           cellCoords[slots[slot]] != std::array<std::int32_t, 3>{x, y, z})
+      slot = (slot + 1) & mask;
+    return slot;
+  }
+
+  /* Key of a cell, added to the hash table if not there yet */
+  constexpr std::uint32_t Insert(std::int32_t x, std::int32_t y,
+                                 std::int32_t z) {
+    const std::size_t slot = FindSlot(x, y, z);
+    if (slots[slot] == EmptySlot) {
+      slots[slot] = static_cast<std::uint32_t>(cellCoords.size());
+      cellCoords.push_back({x, y, z});
+    }
+    return slots[slot];
+  }
+
+  /*!
+   * \brief Walk the cells crossed by the ray inside its interval, nearest
+   * first, calling `visit(shapeIndex)` for the shapes of each until it
+   * returns true.
+   *
+   * The ray is read again after every cell: once a caller clipped its far
+   * end within the cell, no farther cell can hold a nearer hit.
+   *
+   * \return Whether `visit` returned true
+   */
+  template <typename Visit>
+  constexpr bool Traverse(const Ray& ray, Visit&& visit) const {
+    if (cellStart.empty())
+      return false;
+    constexpr Real inf = MathUtils::MathConstants::INF<Real>;
+    const Tuple origin = ray.GetOrigin();
+    const Tuple direction = ray.GetDirection();
+    const Tuple invDirection = ray.GetInvDirection();
+    // clip the ray interval to the grid bounds, as in `BoundingBox::IntersectP`
+    Real tEnter = ray.GetTMin();
+    Real tExit = ray.GetTMax();
+    for (std::size_t axis = 0; axis < 3; axis++) {
+      if (invDirection[axis] == inf) {
+        if (origin[axis] < bounds.lower[axis] ||
+            origin[axis] > bounds.upper[axis])
+          return false;
+        continue;
+      }
+      const bool negative = ray.IsNegative(axis);
+      const Tuple& nearPlane = negative ? bounds.upper : bounds.lower;
+      const Tuple& farPlane = negative ? bounds.lower : bounds.upper;
+      const Real tNear = (nearPlane[axis] - origin[axis]) * invDirection[axis];
+      const Real tFar = (farPlane[axis] - origin[axis]) * invDirection[axis];
+      tEnter = tNear > tEnter ? tNear : tEnter;
+      tExit = tFar < tExit ? tFar : tExit;
+    }
+    if (tEnter > tExit)
+      return false;
+
+    std::array<std::int32_t, 3> cell{};
+    std::array<std::int32_t, 3> step{};
+    // t at which the ray leaves the current cell along each axis, and the
+    // t a whole cell spans along each axis
+    std::array<Real, 3> tNext{};
+    std::array<Real, 3> tDelta{};
+    for (std::size_t axis = 0; axis < 3; axis++) {
+      cell[axis] = CellOf(origin[axis] + direction[axis] * tEnter, axis);
+      if (invDirection[axis] == inf) {
+        step[axis] = 0;
+        tNext[axis] = inf;
+        tDelta[axis] = inf;
+        continue;
+      }
+      const bool negative = ray.IsNegative(axis);
+      step[axis] = negative ? -1 : 1;
+      const Real boundary = bounds.lower[axis] +
+                            (cell[axis] + (negative ? 0 : 1)) * cellSize[axis];
+      tNext[axis] = (boundary - origin[axis]) * invDirection[axis];
+      tDelta[axis] =
+          cellSize[axis] * MathUtils::ConstExprAbsf(invDirection[axis]);
+    }
+
+    while (true) {
+      const std::size_t axis =
+          tNext[0] < tNext[1] ? (tNext[0] < tNext[2] ? 0 : 2)
+                              : (tNext[1] < tNext[2] ? 1 : 2);
+      const std::uint32_t key = KeyOf(cell[0], cell[1], cell[2]);
+      if (Layout == GridLayout::Dense || key != EmptySlot) {
+        for (std::uint32_t i = cellStart[key]; i < cellStart[key + 1]; i++) {
+          if (visit(cellShapes[i]))
+            return true;
+        }
+      }
+      const Real tCellExit = std::min(tNext[axis], tExit);
+      if (ray.GetTMax() <= tCellExit || tNext[axis] > tExit)
+        return false;
+      cell[axis] += step[axis];
+      if (cell[axis] < 0 || cell[axis] >= resolution[axis])
+        return false;
+      tNext[axis] += tDelta[axis];
+    }
+  }
+
+  static constexpr std::uint32_t EmptySlot = ~std::uint32_t{0};
+
+  BoundingBox bounds;
+  std::array<std::int32_t, 3> resolution{};
+  std::array<Real, 3> cellSize{};
+  std::array<Real, 3> invCellSize{};
+  /// hashed layout: open addressing table of the keys of occupied cells,
+  /// a power of two in size, and the coordinates of the cell of each key
+  std::vector<std::uint32_t> slots;
+  std::vector<std::array<std::int32_t, 3>> cellCoords;
+  std::vector<std::uint32_t> cellStart;
+  std::vector<std::uint32_t> cellShapes;
+  std::vector<std::uint32_t> unbounded;
+  std::vector<std::uint32_t> large;
+};
+
+using UniformGrid = BasicGrid<GridLayout::Dense>;
+using HashedGrid = BasicGrid<GridLayout::Hashed>;
+
+}  // namespace RayTracer
+#endif
@@ -0,0 +1,74 @@
+#ifndef ACCEL_INSTANCING_HH
+#define ACCEL_INSTANCING_HH
+#include <accel/bvh.hh>
+#include <cstdint>
+#include <optional>
+#include <primitives.hh>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+namespace RayTracer {
+
+/*!
+ * \brief A `Geometry` owning its shapes and the bottom-level acceleration
+ * structure built over them, any accelerator a `World` accepts.
+ *
+ * Build it once per asset and place it with as many `Instance`s as needed:
+ * an instance is a transform, a material and a pointer, so memory and build
+ * time grow with the unique geometry while the top level, the accelerator of
+ * the world, only sees one shape per instance. The geometry must not move
+ * while instances refer to it, e.g keep it out of a growing `std::vector`.
+ *
+ * Shapes of a geometry are plain shapes: an instance nested inside would
+ * lose the index of the shape hit in its own geometry, and is rejected.
+ */
+template <typename AccelType = BVH>
+class BasicGeometry final : public Geometry {
+ public:
+  constexpr explicit BasicGeometry(std::vector<ShapeWrapper> shapes_)
+      : shapes(std::move(shapes_)), accel{shapes} {
+    bounds = BoundingBox{};
+    for (const ShapeWrapper& shape : shapes) {
+      if (shape.GetShapeType() == InstanceTag)
+        throw std::invalid_argument("Instances cannot be nested");
+      bounds = Union(bounds, shape.IsBounded() ? shape.WorldBounds()
+                                               : BoundingBox::Infinite());
+    }
+  }
+
+  // not defaulted, GCC would define it too late for constant evaluation
+  constexpr ~BasicGeometry() override {}
+
+  constexpr std::optional<Hit> ClosestHit(const Ray& ray) const override {
+    return accel.ClosestHit(shapes, ray);
+  }
+
+  constexpr bool Occluded(const Ray& ray) const override {
+    return accel.Occluded(shapes, ray);
+  }
+
+  constexpr BoundingBox Bounds() const override { return bounds; }
+
+  constexpr Tuple NormalAt(std::uint32_t index,
+                           const Tuple& point) const override {
+    return shapes[index].GetWorldNormalAt(point);
+  }
+
+  constexpr const std::vector<ShapeWrapper>& GetShapes() const {
+    return shapes;
+  }
+
+  constexpr const AccelType& GetAccelerator() const { return accel; }
+
+ private:
+  std::vector<ShapeWrapper> shapes;
+  /// built from `shapes` on construction, declared after them for that reason
+  AccelType accel;
+  /// union of the bounds of `shapes`
+  BoundingBox bounds;
+};
+
+using SharedGeometry = BasicGeometry<BVH>;
+
+}  // namespace RayTracer
+#endif
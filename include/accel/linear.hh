@@ -0,0 +1,64 @@
+#ifndef ACCEL_LINEAR_HH
+#define ACCEL_LINEAR_HH
+#include <cstdint>
+#include <optional>
+#include <primitives.hh>
+namespace RayTracer {
+
+/*!
+ * \brief Acceleration structure of a `World` that tests every shape for
+ * every ray.
+ *
+ * It has no state at all, so it is usable in a `constexpr World` and needs no
+ * rebuild when shapes change. Cost grows linearly with the number of shapes.
+ *
+ * Every accelerator exposes the same interface, `World` forwards its
+ * closest-hit and any-hit queries to it together with its shape container:
+ *   - a constructor building the structure from the shape container,
+ *   - `ClosestHit(shapes, ray)` returning the nearest `Hit` in the ray interval,
+ *   - `Occluded(shapes, ray)` telling whether any shape is hit in it,
+ *   - `Update(shapes)` bringing the structure up to date once shapes moved,
+ *     returning whether it had to be rebuilt from scratch.
+ */
+class LinearAccel final {
+ public:
+  constexpr LinearAccel() noexcept = default;
+
+  template <typename ShapeContType>
+  constexpr explicit LinearAccel(const ShapeContType&) noexcept {}
+
+  template <typename ShapeContType>
+  constexpr std::optional<Hit> ClosestHit(const ShapeContType& shapes,
+                                          const Ray& ray) const {
+    std::optional<Hit> closest = std::nullopt;
+    Ray clipped = ray;
+    for (std::size_t i = 0; i < shapes.size(); i++) {
+      HitBuffer<ShapeWrapper::MaxHits> hits;
+      shapes[i].IntersectInto(clipped, static_cast<std::uint32_t>(i), hits);
+      // shapes append their hits sorted, the first one is the nearest
+      if (!hits.empty()) {
+        closest = hits[0];
+        clipped.ClipTo(hits[0].t);
+      }
+    }
+    return closest;
+  }
+
+  /* Nothing to update, shapes are read on every query */
+  template <typename ShapeContType>
+  constexpr bool Update(const ShapeContType&) const noexcept {
+    return false;
+  }
+
+  template <typename ShapeContType>
+  constexpr bool Occluded(const ShapeContType& shapes, const Ray& ray) const {
+    for (std::size_t i = 0; i < shapes.size(); i++) {
+      if (shapes[i].Occludes(ray))
+        return true;
+    }
+    return false;
+  }
+};
+
+}  // namespace RayTracer
+#endif
@@ -0,0 +1,295 @@
+#ifndef ACCEL_PARTITIONED_HH
+#define ACCEL_PARTITIONED_HH
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <primitives.hh>
+#include <primitives/simd.hh>
+#include <utility>
+#include <vector>
+namespace RayTracer {
+
+namespace PartitionedUtils {
+
+/*!
+ * \brief Spheres of a world in SoA form: the world-to-object transform of
+ * sphere `i` is `inverse[row * 4 + col][i]`, and `ids[i]` its index among
+ * the shapes of the world.
+ *
+ * One loop runs the same arithmetic over every sphere, without `std::visit`
+ * nor any per-shape object to load.
+ */
+struct SphereBuffer {
+  std::array<std::vector<Real>, 12> inverse;
+  std::vector<std::uint32_t> ids;
+
+  constexpr std::size_t size() const noexcept { return ids.size(); }
+
+  constexpr void clear() noexcept {
+    for (std::vector<Real>& coefficient : inverse)
+      coefficient.clear();
+    ids.clear();
+  }
+
+  constexpr void push_back(const AffineTransform& invTransform,
+                           std::uint32_t id) {
+    for (std::size_t row = 0; row < 3; row++) {
+      for (std::size_t col = 0; col < 4; col++)
+        inverse[row * 4 + col].push_back(invTransform[row][col]);
+    }
+    ids.push_back(id);
+  }
+
+  /*!
+   * \brief Nearest root of the ray and unit sphere `i` quadratic inside the
+   * ray interval, +inf if none; same arithmetic as `Sphere`, the ray being
+   * moved to object space first.
+   */
+  constexpr Real NearestRoot(std::size_t i, const Ray& ray) const noexcept {
+    const Tuple o = ray.GetOrigin();
+    const Tuple d = ray.GetDirection();
+    Real origin[3];
+    Real direction[3];
+    for (std::size_t row = 0; row < 3; row++) {
+      const std::size_t r = row * 4;
+      origin[row] = inverse[r][i] * o[0] + inverse[r + 1][i] * o[1] +
+                    inverse[r + 2][i] * o[2] + inverse[r + 3][i];
+      direction[row] = inverse[r][i] * d[0] + inverse[r + 1][i] * d[1] +
+                       inverse[r + 2][i] * d[2];
+    }
+    const Real a = direction[0] * direction[0] + direction[1] * direction[1] +
+                   direction[2] * direction[2];
+    const Real b = 2 * (direction[0] * origin[0] + direction[1] * origin[1] +
+                        direction[2] * origin[2]);
+    const Real c = origin[0] * origin[0] + origin[1] * origin[1] +
+                   origin[2] * origin[2] - 1;
+    const Real discriminant = (b * b) - (4 * a * c);
+    // a near zero discriminant is a tangent ray, see `MathUtils::SolveQuadratic`
+    const bool tangent = MathUtils::ConstExprAbsf(discriminant) < 1e-4;
+    if (!tangent && discriminant < 0)
+      return MathUtils::MathConstants::INF<Real>;
+    const Real sqrtD = tangent ? 0 : MathUtils::ConstExprSqrtf(discriminant);
+    const Real denominator = 1 / (2 * a);
+    const Real r1 = (-b - sqrtD) * denominator;
+    const Real r2 = (-b + sqrtD) * denominator;
+    return ray.Contains(r1)   ? r1
+           : ray.Contains(r2) ? r2
+                              : MathUtils::MathConstants::INF<Real>;
+  }
+
+  /*!
+   * \brief Sphere hit first by the ray and its distance, `size()` if none.
+   *
+   * At run time the spheres go through `SimdUtils::NearestSphereRoot`, a
+   * register of spheres at once; either way a later sphere wins a tie, like
+   * a scan clipping the ray to each hit.
+   */
+  constexpr std::pair<std::size_t, Real> Nearest(const Ray& ray) const {
+    if (!std::is_constant_evaluated()) {
+      std::array<const Real*, 12> columns;
+      for (std::size_t k = 0; k < 12; k++)
+        columns[k] = inverse[k].data();
+      Real t = MathUtils::MathConstants::INF<Real>;
+      const std::size_t nearest = SimdUtils::NearestSphereRoot(
+          columns.data(), size(), ray.GetOrigin().contents.data(),
+          ray.GetDirection().contents.data(), ray.GetTMin(), ray.GetTMax(),
+          &t);
+      return {nearest, t};
+    }
+    std::pair<std::size_t, Real> nearest{size(),
+                                         MathUtils::MathConstants::INF<Real>};
+    Ray clipped = ray;
+    for (std::size_t i = 0; i < size(); i++) {
+      const Real t = NearestRoot(i, clipped);
+      if (t < MathUtils::MathConstants::INF<Real>) {
+        nearest = {i, t};
+        clipped.ClipTo(t);
+      }
+    }
+    return nearest;
+  }
+
+  /*!
+   * \brief Any-hit query: whether a sphere has a root inside the ray
+   * interval, through `SimdUtils::AnySphereHit` at run time which returns at
+   * the first register holding one.
+   */
+  constexpr bool Any(const Ray& ray) const {
+    if (!std::is_constant_evaluated()) {
+      std::array<const Real*, 12> columns;
+      for (std::size_t k = 0; k < 12; k++)
+        columns[k] = inverse[k].data();
+      return SimdUtils::AnySphereHit(columns.data(), size(),
+                                     ray.GetOrigin().contents.data(),
+                                     ray.GetDirection().contents.data(),
+                                     ray.GetTMin(), ray.GetTMax());
+    }
+    for (std::size_t i = 0; i < size(); i++) {
+      if (NearestRoot(i, ray) < MathUtils::MathConstants::INF<Real>)
+        return true;
+    }
+    return false;
+  }
+};
+
+/*!
+ * \brief Planes of a world in SoA form: the object space height of a world
+ * point `p` is `equation[0] * p.x + equation[1] * p.y + equation[2] * p.z +
+ * equation[3]`, the plane being where it vanishes.
+ *
+ * That is the second row of the world-to-object transform, the only one a
+ * plane needs.
+ */
+struct PlaneBuffer {
+  std::array<std::vector<Real>, 4> equation;
+  std::vector<std::uint32_t> ids;
+
+  constexpr std::size_t size() const noexcept { return ids.size(); }
+
+  constexpr void clear() noexcept {
+    for (std::vector<Real>& coefficient : equation)
+      coefficient.clear();
+    ids.clear();
+  }
+
+  constexpr void push_back(const AffineTransform& invTransform,
+                           std::uint32_t id) {
+    for (std::size_t col = 0; col < 4; col++)
+      equation[col].push_back(invTransform[1][col]);
+    ids.push_back(id);
+  }
+
+  /* Distance to plane `i` if inside the ray interval, +inf otherwise */
+  constexpr Real Root(std::size_t i, const Ray& ray) const noexcept {
+    const Tuple o = ray.GetOrigin();
+    const Tuple d = ray.GetDirection();
+    const Real height = equation[0][i] * o[0] + equation[1][i] * o[1] +
+                        equation[2][i] * o[2] + equation[3][i];
+    const Real slope =
+        equation[0][i] * d[0] + equation[1][i] * d[1] + equation[2][i] * d[2];
+    // a ray parallel to the plane never hits it
+    if (MathUtils::ConstExprAbsf(slope) < EPSILON)
+      return MathUtils::MathConstants::INF<Real>;
+    const Real t = -height / slope;
+    return ray.Contains(t) ? t : MathUtils::MathConstants::INF<Real>;
+  }
+};
+
+}  // namespace PartitionedUtils
+
+/*!
+ * \brief Acceleration structure of a `World` testing every shape like
+ * `LinearAccel`, but over copies of the shapes grouped by type into SoA
+ * buffers.
+ *
+ * Spheres only keep their inverse transform and planes their equation, so
+ * each type is tested by its own homogeneous loop over contiguous arrays,
+ * without going through the `std::variant` of `ShapeWrapper`. Other shapes,
+ * e.g instances, are tested through their wrapper. At run time the spheres
+ * are tested several at once by a SIMD kernel. Buffers keep the index
+ * of each shape in the world, the id that hits report, which maps back to
+ * the `ShapeWrapper` and its material for shading.
+ */
+class PartitionedAccel final {
+ public:
+  constexpr PartitionedAccel() = default;
+
+  template <typename ShapeContType>
+  constexpr explicit PartitionedAccel(const ShapeContType& shapes) {
+    Build(shapes);
+  }
+
+  /* (Re)fill the buffers from the current transforms of `shapes` */
+  template <typename ShapeContType>
+  constexpr void Build(const ShapeContType& shapes) {
+    spheres.clear();
+    planes.clear();
+    others.clear();
+    for (std::size_t i = 0; i < shapes.size(); i++) {
+      const auto id = static_cast<std::uint32_t>(i);
+      switch (shapes[i].GetShapeType()) {
+        case SphereTag:
+          spheres.push_back(shapes[i].GetInverseTransform(), id);
+          break;
+        case PlaneTag:
+          planes.push_back(shapes[i].GetInverseTransform(), id);
+          break;
+        default:
+          others.push_back(id);
+      }
+    }
+  }
+
+  /* Copies of the transforms are stale once shapes moved */
+  template <typename ShapeContType>
+  constexpr bool Update(const ShapeContType& shapes) {
+    Build(shapes);
+    return true;
+  }
+
+  template <typename ShapeContType>
+  constexpr std::optional<Hit> ClosestHit(const ShapeContType& shapes,
+                                          const Ray& ray) const {
+    std::optional<Hit> closest = std::nullopt;
+    Ray clipped = ray;
+    // the buffers report +inf for a miss, any finite root is a hit
+    constexpr Real miss = MathUtils::MathConstants::INF<Real>;
+    if (const auto [i, t] = spheres.Nearest(clipped); i < spheres.size()) {
+      closest = Hit{t, spheres.ids[i]};
+      clipped.ClipTo(t);
+    }
+    for (std::size_t i = 0; i < planes.size(); i++) {
+      const Real t = planes.Root(i, clipped);
+      if (t < miss) {
+        closest = Hit{t, planes.ids[i]};
+        clipped.ClipTo(t);
+      }
+    }
+    for (const std::uint32_t id : others) {
+      HitBuffer<ShapeWrapper::MaxHits> hits;
+      shapes[id].IntersectInto(clipped, id, hits);
+      if (!hits.empty()) {
+        closest = hits[0];
+        clipped.ClipTo(hits[0].t);
+      }
+    }
+    return closest;
+  }
+
+  template <typename ShapeContType>
+  constexpr bool Occluded(const ShapeContType& shapes, const Ray& ray) const {
+    constexpr Real miss = MathUtils::MathConstants::INF<Real>;
+    if (spheres.Any(ray))
+      return true;
+    for (std::size_t i = 0; i < planes.size(); i++) {
+      if (planes.Root(i, ray) < miss)
+        return true;
+    }
+    for (const std::uint32_t id : others) {
+      if (shapes[id].Occludes(ray))
+        return true;
+    }
+    return false;
+  }
+
+  constexpr const PartitionedUtils::SphereBuffer& GetSpheres() const noexcept {
+    return spheres;
+  }
+
+  constexpr const PartitionedUtils::PlaneBuffer& GetPlanes() const noexcept {
+    return planes;
+  }
+
+  /* Shapes of other types, tested through their `ShapeWrapper` */
+  constexpr const std::vector<std::uint32_t>& GetOthers() const noexcept {
+    return others;
+  }
+
+ private:
+  PartitionedUtils::SphereBuffer spheres;
+  PartitionedUtils::PlaneBuffer planes;
+  std::vector<std::uint32_t> others;
+};
+
+}  // namespace RayTracer
+#endif
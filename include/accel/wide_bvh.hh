@@ -0,0 +1,330 @@
+#ifndef ACCEL_WIDE_BVH_HH
+#define ACCEL_WIDE_BVH_HH
+#include <accel/bvh.hh>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <primitives.hh>
+#include <primitives/simd.hh>
+#include <primitives/static_vector.hh>
+#include <vector>
+namespace RayTracer {
+
+/*!
+ * \brief Node of a `WideBVH`, holding the bounds of up to `Width` children
+ * in SoA layout so that a ray is tested against all of them at once.
+ *
+ * Unused slots keep empty bounds (lower = +inf, upper = -inf), which no ray
+ * ever crosses, so node tests need not mask them out.
+ */
+template <std::size_t Width>
+struct alignas(32) WideBVHNode {
+  static constexpr Real inf = MathUtils::MathConstants::INF<Real>;
+
+  /// child bounds, [axis][child]
+  std::array<std::array<Real, Width>, 3> lower{
+      MakeFilled(inf), MakeFilled(inf), MakeFilled(inf)};
+  std::array<std::array<Real, Width>, 3> upper{
+      MakeFilled(-inf), MakeFilled(-inf), MakeFilled(-inf)};
+  /// interior child: index of its node,
+  /// leaf child: first entry of its shapes in the shape index list
+  std::array<std::uint32_t, Width> child{};
+  /// number of shapes of a leaf child, 0 for an interior child
+  std::array<std::uint16_t, Width> count{};
+  std::uint8_t numChildren{0};
+
+  constexpr void SetBounds(std::size_t slot, const BoundingBox& bounds) {
+    for (std::size_t axis = 0; axis < 3; axis++) {
+      lower[axis][slot] = bounds.lower[axis];
+      upper[axis][slot] = bounds.upper[axis];
+    }
+  }
+
+  /* Bounds of a child, empty for an unused slot */
+  constexpr BoundingBox GetBounds(std::size_t slot) const {
+    BoundingBox ret;
+    ret.lower = MakePoint(lower[0][slot], lower[1][slot], lower[2][slot]);
+    ret.upper = MakePoint(upper[0][slot], upper[1][slot], upper[2][slot]);
+    return ret;
+  }
+
+ private:
+  static constexpr std::array<Real, Width> MakeFilled(Real value) {
+    std::array<Real, Width> ret{};
+    ret.fill(value);
+    return ret;
+  }
+};
+
+/*!
+ * \brief BVH whose nodes have up to `Width` (4 or 8) children, tested
+ * against a ray in one go by `SimdUtils::SlabTestWide`.
+ *
+ * It is obtained by collapsing a binary SAH `BVH`: each wide node repeatedly
+ * opens its interior child of largest surface area until it holds `Width`
+ * children, so the tree is about log2(Width) times shallower and a traversal
+ * loads fewer, larger nodes. Leaves and shape indices are those of the binary
+ * tree, and shapes with infinite bounds are likewise kept aside.
+ *
+ * The closest-hit query visits the children a ray crosses nearest first, in
+ * order of their entry distance along the ray, and skips any child whose
+ * entry lies past the nearest hit found by the time it is popped. The
+ * any-hit query visits them in node order.
+ *
+ * Used as the `AccelType` of a `World`, see `LinearAccel` for the interface.
+ * Storage is a `std::vector`, so it is meant for run-time worlds.
+ */
+template <std::size_t Width>
+class WideBVH final {
+ public:
+  static_assert(Width == 4 || Width == 8, "wide BVH nodes hold 4 or 8 children");
+  using Node = WideBVHNode<Width>;
+
+  constexpr WideBVH() noexcept = default;
+
+  template <typename ShapeContType>
+  constexpr explicit WideBVH(const ShapeContType& shapes) {
+    Build(shapes);
+  }
+
+  /* (Re)build the binary hierarchy over `shapes` and collapse it */
+  template <typename ShapeContType>
+  constexpr void Build(const ShapeContType& shapes) {
+    Collapse(BVH{shapes});
+  }
+
+  /* Take over the leaves of an already built binary hierarchy */
+  template <typename NodeStorage, typename IndexStorage, BVHBuilder Builder>
+  constexpr void Collapse(
+      const BasicBVH<NodeStorage, IndexStorage, Builder>& binary) {
+    nodes.clear();
+    const auto& binaryIndices = binary.GetShapeIndices();
+    const auto& binaryUnbounded = binary.GetUnbounded();
+    shapeIndices.assign(binaryIndices.begin(), binaryIndices.end());
+    unbounded.assign(binaryUnbounded.begin(), binaryUnbounded.end());
+    const auto& binaryNodes = binary.GetNodes();
+    if (binaryNodes.empty())
+      return;
+    nodes.reserve(binaryNodes.size() / (Width - 1) + 1);
+    CollapseRecursive(binaryNodes, 0);
+  }
+
+  /* Rebuild from scratch, the collapsed tree has no cheaper update */
+  template <typename ShapeContType>
+  constexpr bool Update(const ShapeContType& shapes) {
+    Build(shapes);
+    return true;
+  }
+
+  template <typename ShapeContType>
+  constexpr std::optional<Hit> ClosestHit(const ShapeContType& shapes,
+                                          const Ray& ray) const {
+    std::optional<Hit> closest = std::nullopt;
+    Ray clipped = ray;
+    const auto intersect = [&](std::uint32_t index) {
+      HitBuffer<ShapeWrapper::MaxHits> hits;
+      shapes[index].IntersectInto(clipped, index, hits);
+      if (!hits.empty()) {
+        closest = hits[0];
+        clipped.ClipTo(hits[0].t);
+      }
+      return false;
+    };
+    for (const std::uint32_t index : unbounded)
+      intersect(index);
+    Traverse<true>(clipped, intersect);
+    return closest;
+  }
+
+  template <typename ShapeContType>
+  constexpr bool Occluded(const ShapeContType& shapes, const Ray& ray) const {
+    const auto occludes = [&](std::uint32_t index) {
+      return shapes[index].Occludes(ray);
+    };
+    for (const std::uint32_t index : unbounded) {
+      if (occludes(index))
+        return true;
+    }
+    return Traverse<false>(ray, occludes);
+  }
+
+  constexpr const std::vector<Node>& GetNodes() const noexcept {
+    return nodes;
+  }
+
+  /* Shape indices in leaf order, a leaf refers to a range of this list */
+  constexpr const std::vector<std::uint32_t>& GetShapeIndices()
+      const noexcept {
+    return shapeIndices;
+  }
+
+  /* Shapes with infinite bounds, kept out of the hierarchy */
+  constexpr const std::vector<std::uint32_t>& GetUnbounded() const noexcept {
+    return unbounded;
+  }
+
+ private:
+  /* Child of a wide node, or entry of the traversal stack */
+  struct ChildRef {
+    std::uint32_t index{0};
+    /// number of shapes of a leaf, 0 for a node
+    std::uint16_t count{0};
+    Real tEntry{0};
+  };
+
+  /* Emit the wide node standing for binary node `root` and its descendants
+   * down to `Width` children, and return its index */
+  template <typename BinaryNodes>
+  constexpr std::uint32_t CollapseRecursive(const BinaryNodes& binaryNodes,
+                                            std::uint32_t root) {
+    const auto nodeIndex = static_cast<std::uint32_t>(nodes.size());
+    nodes.push_back(Node{});
+    StaticVector<std::uint32_t, Width> children;
+    if (binaryNodes[root].IsLeaf()) {
+      children.push_back(root);
+    } else {
+      children.push_back(root + 1);
+      children.push_back(binaryNodes[root].offset);
+    }
+    // open the largest interior child until the node is full
+    while (children.size() < Width) {
+      std::size_t largest = children.size();
+      Real largestArea = -1;
+      for (std::size_t i = 0; i < children.size(); i++) {
+        const auto& child = binaryNodes[children[i]];
+        const Real area = child.bounds.SurfaceArea();
+        if (!child.IsLeaf() && area > largestArea) {
+          largest = i;
+          largestArea = area;
+        }
+      }
+      if (largest == children.size())
+        break;
+      const std::uint32_t opened = children[largest];
+      children[largest] = opened + 1;
+      children.push_back(binaryNodes[opened].offset);
+    }
+
+    nodes[nodeIndex].numChildren = static_cast<std::uint8_t>(children.size());
+    for (std::size_t slot = 0; slot < children.size(); slot++) {
+      const auto& child = binaryNodes[children[slot]];
+      nodes[nodeIndex].SetBounds(slot, child.bounds);
+      if (child.IsLeaf()) {
+        nodes[nodeIndex].child[slot] = child.offset;
+        nodes[nodeIndex].count[slot] = child.count;
+      } else {
+        // `nodes` may grow, write the child index once it is known
+        const std::uint32_t childIndex =
+            CollapseRecursive(binaryNodes, children[slot]);
+        nodes[nodeIndex].child[slot] = childIndex;
+      }
+    }
+    return nodeIndex;
+  }
+
+  /* Mask of the children of `node` crossed by the ray within its interval,
+   * with their entry distances */
+  static constexpr unsigned IntersectChildren(
+      const Node& node, const Ray& ray, std::array<Real, Width>& tEntry) {
+    const Tuple origin = ray.GetOrigin();
+    const Tuple invDirection = ray.GetInvDirection();
+    const Real* nearPlanes[3];
+    const Real* farPlanes[3];
+    for (std::size_t axis = 0; axis < 3; axis++) {
+      const bool negative = ray.IsNegative(axis);
+      nearPlanes[axis] = (negative ? node.upper : node.lower)[axis].data();
+      farPlanes[axis] = (negative ? node.lower : node.upper)[axis].data();
+    }
+    if (!std::is_constant_evaluated()) {
+      return SimdUtils::SlabTestWide<Width>(
+          nearPlanes, farPlanes, origin.contents.data(),
+          invDirection.contents.data(), ray.GetTMin(), ray.GetTMax(),
+          tEntry.data());
+    }
+    unsigned mask = 0;
+    for (std::size_t slot = 0; slot < node.numChildren; slot++) {
+      Real t0 = ray.GetTMin();
+      Real t1 = ray.GetTMax();
+      bool crossed = true;
+      for (std::size_t axis = 0; axis < 3 && crossed; axis++) {
+        // parallel to the slab: inside it or never, see BoundingBox
+        if (invDirection[axis] == MathUtils::MathConstants::INF<Real>) {
+          crossed = origin[axis] >= node.lower[axis][slot] &&
+                    origin[axis] <= node.upper[axis][slot];
+          continue;
+        }
+        const Real tNear =
+            (nearPlanes[axis][slot] - origin[axis]) * invDirection[axis];
+        const Real tFar =
+            (farPlanes[axis][slot] - origin[axis]) * invDirection[axis];
+        t0 = tNear > t0 ? tNear : t0;
+        t1 = tFar < t1 ? tFar : t1;
+        crossed = t0 <= t1;
+      }
+      tEntry[slot] = t0;
+      mask |= static_cast<unsigned>(crossed) << slot;
+    }
+    return mask;
+  }
+
+  /*!
+   * \brief Visit the shapes of every leaf crossed by the ray until
+   * `visit(shapeIndex)` returns true, children of a node nearest first when
+   * `Sorted`.
+   *
+   * \return Whether the traversal was stopped by `visit`
+   */
+  template <bool Sorted, typename Visitor>
+  constexpr bool Traverse(const Ray& ray, Visitor&& visit) const {
+    if (nodes.empty())
+      return false;
+    // every level leaves at most Width - 1 siblings behind
+    std::array<ChildRef, BVHUtils::MaxDepth*(Width - 1) + 1> stack{};
+    std::size_t stackSize = 0;
+    stack[stackSize++] = ChildRef{0, 0, ray.GetTMin()};
+    std::array<Real, Width> tEntry{};
+    while (stackSize > 0) {
+      const ChildRef current = stack[--stackSize];
+      // `ray` may have been clipped by a hit since this child was pushed
+      if (current.tEntry > ray.GetTMax())
+        continue;
+      if (current.count > 0) {
+        for (std::size_t i = 0; i < current.count; i++) {
+          if (visit(shapeIndices[current.index + i]))
+            return true;
+        }
+        continue;
+      }
+      const Node& node = nodes[current.index];
+      unsigned mask = IntersectChildren(node, ray, tEntry);
+      const std::size_t first = stackSize;
+      for (std::size_t slot = 0; mask != 0; slot++, mask >>= 1) {
+        if (mask & 1)
+          stack[stackSize++] =
+              ChildRef{node.child[slot], node.count[slot], tEntry[slot]};
+      }
+      if constexpr (Sorted) {
+        // farthest child at the bottom, nearest one popped next
+        std::sort(stack.begin() + first, stack.begin() + stackSize,
+                  [](const ChildRef& lhs, const ChildRef& rhs) {
+                    return lhs.tEntry > rhs.tEntry;
+                  });
+      }
+    }
+    return false;
+  }
+
+  std::vector<Node> nodes;
+  std::vector<std::uint32_t> shapeIndices;
+  std::vector<std::uint32_t> unbounded;
+};
+
+/* 4-wide BVH, one AVX register of double child bounds per axis */
+using BVH4 = WideBVH<4>;
+
+/* 8-wide BVH */
+using BVH8 = WideBVH<8>;
+
+}  // namespace RayTracer
+#endif
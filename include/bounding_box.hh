@@ -0,0 +1,199 @@
+#ifndef BOUNDING_BOX_HH
+#define BOUNDING_BOX_HH
+#include <primitives/simd.hh>
+#include <primitives/vec.hh>
+#include <ray.hh>
+#include <transform.hh>
+#include <utils/math.hh>
+namespace RayTracer {
+
+/*!
+ * \brief Axis-aligned bounding box given by its lower and upper corner points.
+ *
+ * A default-constructed box is empty (lower = +inf, upper = -inf) so that it
+ * is the identity of `Union`. Unbounded shapes such as planes report
+ * `BoundingBox::Infinite()`, which acceleration structures keep aside.
+ */
+class BoundingBox final {
+ public:
+  /* Empty box */
+  constexpr BoundingBox() noexcept
+      : lower{PredefinedTuples::MinPoint}, upper{PredefinedTuples::MaxPoint} {}
+
+  /* Box enclosing a single point */
+  constexpr explicit BoundingBox(const Tuple& point) noexcept
+      : lower{point}, upper{point} {}
+
+  /* Box spanned by two opposite corners, in any order */
+  constexpr BoundingBox(const Tuple& p1, const Tuple& p2) noexcept
+      : lower{VecUtils::Min(p1, p2)}, upper{VecUtils::Max(p1, p2)} {}
+
+  static constexpr BoundingBox Infinite() noexcept {
+    BoundingBox ret;
+    ret.lower = PredefinedTuples::MaxPoint;
+    ret.upper = PredefinedTuples::MinPoint;
+    return ret;
+  }
+
+  constexpr bool IsEmpty() const noexcept {
+    return lower[TupleConstants::x] > upper[TupleConstants::x] ||
+           lower[TupleConstants::y] > upper[TupleConstants::y] ||
+           lower[TupleConstants::z] > upper[TupleConstants::z];
+  }
+
+  /* Whether the box is non-empty and has no infinite extent */
+  constexpr bool IsFinite() const noexcept {
+    constexpr Real inf = MathUtils::MathConstants::INF<Real>;
+    for (std::size_t axis = 0; axis < 3; axis++) {
+      if (MathUtils::ConstExprAbsf(lower[axis]) == inf ||
+          MathUtils::ConstExprAbsf(upper[axis]) == inf)
+        return false;
+    }
+    return !IsEmpty();
+  }
+
+  constexpr Tuple Diagonal() const noexcept { return upper - lower; }
+
+  constexpr Tuple Centroid() const noexcept {
+    return lower + (upper - lower) * Real(0.5);
+  }
+
+  constexpr Real SurfaceArea() const noexcept {
+    if (IsEmpty())
+      return 0;
+    const Tuple d = Diagonal();
+    return 2 * (d[TupleConstants::x] * d[TupleConstants::y] +
+                d[TupleConstants::x] * d[TupleConstants::z] +
+                d[TupleConstants::y] * d[TupleConstants::z]);
+  }
+
+  /* Index (0, 1 or 2) of the axis along which the box is the longest */
+  constexpr std::size_t MaximumExtent() const noexcept {
+    const Tuple d = Diagonal();
+    if (d[TupleConstants::x] > d[TupleConstants::y] &&
+        d[TupleConstants::x] > d[TupleConstants::z])
+      return TupleConstants::x;
+    return d[TupleConstants::y] > d[TupleConstants::z] ? TupleConstants::y
+                                                       : TupleConstants::z;
+  }
+
+  /* Corner i, bit 0/1/2 of i selecting the upper bound along x/y/z */
+  constexpr Tuple Corner(std::size_t i) const noexcept {
+    const auto pick = [&](std::size_t axis) {
+      return (i >> axis) & 1 ? upper[axis] : lower[axis];
+    };
+    return MakePoint(pick(TupleConstants::x), pick(TupleConstants::y),
+                     pick(TupleConstants::z));
+  }
+
+  constexpr bool Contains(const Tuple& point) const noexcept {
+    for (std::size_t axis = 0; axis < 3; axis++) {
+      if (point[axis] < lower[axis] || point[axis] > upper[axis])
+        return false;
+    }
+    return true;
+  }
+
+  /*!
+   * \brief Bounds of this box once transformed, enclosing its 8 transformed
+   * corners. An infinite box stays infinite.
+   */
+  constexpr BoundingBox Transform(
+      const AffineTransform& transform) const noexcept;
+
+  /*!
+   * \brief Slab test: whether the ray crosses the box inside its [tMin, tMax]
+   * interval.
+   *
+   * Uses the inverse direction and direction signs cached on the ray. At run
+   * time the three slabs are tested at once by `SimdUtils::SlabTest`.
+   */
+  constexpr bool IntersectP(const Ray& ray) const noexcept {
+    const Tuple origin = ray.GetOrigin();
+    const Tuple invDirection = ray.GetInvDirection();
+    if (!std::is_constant_evaluated()) {
+      return SimdUtils::SlabTest(lower.contents.data(), upper.contents.data(),
+                                 origin.contents.data(),
+                                 invDirection.contents.data(), ray.GetTMin(),
+                                 ray.GetTMax());
+    }
+    Real t0 = ray.GetTMin();
+    Real t1 = ray.GetTMax();
+    for (std::size_t axis = 0; axis < 3; axis++) {
+      // parallel to the slab: inside it or never, and 0 * inf is not a
+      // constant expression
+      if (invDirection[axis] == MathUtils::MathConstants::INF<Real>) {
+        if (origin[axis] < lower[axis] || origin[axis] > upper[axis])
+          return false;
+        continue;
+      }
+      const bool negative = ray.IsNegative(axis);
+      const Tuple& nearPlane = negative ? upper : lower;
+      const Tuple& farPlane = negative ? lower : upper;
+      const Real tNear = (nearPlane[axis] - origin[axis]) * invDirection[axis];
+      const Real tFar = (farPlane[axis] - origin[axis]) * invDirection[axis];
+      t0 = tNear > t0 ? tNear : t0;
+      t1 = tFar < t1 ? tFar : t1;
+      if (t0 > t1)
+        return false;
+    }
+    return true;
+  }
+
+  friend std::ostream& operator<<(std::ostream& stream,
+                                  const BoundingBox& box) noexcept {
+    return stream << "BoundingBox(" << box.lower << ", " << box.upper << ')';
+  }
+
+  Tuple lower;
+  Tuple upper;
+};
+
+constexpr BoundingBox Union(const BoundingBox& box,
+                            const Tuple& point) noexcept {
+  BoundingBox ret;
+  ret.lower = VecUtils::Min(box.lower, point);
+  ret.upper = VecUtils::Max(box.upper, point);
+  return ret;
+}
+
+constexpr BoundingBox Union(const BoundingBox& lhs,
+                            const BoundingBox& rhs) noexcept {
+  BoundingBox ret;
+  ret.lower = VecUtils::Min(lhs.lower, rhs.lower);
+  ret.upper = VecUtils::Max(lhs.upper, rhs.upper);
+  return ret;
+}
+
+constexpr bool operator==(const BoundingBox& lhs,
+                          const BoundingBox& rhs) noexcept {
+  return lhs.lower == rhs.lower && lhs.upper == rhs.upper;
+}
+
+constexpr bool operator!=(const BoundingBox& lhs,
+                          const BoundingBox& rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+constexpr BoundingBox BoundingBox::Transform(
+    const AffineTransform& transform) const noexcept {
+  if (!IsFinite())
+    return IsEmpty() ? *this : Infinite();
+  // Same box as the union of the 8 transformed corners (Arvo): the centre
+  // moves as a point and the half extent along each axis sums the absolute
+  // contributions of the input half extents, one point transform in all
+  const Tuple center = Centroid();
+  const Tuple half = upper - center;
+  const Tuple newCenter = transform.TransformPoint(center);
+  Tuple newHalf = PredefinedTuples::ZeroVector;
+  for (std::size_t row = 0; row < 3; row++) {
+    for (std::size_t col = 0; col < 3; col++)
+      newHalf.contents[row] +=
+          MathUtils::ConstExprAbsf(transform.contents[row][col]) *
+          half.contents[col];
+  }
+  return BoundingBox{newCenter - newHalf, newCenter + newHalf};
+}
+
+}  // namespace RayTracer
+#endif
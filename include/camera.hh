@@ -14,29 +14,37 @@ class Camera final {
   std::size_t vsize;
 
   /// how much the camera can see.
-  double fov;
+  Real fov;
 
   /// half of canvas width in world unit
-  double halfWidth;
+  Real halfWidth;
 
   /// half of canvas height in world unit
-  double halfHeight;
+  Real halfHeight;
 
   /// how much one pixel equal to world unit
-  double pixelSize;
+  Real pixelSize;
 
   /// a matrix describing how the world should be oriented relative
   /// to the camera (camera to world matrix)
   Transform transform;
 
+  /// inverse of `transform`, computed once so that `RayForPixel` does not
+  /// invert a matrix for every pixel
+  AffineTransform invTransform;
+
  public:
   constexpr Camera(
-      const std::size_t hsize_, const std::size_t vsize_, const double fov_,
-      const Transform& transform_ = PredefinedMatrices::I<double, 4>)
-      : hsize{hsize_}, vsize{vsize_}, fov{fov_}, transform{transform_} {
+      const std::size_t hsize_, const std::size_t vsize_, const Real fov_,
+      const Transform& transform_ = PredefinedMatrices::I<Real, 4>)
+      : hsize{hsize_},
+        vsize{vsize_},
+        fov{fov_},
+        transform{transform_},
+        invTransform{Inverse(AffineTransform(transform_))} {
     const auto halfView = MathUtils::Tangent(fov / 2);
     const auto aspectRatio =
-        (static_cast<double>(hsize) / static_cast<double>(vsize));
+        (static_cast<Real>(hsize) / static_cast<Real>(vsize));
 
     // image width >= image height (in pixels)
     // meaning that there is more pixels along the y axis then there is along the x axis
@@ -64,32 +72,33 @@ class Camera final {
 
   std::size_t HorizontalSize() const { return hsize; }
   std::size_t VerticalSize() const { return vsize; }
-  double FieldOfView() const { return fov; }
-  double PixelSize() const { return pixelSize; }
+  Real FieldOfView() const { return fov; }
+  Real PixelSize() const { return pixelSize; }
   Transform TransformMatrix() const { return transform; }
 
   /** Emit a new ray that start at the camera and pass through the indicaed pixel location on the canvas.
    * @param x  x-location on canvas(in pixels)
    * @param y  y-location on canvas(in pixels)
    */
-  constexpr Ray RayForPixel(double px, double py) const noexcept {
+  constexpr Ray RayForPixel(Real px, Real py) const noexcept {
     // the offset from the edge of the canvas to the pixel's center
     // the reason we add a small shift (0.5) to the pixel position because we want the final camera ray to pass through the middle of the pixel
-    const double xOffset = (px + 0.5) * pixelSize;  //in world-units
-    const double yOffset = (py + 0.5) * pixelSize;  //in world-units
+    const Real xOffset = (px + 0.5) * pixelSize;  //in world-units
+    const Real yOffset = (py + 0.5) * pixelSize;  //in world-units
     // the untransformed coordinate of the pixel in world-space
     // (since camera look toward -z, so +x axis is to the left)
-    const double xWorld = halfWidth - xOffset;
-    const double yWorld = halfHeight - yOffset;
+    const Real xWorld = halfWidth - xOffset;
+    const Real yWorld = halfHeight - yOffset;
 
     // using the camera matrix transform the canvas point and the origin,
     // then compute the ray's direction vector
     // (remember that the canvas is at z = -1)
-    const auto w2c = Inverse(transform);
+    const auto& w2c = invTransform;
 
     const auto pixelCam =
-        w2c * MakePoint(xWorld, yWorld, -1);          // in camera space
-    const auto originCam = w2c * MakePoint(0, 0, 0);  // in camera space
+        w2c.TransformPoint(MakePoint(xWorld, yWorld, -1));  // in camera space
+    const auto originCam =
+        w2c.TransformPoint(PredefinedTuples::ZeroPoint);  // in camera space
 
     const auto directionCam = ToNormalizedVector(pixelCam - originCam);
     return Ray{originCam, directionCam};
@@ -45,13 +45,13 @@ class Canvas final {
       for (auto j = 0; j < width; j++) {
         int r = static_cast<int>(std::clamp(
             ((*this)(i, j)[ColourConstants::r]) * ColourConstants::MaxValue,
-            0.0, (double)ColourConstants::MaxValue));
+            Real(0), (Real)ColourConstants::MaxValue));
         int g = static_cast<int>(std::clamp(
             ((*this)(i, j)[ColourConstants::g]) * ColourConstants::MaxValue,
-            0.0, (double)ColourConstants::MaxValue));
+            Real(0), (Real)ColourConstants::MaxValue));
         int b = static_cast<int>(std::clamp(
             ((*this)(i, j)[ColourConstants::b]) * ColourConstants::MaxValue,
-            0.0, (double)ColourConstants::MaxValue));
+            Real(0), (Real)ColourConstants::MaxValue));
 
         auto valueWidth = MathUtils::NumOfDigits(r, g, b);
 
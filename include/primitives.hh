@@ -1,6 +1,8 @@
 #ifndef SHAPE_HH
 #define SHAPE_HH
+#include <bounding_box.hh>
 #include <concepts>
+#include <cstdint>
 #include <optional>
 #include <primitives/matrix.hh>
 #include <primitives/static_base.hh>
@@ -12,7 +14,7 @@
 
 namespace RayTracer {
 
-enum ShapeType { SphereTag, PlaneTag, None };
+enum ShapeType { SphereTag, PlaneTag, InstanceTag, None };
 enum PatternType {
   StripeTag,
   GradientTag,
@@ -31,7 +33,7 @@ class StridePattern;
 class ShapeWrapper;
 
 struct HitRecord {
-  float t;
+  Real t;
   const ShapeWrapper* shapePtr{nullptr};
   Tuple eyeV;
   Tuple point;
@@ -42,27 +44,35 @@ struct HitRecord {
 
 class Intersection {
  public:
-  float t{0.f};
+  Real t{0.f};
   ShapeType shapeType{None};
   const ShapeWrapper* shapePtr{nullptr};
+  /// shape hit inside the geometry of an `Instance`, 0 for other shapes
+  std::uint32_t primIndex{0};
 
   constexpr Intersection() noexcept = default;
 
-  constexpr Intersection(float t_, const ShapeWrapper* shapePtr_)
-      : t{t_}, shapePtr{shapePtr_} {}
+  constexpr Intersection(Real t_, const ShapeWrapper* shapePtr_,
+                         std::uint32_t primIndex_ = 0)
+      : t{t_}, shapePtr{shapePtr_}, primIndex{primIndex_} {}
 
   constexpr Intersection(const Intersection& other)
-      : t(other.t), shapeType(other.shapeType), shapePtr(other.shapePtr) {}
+      : t(other.t),
+        shapeType(other.shapeType),
+        shapePtr(other.shapePtr),
+        primIndex(other.primIndex) {}
 
   constexpr Intersection(Intersection&& other)
       : t(std::exchange(other.t, 0)),
         shapeType(std::exchange(other.shapeType, ShapeType::None)),
-        shapePtr(std::exchange(other.shapePtr, nullptr)) {}
+        shapePtr(std::exchange(other.shapePtr, nullptr)),
+        primIndex(std::exchange(other.primIndex, 0)) {}
 
   constexpr Intersection& operator=(const Intersection& other) noexcept {
     shapePtr = other.shapePtr;
     shapeType = other.shapeType;
     t = other.t;
+    primIndex = other.primIndex;
     return *this;
   }
 
@@ -70,27 +80,35 @@ class Intersection {
     shapePtr = std::exchange(other.shapePtr, nullptr);
     shapeType = std::exchange(other.shapeType, ShapeType::None);
     t = std::exchange(other.t, 0);
+    primIndex = std::exchange(other.primIndex, 0);
     return *this;
   }
-  constexpr float GetIntersectDistance() const { return t; }
+  constexpr Real GetIntersectDistance() const { return t; }
   constexpr HitRecord PrepareComputation(const Ray& ray) const;
 
   constexpr ShapeType GetShapeType() const;
 };
 
 /*!
- * \brief An "midway" class responsible for wrapping different shapes's 
- * intersection result during rendering computation for unifying calling interface.
- * 
- * To account for different return type of intersection function by different shape objects.  
- * (check out `ShapesTraits` class for detail) And to account for the case where "no-hitting" occurs
- * the `IntxnRetVariant` could sometimes be empty, so any function that return a `IntxnRetVariant` 
- * should further calling `VisibleHitFromVariant` (which first determing its holding value, and
- * later calling `VisibleHit` and return most visible hits)
- * as a underlying return type dispatching function.
+ * \brief Compact record of a ray hit: the distance along the ray and the index
+ * of the hit shape in its world (12 bytes with a float `Real`, 16 with
+ * double).
+ *
+ * Shapes append their hits straight into a `HitBuffer` sized by the caller
+ * (`NumXSOf` bounds it for a whole world), and only the hit that gets shaded
+ * is turned back into an `Intersection`. Hits of an `Instance` also carry the
+ * index of the shape hit inside its geometry, for the normal at that point.
  */
-using IntxnRetVariant =
-    std::variant<StaticVector<Intersection, 2>, StaticVector<Intersection, 1>>;
+struct Hit {
+  Real t{0};
+  std::uint32_t shapeIndex{0};
+  std::uint32_t primIndex{0};
+};
+// no padding, whichever the precision
+static_assert(sizeof(Hit) == sizeof(Real) + 2 * sizeof(std::uint32_t));
+
+template <std::size_t N>
+using HitBuffer = StaticVector<Hit, N>;
 
 constexpr bool operator==(const Intersection& lhs, const Intersection& rhs) {
   return MathUtils::ApproxEqual(lhs.GetIntersectDistance(),
@@ -189,32 +207,9 @@ requires(std::same_as<typename IntersectionList::value_type, Intersection>)
              : std::optional{intersections[0]};
 }
 
-/*!
- * \brief Filter most visible hits from `IntxnRetVariant` object 
- * \return Either return the encapsulation information `Intersection` from most visible 
- * intersection point or nullopt if tracing ray totally missing from the shape object.
- * */
-[[nodiscard]] constexpr std::optional<Intersection> VisibleHitFromVariant(
-    const IntxnRetVariant& variant) noexcept {
-  auto visitor = [&](auto&& v) {
-    using T = PrimitiveTraits::RemoveCVR<decltype(v)>;
-    if constexpr (std::same_as<T, StaticVector<Intersection, 2>>) {
-      const auto xs = std::get<StaticVector<Intersection, 2>>(variant);
-      const auto ret = VisibleHit(xs);
-      return ret;
-    } else if constexpr (std::same_as<T, StaticVector<Intersection, 1>>) {
-      const auto xs = std::get<StaticVector<Intersection, 1>>(variant);
-      const auto ret = VisibleHit(xs);
-      return ret;
-    }
-  };
-  const auto ret = std::visit(visitor, variant);
-  return ret;
-}
-
 }  // namespace IntersectionUtils
 
-template <typename FT = double>
+template <typename FT = Real>
 requires(std::is_floating_point_v<
          PrimitiveTraits::RemoveCVR<FT>>) class PerlinNoise {
  public:
@@ -393,12 +388,14 @@ template <typename T>
 class Pattern : public StaticBase<T, Pattern> {
  public:
   constexpr Pattern()
-      : transform{PredefinedMatrices::I<double, 4>},
+      : transform{PredefinedMatrices::I<Real, 4>},
+        invTransform{},
         colourA{PredefinedColours::WHITE},
         colourB{PredefinedColours::BLACK} {}
 
   constexpr Pattern(const Transform& transform_)
       : transform{transform_},
+        invTransform{Inverse(AffineTransform(transform_))},
         colourA{PredefinedColours::WHITE},
         colourB{PredefinedColours::BLACK} {}
 
@@ -411,11 +408,13 @@ class Pattern : public StaticBase<T, Pattern> {
   * given world-space point, and it should respect the transformations on both the
   * pattern and the object while doing so.
   * 
-  * \param object the shape object for evaluating stride colour with respect to its transformation.
+  * \param object the shape object for evaluating stride colour with respect to its transformation,
+  * a `ShapeWrapper` or any concrete shape
   * \param world point the stride point in world-coordinate for evaluating stride colour 
   * \return colour of stride point
   */
-  [[nodiscard]] constexpr Colour StrideAtObject(const ShapeWrapper& object,
+  template <typename ObjectType>
+  [[nodiscard]] constexpr Colour StrideAtObject(const ObjectType& object,
                                                 const Tuple& worldPoint) const;
 
   constexpr PatternType GetPatternType() const {
@@ -424,6 +423,7 @@ class Pattern : public StaticBase<T, Pattern> {
 
   constexpr void SetTransform(const Transform& transform_) {
     transform = transform_;
+    invTransform = Inverse(AffineTransform(transform_));
   }
 
   constexpr void SetColourA(const Colour& colourA_) { colourA = colourA_; }
@@ -432,7 +432,13 @@ class Pattern : public StaticBase<T, Pattern> {
 
   constexpr Transform GetTransform() const { return transform; }
 
-  Transform transform{PredefinedMatrices::I<double, 4>};
+  constexpr const AffineTransform& GetInverseTransform() const {
+    return invTransform;
+  }
+
+  Transform transform{PredefinedMatrices::I<Real, 4>};
+  /// cached inverse of `transform`, kept in sync by `SetTransform`
+  AffineTransform invTransform{};
   Colour colourA{PredefinedColours::WHITE}, colourB{PredefinedColours::BLACK};
 };
 
@@ -442,7 +448,8 @@ class StridePattern : public Pattern<StridePattern> {
 
   [[nodiscard]] constexpr Colour StrideAt(const Tuple& point) const {
     if (MathUtils::ApproxEqual(
-            MathUtils::Modulo(MathUtils::Floor(point[TupleConstants::x]), 2.0),
+            MathUtils::Modulo(MathUtils::Floor(point[TupleConstants::x]),
+                              Real(2)),
             0.0))
       return colourA;
     else
@@ -482,9 +489,9 @@ class RingPattern : public Pattern<RingPattern> {
   [[nodiscard]] constexpr Colour StrideAt(const Tuple& point) const {
     const auto pXSquare = point[TupleConstants::x] * point[TupleConstants::x];
     const auto pZSquare = point[TupleConstants::z] * point[TupleConstants::z];
-    const double magnitude = MathUtils::ConstExprSqrtf(pXSquare + pZSquare);
+    const Real magnitude = MathUtils::ConstExprSqrtf(pXSquare + pZSquare);
     if (MathUtils::ApproxEqual(
-            MathUtils::Modulo(MathUtils::Floor(magnitude), 2.0), 0.0))
+            MathUtils::Modulo(MathUtils::Floor(magnitude), Real(2)), 0.0))
       return colourA;
     else
       return colourB;
@@ -500,7 +507,7 @@ class CheckerPattern : public Pattern<CheckerPattern> {
     const auto pY = MathUtils::Floor(point[TupleConstants::y]);
     const auto pZ = MathUtils::Floor(point[TupleConstants::z]);
     if (MathUtils::ApproxEqual(
-            MathUtils::Modulo(MathUtils::Floor(pX + pY + pZ), 2.0), 0.0))
+            MathUtils::Modulo(MathUtils::Floor(pX + pY + pZ), Real(2)), 0.0))
       return colourA;
     else
       return colourB;
@@ -525,7 +532,7 @@ class RadialGradientPattern : public Pattern<RadialGradientPattern> {
     const Colour delta = colourB - colourA;
     const auto pXSquare = point[TupleConstants::x] * point[TupleConstants::x];
     const auto pZSquare = point[TupleConstants::z] * point[TupleConstants::z];
-    const double magnitude = MathUtils::ConstExprSqrtf(pXSquare + pZSquare);
+    const Real magnitude = MathUtils::ConstExprSqrtf(pXSquare + pZSquare);
     const Colour radialColor = colourA + (delta * magnitude);
     // make sure color in valid range
     if (!IsValidColour(radialColor)) {
@@ -581,6 +588,14 @@ class PatternWrapper {
         patternObject);
   }
 
+  constexpr const AffineTransform& GetInverseTransform() const {
+    return std::visit(
+        [&](auto const& elem) -> const AffineTransform& {
+          return elem.GetInverseTransform();
+        },
+        patternObject);
+  }
+
   /*!
   * \brief Return the color for PatternWrapper's underlying pattern type, 
   * on the given object at the given world-space point, and it should respect 
@@ -593,7 +608,8 @@ class PatternWrapper {
   * \param world point the stride point in world-coordinate for evaluating stride colour 
   * \return colour of stride point
   */
-  [[nodiscard]] constexpr Colour StrideAtObject(const ShapeWrapper& object,
+  template <typename ObjectType>
+  [[nodiscard]] constexpr Colour StrideAtObject(const ObjectType& object,
                                                 const Tuple& worldPoint) const;
 
   // Underlying pattern type of PatternWrapper
@@ -623,10 +639,10 @@ class PointLight {
 class Material {
  public:
   Colour color{PredefinedColours::WHITE};
-  double ambient{0.1};
-  double diffuse{0.9};
-  double specular{0.9};
-  double shininess{200.0};
+  Real ambient{0.1};
+  Real diffuse{0.9};
+  Real specular{0.9};
+  Real shininess{200.0};
 
   const PatternWrapper* patternPtr{nullptr};
 
@@ -648,52 +664,119 @@ class Material {
   }
 };
 
+/*!
+ * \brief CRTP base of every shape.
+ *
+ * Besides the object-to-world `transform`, a shape caches the inverse transform
+ * (world-to-object, applied to every incoming ray). Normals are mapped back to
+ * world space through the transpose of its linear part. Both transforms are
+ * stored in 3x4 affine form and the inverse is computed once whenever the
+ * transform is set, so constexpr scenes fold it at compile time and run-time
+ * renders never invert a matrix per ray. Always go through `SetTransform` to
+ * keep them in sync.
+ */
 template <typename T>
 class Shape : public StaticBase<T, Shape> {
  public:
-  constexpr Shape()
-      : transform{PredefinedMatrices::I<double, 4>}, material{Material{}} {}
+  constexpr Shape() : material{Material{}} {
+    SetTransform(PredefinedMatrices::I<Real, 4>);
+  }
 
-  constexpr Shape(const Transform& transform_) : transform{transform_} {}
+  constexpr Shape(const Transform& transform_) { SetTransform(transform_); }
+
+  constexpr Shape(const TRS& transform_) { SetTransform(transform_); }
 
   constexpr Shape(
       const Material& material_,
-      const Transform& transform_ = PredefinedMatrices::I<double, 4>)
-      : material{material_}, transform{transform_} {}
+      const Transform& transform_ = PredefinedMatrices::I<Real, 4>)
+      : material{material_} {
+    SetTransform(transform_);
+  }
+
+  /*!
+   * \brief Append the hits of a world-space ray to `hits`, from near to far,
+   * each tagged with `index`.
+   */
+  template <std::size_t N>
+  constexpr void IntersectInto(const Ray& ray, std::uint32_t index,
+                               HitBuffer<N>& hits) const noexcept {
+    this->derived().LocalIntersectInto(ObjectRay(ray), index, hits);
+  }
+
+  /* Hits of this shape alone, sorted from near to far */
+  constexpr auto IntersectWith(const Ray& ray,
+                               const ShapeWrapper* ptrSelf) const noexcept {
+    HitBuffer<T::MaxHits> hits;
+    IntersectInto(ray, 0, hits);
+    StaticVector<Intersection, T::MaxHits> xs;
+    for (const Hit& hit : hits)
+      xs.push_back(Intersection(hit.t, ptrSelf));
+    return xs;
+  }
 
-  constexpr IntxnRetVariant LocalIntersection(
-      const Ray& ray, const ShapeWrapper* ptrSelf) const {
-    return this->derived().LocalIntersection(ray, ptrSelf);
+  /*!
+   * \brief Any-hit query, e.g for shadow rays: whether the shape is hit
+   * inside the [tMin, tMax] interval of the ray.
+   *
+   * Unlike `IntersectWith`, no `Intersection` is built and the derived
+   * `LocalOccludes` may return as soon as one root falls in the range.
+   */
+  constexpr bool Occludes(const Ray& ray) const noexcept {
+    return this->derived().LocalOccludes(ObjectRay(ray));
   }
 
-  constexpr IntxnRetVariant IntersectWith(
-      const Ray& ray, const ShapeWrapper* ptrSelf) const noexcept {
-    const auto invTransform = Inverse(transform);
-    const auto tranformedRay = ray.Transform(invTransform);
-    return LocalIntersection(tranformedRay, ptrSelf);
+  /* Same as above for hits at t in [EPSILON, tMax] */
+  constexpr bool Occludes(const Ray& ray, Real tMax) const noexcept {
+    return Occludes(
+        Ray{ray.GetOrigin(), ray.GetDirection(), Real(EPSILON), tMax});
   }
 
   constexpr ShapeType GetShapeType() const {
     return this->derived().GetShapeType();
   }
 
+  /* Object space bounds of the shape */
+  constexpr BoundingBox Bounds() const noexcept {
+    return this->derived().Bounds();
+  }
+
+  /* World space bounds, enclosing the transformed corners of `Bounds()` */
+  constexpr BoundingBox WorldBounds() const noexcept {
+    return Bounds().Transform(transform);
+  }
+
   constexpr void SetMaterial(const Material& material_) {
     material = material_;
   }
 
   constexpr Material GetMaterial() const { return material; }
 
-  constexpr Transform GetTransform() const { return transform; }
+  constexpr void SetTransform(const Transform& transform_) {
+    transform = AffineTransform(transform_);
+    invTransform = Inverse(transform);
+  }
+
+  /* Expands a TRS directly, its inverse needs no matrix inversion */
+  constexpr void SetTransform(const TRS& transform_) {
+    transform = transform_.ToAffine();
+    invTransform = transform_.InverseAffine();
+  }
+
+  constexpr Transform GetTransform() const { return transform.ToMatrix(); }
+
+  constexpr const AffineTransform& GetInverseTransform() const {
+    return invTransform;
+  }
 
   constexpr Tuple LocalNormalAt(const Tuple& point) const {
-    return this->derived().LocalNormalAt();
+    return this->derived().LocalNormalAt(point);
   }
 
   constexpr Tuple WorldNormalAt(const Tuple& worldPoint) const {
-    const auto objectPoint = Inverse(transform) * worldPoint;
-    const auto objectNormal = objectPoint - PredefinedTuples::ZeroPoint;
-    const auto worldNormal = Transpose(Inverse(transform)) * objectNormal;
-    return ToNormalizedVector(worldNormal);
+    const auto objectPoint = invTransform.TransformPoint(worldPoint);
+    const Tuple objectNormal = this->derived().LocalNormalAt(objectPoint);
+    const auto worldNormal = invTransform.TransposeTransformVector(objectNormal);
+    return worldNormal.Normalize();
   }
 
   constexpr friend bool operator==(const Shape& lhs, const Shape& rhs) {
@@ -702,7 +785,17 @@ class Shape : public StaticBase<T, Shape> {
     return lhs.derived() == rhs.derived();
   }
 
-  Transform transform{PredefinedMatrices::I<double, 4>};
+  /* Only an object space ray which is slab tested needs its inverse direction */
+  constexpr Ray ObjectRay(const Ray& ray) const noexcept {
+    if constexpr (T::SlabTested)
+      return ray.Transform(invTransform);
+    else
+      return ray.TransformToShape(invTransform);
+  }
+
+  AffineTransform transform{};
+  /// world-to-object transform, cached by `SetTransform`
+  AffineTransform invTransform{};
   Material material{Material{}};
 };
 
@@ -712,37 +805,70 @@ struct PlaneTrait {
   using return_type = StaticVector<Intersection, 1>;
   static constexpr std::size_t NumIntersections = 1;
   static constexpr std::size_t ReturnIndex = 0;
+  /// infinite bounds, kept outside of acceleration structures
+  static constexpr bool Bounded = false;
+  static constexpr bool SlabTested = false;
 };
 
 struct SphereTrait {
   using return_type = StaticVector<Intersection, 2>;
   static constexpr std::size_t NumIntersections = 2;
   static constexpr std::size_t ReturnIndex = 0;
+  static constexpr bool Bounded = true;
+  static constexpr bool SlabTested = false;
+};
+
+struct InstanceTrait {
+  using return_type = StaticVector<Intersection, 1>;
+  /// only the nearest hit inside the geometry is reported
+  static constexpr std::size_t NumIntersections = 1;
+  static constexpr std::size_t ReturnIndex = 0;
+  /// a geometry holding planes has infinite bounds, see `Instance::Bounds`
+  static constexpr bool Bounded = true;
+  /// the object space ray traverses the hierarchy of the geometry
+  static constexpr bool SlabTested = true;
 };
 
 }  // namespace ShapeTraits
 
 class Plane : public Shape<Plane> {
  public:
+  static constexpr std::size_t MaxHits =
+      ShapeTraits::PlaneTrait::NumIntersections;
+  static constexpr bool Bounded = ShapeTraits::PlaneTrait::Bounded;
+  static constexpr bool SlabTested = ShapeTraits::PlaneTrait::SlabTested;
+
   constexpr ShapeType GetShapeType() const { return PlaneTag; }
 
   constexpr Tuple LocalNormalAt(const Tuple& point) const {
     return MakeVector(0, 1, 0);
   }
 
-  constexpr IntxnRetVariant LocalIntersection(
-      const Ray& ray, const ShapeWrapper* ptrSelf) const noexcept {
-    const double yDirection = ray.GetDirection()[TupleConstants::y];
-    if (MathUtils::ConstExprAbsf(yDirection) < EPSILON)
-      return IntxnRetVariant(
-          StaticVector<Intersection, 1>{Intersection(-1, nullptr)});
-    else {
-      const double t = (-ray.GetOrigin()[TupleConstants::y]) / yDirection;
-      return IntxnRetVariant(
-          StaticVector<Intersection, 1>{Intersection(t, ptrSelf)});
+  /* The xz plane, unbounded along x and z */
+  constexpr BoundingBox Bounds() const noexcept {
+    constexpr Real inf = MathUtils::MathConstants::INF<Real>;
+    return BoundingBox{MakePoint(-inf, 0, -inf), MakePoint(inf, 0, inf)};
+  }
+
+  template <std::size_t N>
+  constexpr void LocalIntersectInto(const Ray& ray, std::uint32_t index,
+                                    HitBuffer<N>& hits) const noexcept {
+    const Real yDirection = ray.GetDirection()[TupleConstants::y];
+    // a ray parallel to the plane never hits it
+    if (MathUtils::ConstExprAbsf(yDirection) >= EPSILON) {
+      const Real t = (-ray.GetOrigin()[TupleConstants::y]) / yDirection;
+      if (ray.Contains(t))
+        hits.push_back(Hit{t, index});
     }
   }
 
+  constexpr bool LocalOccludes(const Ray& ray) const noexcept {
+    const Real yDirection = ray.GetDirection()[TupleConstants::y];
+    if (MathUtils::ConstExprAbsf(yDirection) < EPSILON)
+      return false;
+    return ray.Contains((-ray.GetOrigin()[TupleConstants::y]) / yDirection);
+  }
+
   template <typename OtherType>
   constexpr friend bool operator==(const Plane& lhs, const OtherType& rhs) {
     return lhs.GetShapeType() == rhs.GetShapeType() &&
@@ -753,28 +879,41 @@ class Plane : public Shape<Plane> {
 
 class Sphere : public Shape<Sphere> {
  public:
+  static constexpr std::size_t MaxHits =
+      ShapeTraits::SphereTrait::NumIntersections;
+  static constexpr bool Bounded = ShapeTraits::SphereTrait::Bounded;
+  static constexpr bool SlabTested = ShapeTraits::SphereTrait::SlabTested;
+
   constexpr ShapeType GetShapeType() const { return SphereTag; }
 
   constexpr Tuple LocalNormalAt(const Tuple& point) const {
     return ToNormalizedVector(point - PredefinedTuples::ZeroPoint);
   }
 
-  constexpr IntxnRetVariant LocalIntersection(
-      const Ray& ray, const ShapeWrapper* ptrSelf) const noexcept {
-    // Caculate distance between sphere to ray origin points assuming sphere's center located at world origin.
-    const auto sphereToRay = ray.GetOrigin() - PredefinedTuples::ZeroPoint;
-    const auto rayDir = ray.GetDirection();
-    const auto a = rayDir.DotProduct(rayDir);
-    const auto b = 2 * rayDir.DotProduct(sphereToRay);
-    const auto c = sphereToRay.DotProduct(sphereToRay) - 1;
+  /* The unit sphere centred at the origin */
+  constexpr BoundingBox Bounds() const noexcept {
+    return BoundingBox{MakePoint(-1, -1, -1), MakePoint(1, 1, 1)};
+  }
 
-    if (const auto& res = MathUtils::SolveQuadratic(a, b, c)) {
+  template <std::size_t N>
+  constexpr void LocalIntersectInto(const Ray& ray, std::uint32_t index,
+                                    HitBuffer<N>& hits) const noexcept {
+    if (const auto& res = SolveLocal(ray)) {
+      // roots are sorted, so hits are appended from near to far
       const auto& [r1, r2] = res.value();
-      return IntxnRetVariant(StaticVector<Intersection, 2>{
-          Intersection(r1, ptrSelf), Intersection(r2, ptrSelf)});
-    } else  // Currently a workaround for non-hitting, TODO: account for a more elegent solution in the future
-      return IntxnRetVariant(StaticVector<Intersection, 2>{
-          Intersection(-1, nullptr), Intersection(-1, nullptr)});
+      if (ray.Contains(r1))
+        hits.push_back(Hit{r1, index});
+      if (ray.Contains(r2))
+        hits.push_back(Hit{r2, index});
+    }
+  }
+
+  constexpr bool LocalOccludes(const Ray& ray) const noexcept {
+    if (const auto& res = SolveLocal(ray)) {
+      const auto& [r1, r2] = res.value();
+      return ray.Contains(r1) || ray.Contains(r2);
+    }
+    return false;
   }
 
   template <typename OtherType>
@@ -783,10 +922,126 @@ class Sphere : public Shape<Sphere> {
            lhs.GetTransform() == rhs.GetTransform() &&
            lhs.GetMaterial() == rhs.GetMaterial();
   }
+ private:
+  /* Roots of the ray/unit sphere quadratic, the sphere being centred at the
+   * object space origin */
+  static constexpr std::optional<std::pair<Real, Real>> SolveLocal(
+      const Ray& ray) noexcept {
+    const Tuple o = ray.GetOrigin();
+    const Tuple d = ray.GetDirection();
+    const Real a = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+    const Real b = 2 * (d[0] * o[0] + d[1] * o[1] + d[2] * o[2]);
+    const Real c = o[0] * o[0] + o[1] * o[1] + o[2] * o[2] - 1;
+    return MathUtils::SolveQuadratic(a, b, c);
+  }
+};
+
+/*!
+ * \brief Shapes shared by every `Instance` referencing them, in their own
+ * object space, along with a bottom-level acceleration structure over them.
+ *
+ * Kept abstract here so that shapes do not depend on the acceleration
+ * structures, which are built from `ShapeWrapper`s: see `BasicGeometry` in
+ * accel/instancing.hh. Rays are given in the object space of the geometry.
+ */
+class Geometry {
+ public:
+  constexpr virtual ~Geometry() = default;
+
+  /* Nearest hit inside the ray interval, `shapeIndex` being the shape hit */
+  constexpr virtual std::optional<Hit> ClosestHit(const Ray& ray) const = 0;
+
+  /* Whether any shape is hit inside the ray interval */
+  constexpr virtual bool Occluded(const Ray& ray) const = 0;
+
+  /* Bounds enclosing every shape, infinite if any shape is unbounded */
+  constexpr virtual BoundingBox Bounds() const = 0;
+
+  /* Normal of shape `index` at `point`, both in the object space of the
+   * geometry */
+  constexpr virtual Tuple NormalAt(std::uint32_t index,
+                                   const Tuple& point) const = 0;
+};
+
+/*!
+ * \brief A placement of a shared `Geometry`: a transform and a material, and
+ * a pointer to the geometry, which must outlive the instance.
+ *
+ * The material applies to every shape of the geometry. Instances are shapes
+ * like any other, so that the acceleration structure of a world holding them
+ * is the top level of a two-level hierarchy whose bottom levels are built
+ * once per geometry, however many times it is instanced.
+ */
+class Instance : public Shape<Instance> {
+ public:
+  static constexpr std::size_t MaxHits =
+      ShapeTraits::InstanceTrait::NumIntersections;
+  static constexpr bool Bounded = ShapeTraits::InstanceTrait::Bounded;
+  static constexpr bool SlabTested = ShapeTraits::InstanceTrait::SlabTested;
+
+  constexpr Instance(
+      const Geometry& geometry_,
+      const Transform& transform_ = PredefinedMatrices::I<Real, 4>,
+      const Material& material_ = Material{})
+      : Shape<Instance>(material_, transform_), geometry{&geometry_} {}
+
+  constexpr Instance(const Geometry& geometry_, const TRS& transform_,
+                     const Material& material_ = Material{})
+      : Shape<Instance>(transform_), geometry{&geometry_} {
+    SetMaterial(material_);
+  }
+
+  constexpr ShapeType GetShapeType() const { return InstanceTag; }
+
+  constexpr const Geometry& GetGeometry() const { return *geometry; }
+
+  constexpr BoundingBox Bounds() const noexcept { return geometry->Bounds(); }
+
+  template <std::size_t N>
+  constexpr void LocalIntersectInto(const Ray& ray, std::uint32_t index,
+                                    HitBuffer<N>& hits) const noexcept {
+    // the object space ray keeps the direction unnormalized, t is unchanged
+    if (const std::optional<Hit> hit = geometry->ClosestHit(ray))
+      hits.push_back(Hit{hit->t, index, hit->shapeIndex});
+  }
+
+  constexpr bool LocalOccludes(const Ray& ray) const noexcept {
+    return geometry->Occluded(ray);
+  }
+
+  /* World normal at a point of shape `primIndex` of the geometry */
+  constexpr Tuple WorldNormalAt(const Tuple& worldPoint,
+                                std::uint32_t primIndex) const {
+    const Tuple objectPoint = invTransform.TransformPoint(worldPoint);
+    const Tuple objectNormal = geometry->NormalAt(primIndex, objectPoint);
+    return invTransform.TransposeTransformVector(objectNormal).Normalize();
+  }
+
+  template <typename OtherType>
+  constexpr friend bool operator==(const Instance& lhs, const OtherType& rhs) {
+    if constexpr (std::is_same_v<OtherType, Instance>) {
+      return lhs.geometry == rhs.geometry &&
+             lhs.GetTransform() == rhs.GetTransform() &&
+             lhs.GetMaterial() == rhs.GetMaterial();
+    } else if constexpr (requires { rhs.shapeObject; }) {
+      // a `ShapeWrapper`
+      const auto* other = std::get_if<Instance>(&rhs.shapeObject);
+      return other != nullptr && lhs == *other;
+    } else {
+      return false;
+    }
+  }
+
+ private:
+  const Geometry* geometry;
 };
 
 class ShapeWrapper {
  public:
+  /* Most hits any wrapped shape appends for one ray */
+  static constexpr std::size_t MaxHits =
+      std::max({Sphere::MaxHits, Plane::MaxHits, Instance::MaxHits});
+
   template <typename T>
   constexpr ShapeWrapper(T&& elem) : shapeObject{std::forward<T>(elem)} {}
 
@@ -813,34 +1068,79 @@ class ShapeWrapper {
         shapeObject);
   }
 
-  constexpr Tuple GetWorldNormalAt(const Tuple& worldPoint) const {
+  constexpr const AffineTransform& GetInverseTransform() const {
     return std::visit(
-        [&](auto const& elem) -> decltype(auto) {
-          return elem.WorldNormalAt(worldPoint);
+        [&](auto const& elem) -> const AffineTransform& {
+          return elem.GetInverseTransform();
+        },
+        shapeObject);
+  }
+
+  template <typename TransformType>
+  constexpr void SetTransform(const TransformType& transform) {
+    std::visit([&](auto& elem) { elem.SetTransform(transform); },
+               shapeObject);
+  }
+
+  /* `primIndex` picks the shape hit inside the geometry of an `Instance` */
+  constexpr Tuple GetWorldNormalAt(const Tuple& worldPoint,
+                                   std::uint32_t primIndex = 0) const {
+    return std::visit(
+        [&](auto const& elem) -> Tuple {
+          if constexpr (std::is_same_v<std::decay_t<decltype(elem)>, Instance>)
+            return elem.WorldNormalAt(worldPoint, primIndex);
+          else
+            return elem.WorldNormalAt(worldPoint);
         },
         shapeObject);
   }
 
-  constexpr IntxnRetVariant IntersectWith(const Ray& ray) const {
+  /* Whether the shape has finite bounds, see `ShapeTraits` */
+  constexpr bool IsBounded() const {
+    return std::visit([&](auto const& elem) { return elem.Bounded; },
+                      shapeObject);
+  }
+
+  constexpr BoundingBox Bounds() const {
     return std::visit(
-        [&](auto const& elem) { return elem.IntersectWith(ray, this); },
+        [&](auto const& elem) -> BoundingBox { return elem.Bounds(); },
         shapeObject);
   }
 
-  std::variant<Sphere, Plane> shapeObject;
+  constexpr BoundingBox WorldBounds() const {
+    return std::visit(
+        [&](auto const& elem) -> BoundingBox { return elem.WorldBounds(); },
+        shapeObject);
+  }
+
+  template <std::size_t N>
+  constexpr void IntersectInto(const Ray& ray, std::uint32_t index,
+                               HitBuffer<N>& hits) const {
+    std::visit([&](auto const& elem) { elem.IntersectInto(ray, index, hits); },
+               shapeObject);
+  }
+
+  constexpr bool Occludes(const Ray& ray) const {
+    return std::visit([&](auto const& elem) { return elem.Occludes(ray); },
+                      shapeObject);
+  }
+
+  std::variant<Sphere, Plane, Instance> shapeObject;
 };
 
 template <typename T>
-constexpr Colour Pattern<T>::StrideAtObject(const ShapeWrapper& object,
+template <typename ObjectType>
+constexpr Colour Pattern<T>::StrideAtObject(const ObjectType& object,
                                             const Tuple& worldPoint) const {
-  const auto invObjectTrans = Inverse(object.GetTransform());
-  const auto invPatternTrans = Inverse(this->GetTransform());
-  const Tuple objectPoint = invObjectTrans * worldPoint;
-  const Tuple patternPoint = invPatternTrans * objectPoint;
+  const Tuple objectPoint =
+      object.GetInverseTransform().TransformPoint(worldPoint);
+  const Tuple patternPoint =
+      this->GetInverseTransform().TransformPoint(objectPoint);
   return this->StrideAt(patternPoint);
 }
 
-constexpr Colour PatternWrapper::StrideAtObject(const ShapeWrapper& object,
+template <typename ObjectType>
+constexpr Colour PatternWrapper::StrideAtObject(const ObjectType& object,
                                                 const Tuple& worldPoint) const {
   return std::visit(
       [&](auto const& elem) -> decltype(auto) {
@@ -853,13 +1153,21 @@ constexpr ShapeType Intersection::GetShapeType() const {
   return shapePtr->GetShapeType();
 }
 
-constexpr HitRecord Intersection::PrepareComputation(const Ray& ray) const {
+/*!
+ * \brief Shading values of a hit at distance `t` along `ray`, where
+ * `normalAt(point)` returns the world normal of the hit shape at a world point.
+ *
+ * Leaves `shapePtr` unset, for worlds that shade concrete shapes rather than
+ * `ShapeWrapper`s.
+ */
+template <typename NormalFunc>
+constexpr HitRecord PrepareHitRecord(Real t, const Ray& ray,
+                                     NormalFunc&& normalAt) {
   HitRecord returnRec{};
   returnRec.t = t;
-  returnRec.shapePtr = shapePtr;
-  returnRec.point = ray.PositionAlong(GetIntersectDistance());
+  returnRec.point = ray.PositionAlong(t);
   returnRec.eyeV = -ray.GetDirection();
-  const auto normalV = shapePtr->GetWorldNormalAt(returnRec.point);
+  const auto normalV = normalAt(returnRec.point);
   returnRec.inside = returnRec.normalV.DotProduct(returnRec.eyeV) < 0;
   // The normal is inverted when the hit occurs inside the object
   returnRec.normalV = returnRec.inside ? -normalV : normalV;
@@ -867,8 +1175,19 @@ constexpr HitRecord Intersection::PrepareComputation(const Ray& ray) const {
   return returnRec;
 }
 
+constexpr HitRecord Intersection::PrepareComputation(const Ray& ray) const {
+  HitRecord returnRec =
+      PrepareHitRecord(GetIntersectDistance(), ray, [&](const Tuple& point) {
+        return shapePtr->GetWorldNormalAt(point, primIndex);
+      });
+  returnRec.shapePtr = shapePtr;
+  return returnRec;
+}
+
+/* `object` is a `ShapeWrapper` or a concrete shape, for its pattern */
+template <typename ObjectType>
 [[nodiscard]] constexpr Colour Lighting(const Material& material,
-                                        const ShapeWrapper& object,
+                                        const ObjectType& object,
                                         const PointLight& light,
                                         const Tuple& point, const Tuple& eye,
                                         const Tuple& normal,
@@ -895,11 +1214,11 @@ constexpr HitRecord Intersection::PrepareComputation(const Ray& ray) const {
   // light_dot_normal represent the cosine of the angle between the
   // light vector and the normal vector.
   // A negative number means the light is on the other side of the surface
-  const double lightDotNormal = lightDirection.DotProduct(normal);
+  const Real lightDotNormal = lightDirection.DotProduct(normal);
 
   // precompute for ambient contribution
   const auto reflectv = -lightDirection.Reflect(normal);
-  const double reflectDotEye = reflectv.DotProduct(eye);
+  const Real reflectDotEye = reflectv.DotProduct(eye);
 
   // compute the diffuse contribution
   const auto diffuse =
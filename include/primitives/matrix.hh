@@ -1,10 +1,13 @@
 #ifndef MAT_HH
 #define MAT_HH
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <optional>
 #include <primitive_traits.hh>
 #include <primitives/vec.hh>
 #include <type_traits>
+#include <utils/checks.hh>
 #include <utils/math.hh>
 namespace RayTracer {
 
@@ -16,15 +19,19 @@ class Matrix {
   static constexpr std::size_t Cols = C;
   using ValueType = T;
   constexpr Vec<T, Cols> Row(std::size_t rowIndex) const {
-    if (rowIndex >= Rows)
-      throw "index out of range";
+    if constexpr (Checks::Enabled) {
+      if (rowIndex >= Rows)
+        throw "index out of range";
+    }
     return VecUtils::Generate<Cols>(
         [rowIndex, this](std::size_t j) { return contents[rowIndex][j]; });
   }
 
   constexpr Vec<T, Rows> Column(std::size_t colIndex) const {
-    if (colIndex >= Cols)
-      throw "index out of range";
+    if constexpr (Checks::Enabled) {
+      if (colIndex >= Cols)
+        throw "index out of range";
+    }
     return VecUtils::Generate<Rows>(
         [colIndex, this](std::size_t j) { return contents[j][colIndex]; });
   }
@@ -92,9 +99,10 @@ constexpr Matrix<T, R, C> ElementWise(Func func, const Matrix<T, R, C>& mat,
 }
 }  // namespace MatrixUtils
 
-template <typename T, std::size_t R, std::size_t C>
+/* Approximate comparison, element types may differ (e.g float vs double) */
+template <typename T, typename U, std::size_t R, std::size_t C>
 constexpr bool operator==(const Matrix<T, R, C>& matA,
-                          const Matrix<T, R, C>& matB) noexcept {
+                          const Matrix<U, R, C>& matB) noexcept {
   for (std::size_t i = 0; i < R; ++i) {
     for (std::size_t j = 0; j < C; ++j) {
       if (!MathUtils::ApproxEqual(matA[i][j], matB[i][j]))
@@ -104,103 +112,296 @@ constexpr bool operator==(const Matrix<T, R, C>& matA,
   return true;
 }
 
-template <typename T, std::size_t R, std::size_t C>
+template <typename T, typename U, std::size_t R, std::size_t C>
 constexpr bool operator!=(const Matrix<T, R, C>& matA,
-                          const Matrix<T, R, C>& matB) noexcept {
+                          const Matrix<U, R, C>& matB) noexcept {
   return !(matA == matB);
 }
 
-/** Numerical negative, element-wise. */
+/*
+  Element-wise arithmetic is lazy in the same way as for `Vec` (see the
+  expression templates of vec.hh): it builds a `MatrixUtils::Expr` node that
+  is evaluated in one fused pass once converted to a `Matrix`. Matrix
+  products are not element-wise and stay eager, a lazy operand of a product
+  is evaluated first.
+*/
+namespace MatrixUtils {
+
+namespace Detail {
 template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C> operator-(const Matrix<T, R, C>& mat) noexcept {
-  return MatrixUtils::ElementWise([](T x) { return -1.0 * x; }, mat);
+constexpr Matrix<T, R, C> AsMatrix(const Matrix<T, R, C>&) noexcept;
+}  // namespace Detail
+
+/* Lazy expression node */
+template <typename E>
+concept LazyMatrix = PrimitiveTraits::RemoveCVR<E>::IsMatrixExpr;
+
+/* Matrices, classes derived from them (e.g `Transform`) and lazy nodes */
+template <typename E>
+concept MatrixExpression = LazyMatrix<E> || requires(const E& mat) {
+  Detail::AsMatrix(mat);
+};
+
+/* How an operand is stored in a node: derived matrices are sliced */
+template <typename E, bool = !LazyMatrix<E> && MatrixExpression<E>>
+struct StoredOf {
+  using type = E;
+};
+
+template <typename E>
+struct StoredOf<E, true> {
+  using type = decltype(Detail::AsMatrix(std::declval<const E&>()));
+};
+
+template <typename E>
+using Stored = typename StoredOf<E>::type;
+
+template <typename A, typename B>
+concept SameShape =
+    std::is_same_v<typename Stored<A>::ValueType,
+                   typename Stored<B>::ValueType> &&
+    Stored<A>::Rows == Stored<B>::Rows && Stored<A>::Cols == Stored<B>::Cols;
+
+/* Reads element (row, col) of a matrix, lazy node or broadcast scalar */
+template <typename E>
+constexpr auto At(const E& operand, std::size_t row, std::size_t col) {
+  if constexpr (LazyMatrix<E>)
+    return operand.At(row, col);
+  else if constexpr (MatrixExpression<E>)
+    return operand[row][col];
+  else
+    return operand.value;
+}
+
+/* The matrix itself, or the evaluated result of a lazy expression */
+template <MatrixExpression E>
+constexpr decltype(auto) Evaluate(const E& expr) noexcept {
+  if constexpr (LazyMatrix<E>)
+    return expr.Eval();
+  else
+    return (expr);
+}
+
+template <typename L, typename R>
+using MatrixOperandOf = Stored<std::conditional_t<MatrixExpression<L>, L, R>>;
+
+/* Shared read-only Matrix interface of the expression nodes */
+template <typename Derived, typename T, std::size_t R, std::size_t C>
+class ExprBase {
+ public:
+  static constexpr bool IsMatrixExpr = true;
+  using ValueType = T;
+  static constexpr std::size_t Rows = R;
+  static constexpr std::size_t Cols = C;
+  using ResultType = Matrix<T, R, C>;
+
+  /* Read-only view of a row, so that `expr[i][j]` reads like a Matrix */
+  class RowView {
+   public:
+    constexpr T operator[](std::size_t colIndex) const {
+      return expr.At(rowIndex, colIndex);
+    }
+
+    const Derived& expr;
+    std::size_t rowIndex;
+  };
+
+  constexpr RowView operator[](std::size_t rowIndex) const noexcept {
+    return RowView{Self(), rowIndex};
+  }
+
+  constexpr operator ResultType() const noexcept { return Self().Eval(); }
+
+  constexpr Vec<T, C> Row(std::size_t rowIndex) const {
+    return Self().Eval().Row(rowIndex);
+  }
+
+  constexpr Vec<T, R> Column(std::size_t colIndex) const {
+    return Self().Eval().Column(colIndex);
+  }
+
+  /* One pass over the elements of the whole expression tree */
+  constexpr ResultType Eval() const noexcept {
+    ResultType ret{};
+    for (std::size_t i = 0; i < R; ++i)
+      for (std::size_t j = 0; j < C; ++j)
+        ret[i][j] = Self().At(i, j);
+    return ret;
+  }
+
+  friend std::ostream& operator<<(std::ostream& stream,
+                                  const ExprBase& expr) noexcept {
+    return stream << expr.Eval();
+  }
+
+ private:
+  constexpr const Derived& Self() const noexcept {
+    return static_cast<const Derived&>(*this);
+  }
+};
+
+/* Lazy `lhs Op rhs`, one of the operands may be a Broadcast scalar */
+template <typename Op, typename L, typename R>
+class Expr : public ExprBase<Expr<Op, L, R>,
+                             typename MatrixOperandOf<L, R>::ValueType,
+                             MatrixOperandOf<L, R>::Rows,
+                             MatrixOperandOf<L, R>::Cols> {
+ public:
+  using ValueType = typename MatrixOperandOf<L, R>::ValueType;
+
+  constexpr Expr(const L& lhs_, const R& rhs_) noexcept
+      : lhs{lhs_}, rhs{rhs_} {}
+
+  constexpr ValueType At(std::size_t row, std::size_t col) const {
+    return Op::Apply(MatrixUtils::At(lhs, row, col),
+                     MatrixUtils::At(rhs, row, col));
+  }
+
+ private:
+  Stored<L> lhs;
+  Stored<R> rhs;
+};
+
+/* Lazy `Op operand` */
+template <typename Op, typename E>
+class UnaryExpr
+    : public ExprBase<UnaryExpr<Op, E>, typename Stored<E>::ValueType,
+                      Stored<E>::Rows, Stored<E>::Cols> {
+ public:
+  using ValueType = typename Stored<E>::ValueType;
+
+  constexpr explicit UnaryExpr(const E& operand_) noexcept
+      : operand{operand_} {}
+
+  constexpr ValueType At(std::size_t row, std::size_t col) const {
+    return Op::Apply(MatrixUtils::At(operand, row, col));
+  }
+
+ private:
+  Stored<E> operand;
+};
+
+template <typename E>
+using ValueOf = typename Stored<E>::ValueType;
+
+template <typename E>
+using Scalar = VecUtils::Broadcast<ValueOf<E>>;
+
+}  // namespace MatrixUtils
+
+/* Equality against a lazy expression compares its evaluated result */
+template <MatrixUtils::MatrixExpression A, MatrixUtils::MatrixExpression B>
+requires(MatrixUtils::LazyMatrix<A> || MatrixUtils::LazyMatrix<B>) &&
+    MatrixUtils::SameShape<A, B> constexpr bool operator==(
+        const A& exprA, const B& exprB) noexcept {
+  return MatrixUtils::Evaluate(exprA) == MatrixUtils::Evaluate(exprB);
+}
+
+template <MatrixUtils::MatrixExpression A, MatrixUtils::MatrixExpression B>
+requires(MatrixUtils::LazyMatrix<A> || MatrixUtils::LazyMatrix<B>) &&
+    MatrixUtils::SameShape<A, B> constexpr bool operator!=(
+        const A& exprA, const B& exprB) noexcept {
+  return !(exprA == exprB);
+}
+
+/** Numerical negative, element-wise. */
+template <MatrixUtils::MatrixExpression E>
+constexpr auto operator-(const E& mat) noexcept {
+  return MatrixUtils::UnaryExpr<VecUtils::Negate, E>{mat};
 }
 
 /* Element-wise add */
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C> operator+(const Matrix<T, R, C>& mat,
-                                    T scalar) noexcept {
-  return MatrixUtils::ElementWise([scalar](T x) { return x + scalar; }, mat);
+template <MatrixUtils::MatrixExpression E>
+constexpr auto operator+(const E& mat,
+                         MatrixUtils::ValueOf<E> scalar) noexcept {
+  using Scalar = MatrixUtils::Scalar<E>;
+  return MatrixUtils::Expr<VecUtils::Plus, E, Scalar>{mat, Scalar{scalar}};
 }
 
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C> operator+(T scalar,
-                                    const Matrix<T, R, C>& mat) noexcept {
-  return MatrixUtils::ElementWise([scalar](T x) { return x + scalar; }, mat);
+template <MatrixUtils::MatrixExpression E>
+constexpr auto operator+(MatrixUtils::ValueOf<E> scalar,
+                         const E& mat) noexcept {
+  using Scalar = MatrixUtils::Scalar<E>;
+  return MatrixUtils::Expr<VecUtils::Plus, Scalar, E>{Scalar{scalar}, mat};
 }
 
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C> operator+(const Matrix<T, R, C>& matA,
-                                    const Matrix<T, R, C>& matB) noexcept {
-  return MatrixUtils::ElementWise(std::plus<T>(), matA, matB);
+template <MatrixUtils::MatrixExpression A, MatrixUtils::MatrixExpression B>
+requires MatrixUtils::SameShape<A, B> constexpr auto operator+(
+    const A& matA, const B& matB) noexcept {
+  return MatrixUtils::Expr<VecUtils::Plus, A, B>{matA, matB};
 }
 
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C>& operator+=(Matrix<T, R, C>& mat, T scalar) noexcept {
-  for (std::size_t row = 0; row < R; row++) {
-    for (std::size_t col = 0; col < C; col++) {
-      mat[row][col] += scalar;
-    }
-  }
-  return mat;
+/* Element-wise subtraction */
+template <MatrixUtils::MatrixExpression E>
+constexpr auto operator-(const E& mat,
+                         MatrixUtils::ValueOf<E> scalar) noexcept {
+  using Scalar = MatrixUtils::Scalar<E>;
+  return MatrixUtils::Expr<VecUtils::Minus, E, Scalar>{mat, Scalar{scalar}};
 }
 
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C>& operator+=(Matrix<T, R, C>& matA,
-                                      const Matrix<T, R, C>& matB) noexcept {
-  for (std::size_t row = 0; row < R; row++) {
-    for (std::size_t col = 0; col < C; col++) {
-      matA[row][col] += matB[row][col];
-    }
-  }
-  return matA;
+template <MatrixUtils::MatrixExpression A, MatrixUtils::MatrixExpression B>
+requires MatrixUtils::SameShape<A, B> constexpr auto operator-(
+    const A& matA, const B& matB) noexcept {
+  return MatrixUtils::Expr<VecUtils::Minus, A, B>{matA, matB};
 }
 
-/* Element-wise negation */
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C> operator-(const Matrix<T, R, C>& mat,
-                                    T scalar) noexcept {
-  return MatrixUtils::ElementWise([scalar](T x) { return x - scalar; }, mat);
+/* Element-wise mulplication */
+template <MatrixUtils::MatrixExpression E>
+constexpr auto operator*(const E& mat,
+                         MatrixUtils::ValueOf<E> scalar) noexcept {
+  using Scalar = MatrixUtils::Scalar<E>;
+  return MatrixUtils::Expr<VecUtils::Multiplies, E, Scalar>{mat,
+                                                            Scalar{scalar}};
 }
 
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C> operator-(const Matrix<T, R, C>& matA,
-                                    const Matrix<T, R, C>& matB) noexcept {
-  return MatrixUtils::ElementWise(std::minus<T>(), matA, matB);
+template <MatrixUtils::MatrixExpression E>
+constexpr auto operator*(MatrixUtils::ValueOf<E> scalar,
+                         const E& mat) noexcept {
+  using Scalar = MatrixUtils::Scalar<E>;
+  return MatrixUtils::Expr<VecUtils::Multiplies, Scalar, E>{Scalar{scalar},
+                                                            mat};
 }
 
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C>& operator-=(Matrix<T, R, C>& mat, T scalar) noexcept {
-  for (std::size_t row = 0; row < R; row++) {
-    for (std::size_t col = 0; col < C; col++) {
-      mat[row][col] -= scalar;
-    }
-  }
-  return mat;
+/* Element-wise division */
+template <MatrixUtils::MatrixExpression E>
+constexpr auto operator/(const E& mat,
+                         MatrixUtils::ValueOf<E> scalar) noexcept {
+  using Scalar = MatrixUtils::Scalar<E>;
+  return MatrixUtils::Expr<VecUtils::Divides, E, Scalar>{mat, Scalar{scalar}};
 }
 
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C>& operator-=(Matrix<T, R, C>& matA,
-                                      const Matrix<T, R, C>& matB) noexcept {
-  for (std::size_t row = 0; row < R; row++) {
-    for (std::size_t col = 0; col < C; col++) {
-      matA[row][col] -= matB[row][col];
-    }
-  }
-  return matA;
+template <MatrixUtils::MatrixExpression A, MatrixUtils::MatrixExpression B>
+requires MatrixUtils::SameShape<A, B> constexpr auto operator/(
+    const A& matA, const B& matB) noexcept {
+  return MatrixUtils::Expr<VecUtils::Divides, A, B>{matA, matB};
 }
 
-/* Element-wise mulplication */
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C> operator*(const Matrix<T, R, C>& mat,
-                                    T scalar) noexcept {
-  return MatrixUtils::ElementWise([scalar](T x) { return scalar * x; }, mat);
+/* Compound assignment evaluates the expression straight into the matrix */
+template <typename T, std::size_t R, std::size_t C, typename E>
+requires MatrixUtils::MatrixExpression<E> || std::convertible_to<E, T>
+constexpr Matrix<T, R, C>& operator+=(Matrix<T, R, C>& mat,
+                                      const E& rhs) noexcept {
+  return mat = mat + rhs;
+}
+
+template <typename T, std::size_t R, std::size_t C, typename E>
+requires MatrixUtils::MatrixExpression<E> || std::convertible_to<E, T>
+constexpr Matrix<T, R, C>& operator-=(Matrix<T, R, C>& mat,
+                                      const E& rhs) noexcept {
+  return mat = mat - rhs;
+}
+
+template <typename T, std::size_t R, std::size_t C, typename E>
+requires MatrixUtils::MatrixExpression<E> || std::convertible_to<E, T>
+constexpr Matrix<T, R, C>& operator/=(Matrix<T, R, C>& mat,
+                                      const E& rhs) noexcept {
+  return mat = mat / rhs;
 }
 
 template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C> operator*(T scalar,
-                                    const Matrix<T, R, C>& mat) noexcept {
-  return MatrixUtils::ElementWise([scalar](T x) { return scalar * x; }, mat);
+constexpr Matrix<T, R, C>& operator*=(Matrix<T, R, C>& mat,
+                                      std::type_identity_t<T> scalar) noexcept {
+  return mat = mat * scalar;
 }
 
 template <typename T, std::size_t R1, std::size_t C, std::size_t C2>
@@ -214,6 +415,13 @@ constexpr Matrix<T, R1, C2> operator*(const Matrix<T, R1, C>& matA,
   return ret;
 }
 
+/* Products with a lazy operand evaluate it first */
+template <MatrixUtils::MatrixExpression A, MatrixUtils::MatrixExpression B>
+requires(MatrixUtils::LazyMatrix<A> || MatrixUtils::LazyMatrix<B>)
+constexpr auto operator*(const A& matA, const B& matB) noexcept {
+  return MatrixUtils::Evaluate(matA) * MatrixUtils::Evaluate(matB);
+}
+
 // mat * mat only support square matrices
 template <typename T, std::size_t D>
 constexpr Matrix<T, D, D>& operator*=(Matrix<T, D, D>& matA,
@@ -241,58 +449,10 @@ constexpr Vec<T, C> operator*(const Matrix<T, R, C>& mat,
   return ret;
 }
 
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C>& operator*=(Matrix<T, R, C>& mat, T scalar) noexcept {
-  for (std::size_t row = 0u; row < R; row++) {
-    for (std::size_t col = 0u; col < C; col++) {
-      mat[row][col] *= scalar;
-    }
-  }
-  return mat;
-}
-
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C>& operator*=(T scalar, Matrix<T, R, C>& mat) noexcept {
-  for (std::size_t row = 0u; row < R; row++) {
-    for (std::size_t col = 0u; col < C; col++) {
-      mat[row][col] *= scalar;
-    }
-  }
-  return mat;
-}
-
-/* Element-wise division */
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C> operator/(const Matrix<T, R, C>& mat,
-                                    T scalar) noexcept {
-  return MatrixUtils::ElementWise([scalar](T x) { return x / scalar; }, mat);
-}
-
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C>& operator/=(Matrix<T, R, C>& mat, T scalar) noexcept {
-  for (std::size_t row = 0u; row < R; row++) {
-    for (std::size_t col = 0u; col < C; col++) {
-      mat[row][col] /= scalar;
-    }
-  }
-  return mat;
-}
-
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C> operator/(const Matrix<T, R, C>& matA,
-                                    const Matrix<T, R, C>& matB) noexcept {
-  return MatrixUtils::ElementWise(std::divides<T>(), matA, matB);
-}
-
-template <typename T, std::size_t R, std::size_t C>
-constexpr Matrix<T, R, C>& operator/=(Matrix<T, R, C>& matA,
-                                      const Matrix<T, R, C>& matB) noexcept {
-  for (std::size_t row = 0u; row < R; row++) {
-    for (std::size_t col = 0u; col < C; col++) {
-      matA[row][col] /= matB[row][col];
-    }
-  }
-  return matA;
+template <MatrixUtils::MatrixExpression M, VecUtils::VecExpression V>
+requires(MatrixUtils::LazyMatrix<M> || VecUtils::LazyVec<V>)
+constexpr auto operator*(const M& mat, const V& vec) noexcept {
+  return MatrixUtils::Evaluate(mat) * VecUtils::Evaluate(vec);
 }
 
 /************************
@@ -366,23 +526,166 @@ constexpr T Determinant(const Matrix<T, N, N>& mat) {
   return result;
 }
 
-template <typename T, std::size_t N>
-constexpr bool Invertible(const Matrix<T, N, N>& mat) {
-  return !MathUtils::ApproxEqual(Determinant(mat), 0.0);
+/*!
+ * \brief Whether `det`, the determinant of the upper left N x N block of
+ * `mat`, is zero within EPSILON once divided by the largest entry of each
+ * row, so that a uniformly small matrix (e.g a tiny sphere) still inverts.
+ *
+ * A block whose last row is (0, ..., 0, 1), e.g an affine transform, has the
+ * determinant of its upper left (N - 1) x (N - 1) block and is scaled by that
+ * block alone: the translation column says nothing about singularity.
+ */
+template <std::size_t N, typename M, typename T>
+constexpr bool NearlySingular(const M& mat, T det) {
+  if constexpr (N > 1) {
+    bool affine = mat[N - 1][N - 1] == T{1};
+    for (std::size_t col = 0u; col + 1 < N; col++)
+      affine = affine && mat[N - 1][col] == T{};
+    if (affine)
+      return NearlySingular<N - 1>(mat, det);
+  }
+  T scale{1};
+  for (std::size_t row = 0u; row < N; row++) {
+    T largest{};
+    for (std::size_t col = 0u; col < N; col++)
+      largest = std::max(largest, MathUtils::ConstExprAbsf(mat[row][col]));
+    // a null row is singular whatever the other rows
+    if (largest == T{})
+      return true;
+    scale *= largest;
+  }
+  return MathUtils::ApproxEqual(det / scale, T{});
 }
 
 template <typename T, std::size_t N>
-constexpr Matrix<T, N, N> Inverse(const Matrix<T, N, N>& mat) {
-  assert(Invertible(mat));
-  Matrix<T, N, N> result{};
-  for (int row = 0; row < N; row++) {
-    for (int col = 0; col < N; col++) {
-      result[col][row] = Cofactor(mat, row, col) / Determinant(mat);
+constexpr bool Invertible(const Matrix<T, N, N>& mat) {
+  return !NearlySingular<N>(mat, Determinant(mat));
+}
+
+/*!
+ * \brief Invert a square matrix by Gauss-Jordan elimination with partial pivoting.
+ *
+ * Runs in O(N^3) without instantiating any `SubMatrix`/`Determinant` recursion,
+ * which keeps both run-time cost and constexpr evaluation steps low.
+ *
+ * \return The inverse matrix, or nullopt if `mat` is singular (within the
+ *         tolerance of `Invertible`).
+ */
+template <typename T, std::size_t N>
+constexpr std::optional<Matrix<T, N, N>> TryInverse(
+    const Matrix<T, N, N>& mat) {
+  Matrix<T, N, N> lhs = mat;
+  Matrix<T, N, N> result = DiagonalMatrix<T, N>(T{1});
+  T det{1};
+  for (std::size_t col = 0u; col < N; col++) {
+    // pick the row with the largest magnitude in this column as pivot
+    std::size_t pivot = col;
+    for (std::size_t row = col + 1; row < N; row++) {
+      if (MathUtils::ConstExprAbsf(lhs[row][col]) >
+          MathUtils::ConstExprAbsf(lhs[pivot][col]))
+        pivot = row;
+    }
+    if (lhs[pivot][col] == T{})
+      return std::nullopt;
+    // the determinant is the signed product of the pivots
+    det *= pivot != col ? -lhs[pivot][col] : lhs[pivot][col];
+    if (pivot != col) {
+      for (std::size_t j = 0u; j < N; j++) {
+        std::swap(lhs[pivot][j], lhs[col][j]);
+        std::swap(result[pivot][j], result[col][j]);
+      }
+    }
+    const T invPivot = T{1} / lhs[col][col];
+    for (std::size_t j = 0u; j < N; j++) {
+      lhs[col][j] *= invPivot;
+      result[col][j] *= invPivot;
+    }
+    // eliminate this column from every other row
+    for (std::size_t row = 0u; row < N; row++) {
+      if (row == col)
+        continue;
+      const T factor = lhs[row][col];
+      if (factor == T{})
+        continue;
+      for (std::size_t j = 0u; j < N; j++) {
+        lhs[row][j] -= factor * lhs[col][j];
+        result[row][j] -= factor * result[col][j];
+      }
     }
   }
+  // same tolerance as `Invertible`
+  if (NearlySingular<N>(mat, det))
+    return std::nullopt;
   return result;
 }
 
+/*!
+ * \brief Closed-form inverse of 4x4 matrices (e.g `TransformMatrix`).
+ *
+ * Expands the determinant and the adjugate through the twelve 2x2
+ * sub-determinants of the upper and lower row pairs, so the whole inversion
+ * costs a single reciprocal and a few dozen multiplies.
+ *
+ * \return The inverse matrix, or nullopt if `mat` is singular (within the
+ *         tolerance of `Invertible`).
+ */
+template <typename T>
+constexpr std::optional<Matrix<T, 4, 4>> TryInverse(
+    const Matrix<T, 4, 4>& mat) {
+  const auto& m = mat.contents;
+  // 2x2 sub-determinants of the two upper rows
+  const T s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+  const T s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+  const T s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+  const T s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+  const T s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+  const T s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+  // 2x2 sub-determinants of the two lower rows
+  const T c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+  const T c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+  const T c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+  const T c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+  const T c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+  const T c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+  const T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  // same tolerance as `Invertible`
+  if (NearlySingular<4>(mat, det))
+    return std::nullopt;
+  const T invDet = T{1} / det;
+
+  // clang-format off
+  return Matrix<T, 4, 4>{
+    ( m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * invDet,
+    (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * invDet,
+    ( m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * invDet,
+    (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * invDet,
+
+    (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * invDet,
+    ( m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * invDet,
+    (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * invDet,
+    ( m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * invDet,
+
+    ( m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * invDet,
+    (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * invDet,
+    ( m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * invDet,
+    (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * invDet,
+
+    (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * invDet,
+    ( m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * invDet,
+    (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * invDet,
+    ( m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * invDet};
+  // clang-format on
+}
+
+/* Inverse of a matrix that is known to be invertible (see `TryInverse`). */
+template <typename T, std::size_t N>
+constexpr Matrix<T, N, N> Inverse(const Matrix<T, N, N>& mat) {
+  const auto result = TryInverse(mat);
+  assert(result.has_value());
+  return result.value();
+}
+
 /************************
 * Matrix Constants      *
 *************************/
@@ -0,0 +1,1402 @@
+#ifndef SIMD_HH
+#define SIMD_HH
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * SIMD kernels backing the run-time path of the `Tuple` (4 x double) and
+ * `Colour` (3 x double) hot operators in vec.hh.
+ *
+ * The kernels work on raw `double` storage so that they neither depend on nor
+ * get instantiated by the `Vec` template, and they are never constexpr: callers
+ * must only reach them after checking `std::is_constant_evaluated()`, keeping
+ * compile-time rendering on the plain scalar code.
+ *
+ * AVX/AVX2 kernels are picked when the compiler targets them (e.g -mavx2),
+ * otherwise SSE2 which every x86-64 target has. Defining `RAYTRACER_NO_SIMD`
+ * (or building for another architecture) falls back to scalar loops.
+ *
+ * Every kernel has a `double` and a `float` flavour so both `Real` builds get
+ * a vector path: a float Tuple fits a single 128-bit register.
+ */
+#if !defined(RAYTRACER_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define RAYTRACER_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace RayTracer {
+namespace SimdUtils {
+
+#if defined(RAYTRACER_SIMD)
+constexpr bool Enabled = true;
+#else
+constexpr bool Enabled = false;
+#endif
+
+/*
+----------------------------------------------------------------------
+Scalar kernels: portable fallback for any floating point type, picked
+by overload resolution whenever no SIMD overload below matches
+----------------------------------------------------------------------
+*/
+namespace Scalar {
+template <typename T>
+inline void AddXYZ(const T* a, const T* b, T* out) noexcept {
+  for (std::size_t i = 0; i < 3; ++i)
+    out[i] = a[i] + b[i];
+  out[3] = a[3];
+}
+
+template <typename T>
+inline void SubXYZ(const T* a, const T* b, T* out) noexcept {
+  for (std::size_t i = 0; i < 3; ++i)
+    out[i] = a[i] - b[i];
+  out[3] = a[3];
+}
+
+template <typename T>
+inline void MulXYZ(const T* a, const T* b, T* out) noexcept {
+  for (std::size_t i = 0; i < 3; ++i)
+    out[i] = a[i] * b[i];
+  out[3] = a[3];
+}
+
+template <typename T>
+inline void ScaleXYZ(const T* a, T scalar, T* out) noexcept {
+  for (std::size_t i = 0; i < 3; ++i)
+    out[i] = a[i] * scalar;
+  out[3] = a[3];
+}
+
+template <typename T>
+inline void DivXYZ(const T* a, T scalar, T* out) noexcept {
+  for (std::size_t i = 0; i < 3; ++i)
+    out[i] = a[i] / scalar;
+  out[3] = a[3];
+}
+
+template <typename T>
+inline T Dot3(const T* a, const T* b) noexcept {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+template <typename T>
+inline void Cross3(const T* a, const T* b, T* out) noexcept {
+  out[0] = a[1] * b[2] - a[2] * b[1];
+  out[1] = a[2] * b[0] - a[0] * b[2];
+  out[2] = a[0] * b[1] - a[1] * b[0];
+  out[3] = T(0);
+}
+
+template <typename T>
+inline T Sqrt(T x) noexcept {
+  return std::sqrt(x);
+}
+
+template <typename T>
+inline void Add3(const T* a, const T* b, T* out) noexcept {
+  for (std::size_t i = 0; i < 3; ++i)
+    out[i] = a[i] + b[i];
+}
+
+template <typename T>
+inline void Sub3(const T* a, const T* b, T* out) noexcept {
+  for (std::size_t i = 0; i < 3; ++i)
+    out[i] = a[i] - b[i];
+}
+
+template <typename T>
+inline void Mul3(const T* a, const T* b, T* out) noexcept {
+  for (std::size_t i = 0; i < 3; ++i)
+    out[i] = a[i] * b[i];
+}
+
+template <typename T>
+inline void Scale3(const T* a, T scalar, T* out) noexcept {
+  for (std::size_t i = 0; i < 3; ++i)
+    out[i] = a[i] * scalar;
+}
+}  // namespace Scalar
+
+using Scalar::Add3;
+using Scalar::AddXYZ;
+using Scalar::Cross3;
+using Scalar::DivXYZ;
+using Scalar::Dot3;
+using Scalar::Mul3;
+using Scalar::MulXYZ;
+using Scalar::Scale3;
+using Scalar::ScaleXYZ;
+using Scalar::Sqrt;
+using Scalar::Sub3;
+using Scalar::SubXYZ;
+
+/*
+---------------------------------------------
+Tuple kernels: operate on x, y, z and keep w
+---------------------------------------------
+*/
+#if defined(RAYTRACER_SIMD) && defined(__AVX__)
+namespace Detail {
+/* Take lane w from `keep`, lanes x, y, z from `value` */
+inline __m256d KeepW(__m256d value, __m256d keep) noexcept {
+  return _mm256_blend_pd(value, keep, 0b1000);
+}
+}  // namespace Detail
+
+inline void AddXYZ(const double* a, const double* b, double* out) noexcept {
+  const __m256d va = _mm256_loadu_pd(a);
+  const __m256d vb = _mm256_loadu_pd(b);
+  _mm256_storeu_pd(out, Detail::KeepW(_mm256_add_pd(va, vb), va));
+}
+
+inline void SubXYZ(const double* a, const double* b, double* out) noexcept {
+  const __m256d va = _mm256_loadu_pd(a);
+  const __m256d vb = _mm256_loadu_pd(b);
+  _mm256_storeu_pd(out, Detail::KeepW(_mm256_sub_pd(va, vb), va));
+}
+
+inline void MulXYZ(const double* a, const double* b, double* out) noexcept {
+  const __m256d va = _mm256_loadu_pd(a);
+  const __m256d vb = _mm256_loadu_pd(b);
+  _mm256_storeu_pd(out, Detail::KeepW(_mm256_mul_pd(va, vb), va));
+}
+
+inline void ScaleXYZ(const double* a, double scalar, double* out) noexcept {
+  const __m256d va = _mm256_loadu_pd(a);
+  const __m256d vs = _mm256_set1_pd(scalar);
+  _mm256_storeu_pd(out, Detail::KeepW(_mm256_mul_pd(va, vs), va));
+}
+
+inline void DivXYZ(const double* a, double scalar, double* out) noexcept {
+  const __m256d va = _mm256_loadu_pd(a);
+  const __m256d vs = _mm256_set1_pd(scalar);
+  _mm256_storeu_pd(out, Detail::KeepW(_mm256_div_pd(va, vs), va));
+}
+
+inline double Dot3(const double* a, const double* b) noexcept {
+  const __m256d prod = _mm256_mul_pd(_mm256_loadu_pd(a), _mm256_loadu_pd(b));
+  const __m128d xy = _mm256_castpd256_pd128(prod);
+  const __m128d zw = _mm256_extractf128_pd(prod, 1);
+  const __m128d sum = _mm_add_sd(xy, _mm_unpackhi_pd(xy, xy));
+  return _mm_cvtsd_f64(_mm_add_sd(sum, zw));
+}
+
+#elif defined(RAYTRACER_SIMD)
+/* (x, y) go through one register, the scalar ops on (z, w) leave w untouched */
+inline void AddXYZ(const double* a, const double* b, double* out) noexcept {
+  const __m128d zwA = _mm_loadu_pd(a + 2);
+  _mm_storeu_pd(out, _mm_add_pd(_mm_loadu_pd(a), _mm_loadu_pd(b)));
+  _mm_storeu_pd(out + 2, _mm_add_sd(zwA, _mm_load_sd(b + 2)));
+}
+
+inline void SubXYZ(const double* a, const double* b, double* out) noexcept {
+  const __m128d zwA = _mm_loadu_pd(a + 2);
+  _mm_storeu_pd(out, _mm_sub_pd(_mm_loadu_pd(a), _mm_loadu_pd(b)));
+  _mm_storeu_pd(out + 2, _mm_sub_sd(zwA, _mm_load_sd(b + 2)));
+}
+
+inline void MulXYZ(const double* a, const double* b, double* out) noexcept {
+  const __m128d zwA = _mm_loadu_pd(a + 2);
+  _mm_storeu_pd(out, _mm_mul_pd(_mm_loadu_pd(a), _mm_loadu_pd(b)));
+  _mm_storeu_pd(out + 2, _mm_mul_sd(zwA, _mm_load_sd(b + 2)));
+}
+
+inline void ScaleXYZ(const double* a, double scalar, double* out) noexcept {
+  const __m128d vs = _mm_set1_pd(scalar);
+  const __m128d zwA = _mm_loadu_pd(a + 2);
+  _mm_storeu_pd(out, _mm_mul_pd(_mm_loadu_pd(a), vs));
+  _mm_storeu_pd(out + 2, _mm_mul_sd(zwA, vs));
+}
+
+inline void DivXYZ(const double* a, double scalar, double* out) noexcept {
+  const __m128d vs = _mm_set1_pd(scalar);
+  const __m128d zwA = _mm_loadu_pd(a + 2);
+  _mm_storeu_pd(out, _mm_div_pd(_mm_loadu_pd(a), vs));
+  _mm_storeu_pd(out + 2, _mm_div_sd(zwA, vs));
+}
+
+inline double Dot3(const double* a, const double* b) noexcept {
+  const __m128d xy = _mm_mul_pd(_mm_loadu_pd(a), _mm_loadu_pd(b));
+  const __m128d z = _mm_mul_sd(_mm_load_sd(a + 2), _mm_load_sd(b + 2));
+  const __m128d sum = _mm_add_sd(xy, _mm_unpackhi_pd(xy, xy));
+  return _mm_cvtsd_f64(_mm_add_sd(sum, z));
+}
+
+#endif
+
+#if defined(RAYTRACER_SIMD)
+/* A float Tuple is exactly one SSE register */
+namespace Detail {
+/* Take lane w from `keep`, lanes x, y, z from `value` (SSE2, no blendps) */
+inline __m128 KeepW(__m128 value, __m128 keep) noexcept {
+  const __m128 maskXYZ = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+  return _mm_or_ps(_mm_and_ps(maskXYZ, value), _mm_andnot_ps(maskXYZ, keep));
+}
+}  // namespace Detail
+
+inline void AddXYZ(const float* a, const float* b, float* out) noexcept {
+  const __m128 va = _mm_loadu_ps(a);
+  _mm_storeu_ps(out, Detail::KeepW(_mm_add_ps(va, _mm_loadu_ps(b)), va));
+}
+
+inline void SubXYZ(const float* a, const float* b, float* out) noexcept {
+  const __m128 va = _mm_loadu_ps(a);
+  _mm_storeu_ps(out, Detail::KeepW(_mm_sub_ps(va, _mm_loadu_ps(b)), va));
+}
+
+inline void MulXYZ(const float* a, const float* b, float* out) noexcept {
+  const __m128 va = _mm_loadu_ps(a);
+  _mm_storeu_ps(out, Detail::KeepW(_mm_mul_ps(va, _mm_loadu_ps(b)), va));
+}
+
+inline void ScaleXYZ(const float* a, float scalar, float* out) noexcept {
+  const __m128 va = _mm_loadu_ps(a);
+  _mm_storeu_ps(out, Detail::KeepW(_mm_mul_ps(va, _mm_set1_ps(scalar)), va));
+}
+
+inline void DivXYZ(const float* a, float scalar, float* out) noexcept {
+  const __m128 va = _mm_loadu_ps(a);
+  _mm_storeu_ps(out, Detail::KeepW(_mm_div_ps(va, _mm_set1_ps(scalar)), va));
+}
+
+inline float Dot3(const float* a, const float* b) noexcept {
+  const __m128 prod = _mm_mul_ps(_mm_loadu_ps(a), _mm_loadu_ps(b));
+  const __m128 y = _mm_shuffle_ps(prod, prod, _MM_SHUFFLE(1, 1, 1, 1));
+  const __m128 z = _mm_movehl_ps(prod, prod);
+  return _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(prod, y), z));
+}
+
+/* out = a x b, out.w = 0 (vector) */
+inline void Cross3(const float* a, const float* b, float* out) noexcept {
+  const __m128 va = _mm_loadu_ps(a);
+  const __m128 vb = _mm_loadu_ps(b);
+  const __m128 aYZX = _mm_shuffle_ps(va, va, _MM_SHUFFLE(3, 0, 2, 1));
+  const __m128 bZXY = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 1, 0, 2));
+  const __m128 aZXY = _mm_shuffle_ps(va, va, _MM_SHUFFLE(3, 1, 0, 2));
+  const __m128 bYZX = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 0, 2, 1));
+  const __m128 cross =
+      _mm_sub_ps(_mm_mul_ps(aYZX, bZXY), _mm_mul_ps(aZXY, bYZX));
+  _mm_storeu_ps(out, Detail::KeepW(cross, _mm_setzero_ps()));
+}
+
+/* sqrt without the errno bookkeeping of std::sqrt */
+inline double Sqrt(double x) noexcept {
+  const __m128d v = _mm_set_sd(x);
+  return _mm_cvtsd_f64(_mm_sqrt_sd(v, v));
+}
+
+inline float Sqrt(float x) noexcept {
+  return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(x)));
+}
+#endif
+
+/* out = a x b, out.w = 0 (vector) */
+#if defined(RAYTRACER_SIMD) && defined(__AVX2__)
+inline void Cross3(const double* a, const double* b, double* out) noexcept {
+  const __m256d va = _mm256_loadu_pd(a);
+  const __m256d vb = _mm256_loadu_pd(b);
+  // (y, z, x, w) and (z, x, y, w) permutations of both operands
+  const __m256d aYZX = _mm256_permute4x64_pd(va, _MM_SHUFFLE(3, 0, 2, 1));
+  const __m256d bZXY = _mm256_permute4x64_pd(vb, _MM_SHUFFLE(3, 1, 0, 2));
+  const __m256d aZXY = _mm256_permute4x64_pd(va, _MM_SHUFFLE(3, 1, 0, 2));
+  const __m256d bYZX = _mm256_permute4x64_pd(vb, _MM_SHUFFLE(3, 0, 2, 1));
+  const __m256d cross =
+      _mm256_sub_pd(_mm256_mul_pd(aYZX, bZXY), _mm256_mul_pd(aZXY, bYZX));
+  _mm256_storeu_pd(out, _mm256_blend_pd(cross, _mm256_setzero_pd(), 0b1000));
+}
+#endif
+
+/* out.xyz = a.xyz / |a.xyz|, out.w = a.w */
+template <typename T>
+inline void Normalize3(const T* a, T* out) noexcept {
+  DivXYZ(a, Sqrt(Dot3(a, a)), out);
+}
+
+/* out = v - n * 2 * dot(v, n), out.w = v.w */
+template <typename T>
+inline void Reflect3(const T* v, const T* n, T* out) noexcept {
+  T scaled[4];
+  ScaleXYZ(n, T(2) * Dot3(v, n), scaled);
+  SubXYZ(v, scaled, out);
+}
+
+/*
+---------------------------------------
+Colour kernels: operate on r, g and b
+---------------------------------------
+*/
+#if defined(RAYTRACER_SIMD)
+/*
+ * r and g go through one SSE2 register, b through the scalar lane. Three
+ * floats gain nothing over the scalar loop, so float Colours use Scalar::
+ */
+inline void Add3(const double* a, const double* b, double* out) noexcept {
+  _mm_storeu_pd(out, _mm_add_pd(_mm_loadu_pd(a), _mm_loadu_pd(b)));
+  out[2] = a[2] + b[2];
+}
+
+inline void Sub3(const double* a, const double* b, double* out) noexcept {
+  _mm_storeu_pd(out, _mm_sub_pd(_mm_loadu_pd(a), _mm_loadu_pd(b)));
+  out[2] = a[2] - b[2];
+}
+
+inline void Mul3(const double* a, const double* b, double* out) noexcept {
+  _mm_storeu_pd(out, _mm_mul_pd(_mm_loadu_pd(a), _mm_loadu_pd(b)));
+  out[2] = a[2] * b[2];
+}
+
+inline void Scale3(const double* a, double scalar, double* out) noexcept {
+  _mm_storeu_pd(out, _mm_mul_pd(_mm_loadu_pd(a), _mm_set1_pd(scalar)));
+  out[2] = a[2] * scalar;
+}
+#endif
+
+/*
+-------------------------------------------------------------------------
+Register kernels: the four lanes of a Tuple held in registers, so that a
+whole expression tree of vec.hh is computed without storing its inner
+nodes. `Load4`/`Set4` produce a pack, the arithmetic kernels combine
+packs, and only the root of the tree is written back with `StoreXYZ`,
+taking lane w from the pack of another Tuple in the register: a scalar
+store of w would stall the next full width load of the Tuple.
+-------------------------------------------------------------------------
+*/
+namespace Scalar {
+template <typename T>
+struct Pack4 {
+  T lanes[4];
+};
+
+template <typename T>
+inline Pack4<T> Load4(const T* a) noexcept {
+  return {{a[0], a[1], a[2], a[3]}};
+}
+
+template <typename T>
+inline Pack4<T> Set4(T scalar) noexcept {
+  return {{scalar, scalar, scalar, scalar}};
+}
+
+template <typename T>
+inline void StoreXYZ(const Pack4<T>& a, const Pack4<T>& keep,
+                     T* out) noexcept {
+  for (std::size_t i = 0; i < 3; ++i)
+    out[i] = a.lanes[i];
+  out[3] = keep.lanes[3];
+}
+
+template <typename T>
+inline Pack4<T> Add4(const Pack4<T>& a, const Pack4<T>& b) noexcept {
+  Pack4<T> ret;
+  for (std::size_t i = 0; i < 4; ++i)
+    ret.lanes[i] = a.lanes[i] + b.lanes[i];
+  return ret;
+}
+
+template <typename T>
+inline Pack4<T> Sub4(const Pack4<T>& a, const Pack4<T>& b) noexcept {
+  Pack4<T> ret;
+  for (std::size_t i = 0; i < 4; ++i)
+    ret.lanes[i] = a.lanes[i] - b.lanes[i];
+  return ret;
+}
+
+template <typename T>
+inline Pack4<T> Mul4(const Pack4<T>& a, const Pack4<T>& b) noexcept {
+  Pack4<T> ret;
+  for (std::size_t i = 0; i < 4; ++i)
+    ret.lanes[i] = a.lanes[i] * b.lanes[i];
+  return ret;
+}
+
+template <typename T>
+inline Pack4<T> Div4(const Pack4<T>& a, const Pack4<T>& b) noexcept {
+  Pack4<T> ret;
+  for (std::size_t i = 0; i < 4; ++i)
+    ret.lanes[i] = a.lanes[i] / b.lanes[i];
+  return ret;
+}
+
+template <typename T>
+inline Pack4<T> Neg4(const Pack4<T>& a) noexcept {
+  Pack4<T> ret;
+  for (std::size_t i = 0; i < 4; ++i)
+    ret.lanes[i] = -a.lanes[i];
+  return ret;
+}
+}  // namespace Scalar
+
+using Scalar::Add4;
+using Scalar::Div4;
+using Scalar::Load4;
+using Scalar::Mul4;
+using Scalar::Neg4;
+using Scalar::Set4;
+using Scalar::StoreXYZ;
+using Scalar::Sub4;
+
+#if defined(RAYTRACER_SIMD) && defined(__AVX__)
+inline __m256d Load4(const double* a) noexcept { return _mm256_loadu_pd(a); }
+
+inline __m256d Set4(double scalar) noexcept { return _mm256_set1_pd(scalar); }
+
+inline void StoreXYZ(__m256d a, __m256d keep, double* out) noexcept {
+  _mm256_storeu_pd(out, Detail::KeepW(a, keep));
+}
+
+inline __m256d Add4(__m256d a, __m256d b) noexcept {
+  return _mm256_add_pd(a, b);
+}
+
+inline __m256d Sub4(__m256d a, __m256d b) noexcept {
+  return _mm256_sub_pd(a, b);
+}
+
+inline __m256d Mul4(__m256d a, __m256d b) noexcept {
+  return _mm256_mul_pd(a, b);
+}
+
+inline __m256d Div4(__m256d a, __m256d b) noexcept {
+  return _mm256_div_pd(a, b);
+}
+
+inline __m256d Neg4(__m256d a) noexcept {
+  return _mm256_xor_pd(a, _mm256_set1_pd(-0.0));
+}
+
+#elif defined(RAYTRACER_SIMD)
+namespace Detail {
+/* Four doubles as two SSE2 registers, (x, y) and (z, w) */
+struct Pack2x2 {
+  __m128d xy;
+  __m128d zw;
+};
+}  // namespace Detail
+
+inline Detail::Pack2x2 Load4(const double* a) noexcept {
+  return {_mm_loadu_pd(a), _mm_loadu_pd(a + 2)};
+}
+
+inline Detail::Pack2x2 Set4(double scalar) noexcept {
+  const __m128d v = _mm_set1_pd(scalar);
+  return {v, v};
+}
+
+inline void StoreXYZ(const Detail::Pack2x2& a, const Detail::Pack2x2& keep,
+                     double* out) noexcept {
+  _mm_storeu_pd(out, a.xy);
+  _mm_storeu_pd(out + 2, _mm_move_sd(keep.zw, a.zw));
+}
+
+inline Detail::Pack2x2 Add4(const Detail::Pack2x2& a,
+                            const Detail::Pack2x2& b) noexcept {
+  return {_mm_add_pd(a.xy, b.xy), _mm_add_pd(a.zw, b.zw)};
+}
+
+inline Detail::Pack2x2 Sub4(const Detail::Pack2x2& a,
+                            const Detail::Pack2x2& b) noexcept {
+  return {_mm_sub_pd(a.xy, b.xy), _mm_sub_pd(a.zw, b.zw)};
+}
+
+inline Detail::Pack2x2 Mul4(const Detail::Pack2x2& a,
+                            const Detail::Pack2x2& b) noexcept {
+  return {_mm_mul_pd(a.xy, b.xy), _mm_mul_pd(a.zw, b.zw)};
+}
+
+inline Detail::Pack2x2 Div4(const Detail::Pack2x2& a,
+                            const Detail::Pack2x2& b) noexcept {
+  return {_mm_div_pd(a.xy, b.xy), _mm_div_pd(a.zw, b.zw)};
+}
+
+inline Detail::Pack2x2 Neg4(const Detail::Pack2x2& a) noexcept {
+  const __m128d signBit = _mm_set1_pd(-0.0);
+  return {_mm_xor_pd(a.xy, signBit), _mm_xor_pd(a.zw, signBit)};
+}
+#endif
+
+#if defined(RAYTRACER_SIMD)
+inline __m128 Load4(const float* a) noexcept { return _mm_loadu_ps(a); }
+
+inline __m128 Set4(float scalar) noexcept { return _mm_set1_ps(scalar); }
+
+inline void StoreXYZ(__m128 a, __m128 keep, float* out) noexcept {
+  _mm_storeu_ps(out, Detail::KeepW(a, keep));
+}
+
+inline __m128 Add4(__m128 a, __m128 b) noexcept { return _mm_add_ps(a, b); }
+
+inline __m128 Sub4(__m128 a, __m128 b) noexcept { return _mm_sub_ps(a, b); }
+
+inline __m128 Mul4(__m128 a, __m128 b) noexcept { return _mm_mul_ps(a, b); }
+
+inline __m128 Div4(__m128 a, __m128 b) noexcept { return _mm_div_ps(a, b); }
+
+inline __m128 Neg4(__m128 a) noexcept {
+  return _mm_xor_ps(a, _mm_set1_ps(-0.0f));
+}
+#endif
+
+/*
+-------------------------------------------------------------------------
+Slab test kernel: whether a ray crosses a box within its [tMin, tMax].
+
+The near plane of each slab is the lower one when the inverse direction
+is positive, the upper one otherwise. A ray parallel to a slab has an
+infinite inverse direction: its distance to a plane is +/-inf when the
+origin is outside the slab, and NaN (0 * inf) when it lies on the plane.
+The min/max below keep their second operand on NaN, so such an axis does
+not clip the interval.
+-------------------------------------------------------------------------
+*/
+namespace Scalar {
+template <typename T>
+inline bool SlabTest(const T* lower, const T* upper, const T* origin,
+                     const T* invDirection, T tMin, T tMax) noexcept {
+  for (std::size_t i = 0; i < 3; ++i) {
+    const bool negative = std::signbit(invDirection[i]);
+    const T tNear =
+        ((negative ? upper : lower)[i] - origin[i]) * invDirection[i];
+    const T tFar =
+        ((negative ? lower : upper)[i] - origin[i]) * invDirection[i];
+    tMin = tNear > tMin ? tNear : tMin;
+    tMax = tFar < tMax ? tFar : tMax;
+  }
+  return tMin <= tMax;
+}
+}  // namespace Scalar
+
+using Scalar::SlabTest;
+
+#if defined(RAYTRACER_SIMD) && defined(__AVX__)
+inline bool SlabTest(const double* lower, const double* upper,
+                     const double* origin, const double* invDirection,
+                     double tMin, double tMax) noexcept {
+  const __m256d vLower = _mm256_loadu_pd(lower);
+  const __m256d vUpper = _mm256_loadu_pd(upper);
+  const __m256d vOrigin = _mm256_loadu_pd(origin);
+  const __m256d vInv = _mm256_loadu_pd(invDirection);
+  // blendv selects on the sign bit of the inverse direction
+  const __m256d nearPlane = _mm256_blendv_pd(vLower, vUpper, vInv);
+  const __m256d farPlane = _mm256_blendv_pd(vUpper, vLower, vInv);
+  const __m256d vMin = _mm256_set1_pd(tMin);
+  const __m256d vMax = _mm256_set1_pd(tMax);
+  // lane w is replaced by the interval itself so that it never clips it
+  const __m256d tNear = Detail::KeepW(
+      _mm256_mul_pd(_mm256_sub_pd(nearPlane, vOrigin), vInv), vMin);
+  const __m256d tFar = Detail::KeepW(
+      _mm256_mul_pd(_mm256_sub_pd(farPlane, vOrigin), vInv), vMax);
+  const __m256d t0 = _mm256_max_pd(tNear, vMin);
+  const __m256d t1 = _mm256_min_pd(tFar, vMax);
+  // horizontal max of t0 and min of t1
+  __m128d enter = _mm_max_pd(_mm256_castpd256_pd128(t0),
+                             _mm256_extractf128_pd(t0, 1));
+  __m128d exit = _mm_min_pd(_mm256_castpd256_pd128(t1),
+                            _mm256_extractf128_pd(t1, 1));
+  enter = _mm_max_sd(enter, _mm_unpackhi_pd(enter, enter));
+  exit = _mm_min_sd(exit, _mm_unpackhi_pd(exit, exit));
+  return _mm_comile_sd(enter, exit);
+}
+
+#elif defined(RAYTRACER_SIMD)
+namespace Detail {
+/* `ifNegative` where the sign bit of `selector` is set, `otherwise` elsewhere
+ * (SSE2, no blendvpd) */
+inline __m128d SelectOnSign(__m128d selector, __m128d ifNegative,
+                            __m128d otherwise) noexcept {
+  const __m128d mask = _mm_cmplt_pd(selector, _mm_setzero_pd());
+  return _mm_or_pd(_mm_and_pd(mask, ifNegative),
+                   _mm_andnot_pd(mask, otherwise));
+}
+}  // namespace Detail
+
+/* (x, y) go through one register, z through the low lane of another */
+inline bool SlabTest(const double* lower, const double* upper,
+                     const double* origin, const double* invDirection,
+                     double tMin, double tMax) noexcept {
+  const auto distances = [&](std::size_t i, __m128d& tNear, __m128d& tFar) {
+    const __m128d vLower = _mm_loadu_pd(lower + i);
+    const __m128d vUpper = _mm_loadu_pd(upper + i);
+    const __m128d vOrigin = _mm_loadu_pd(origin + i);
+    const __m128d vInv = _mm_loadu_pd(invDirection + i);
+    tNear = _mm_mul_pd(
+        _mm_sub_pd(Detail::SelectOnSign(vInv, vUpper, vLower), vOrigin), vInv);
+    tFar = _mm_mul_pd(
+        _mm_sub_pd(Detail::SelectOnSign(vInv, vLower, vUpper), vOrigin), vInv);
+  };
+  const __m128d vMin = _mm_set1_pd(tMin);
+  const __m128d vMax = _mm_set1_pd(tMax);
+  __m128d xyNear, xyFar, zwNear, zwFar;
+  distances(0, xyNear, xyFar);
+  distances(2, zwNear, zwFar);
+  __m128d enter = _mm_max_pd(xyNear, vMin);
+  __m128d exit = _mm_min_pd(xyFar, vMax);
+  // scalar ops on z, lane w of zwNear/zwFar is never read
+  enter = _mm_max_sd(enter, _mm_max_sd(zwNear, vMin));
+  exit = _mm_min_sd(exit, _mm_min_sd(zwFar, vMax));
+  enter = _mm_max_sd(enter, _mm_unpackhi_pd(enter, enter));
+  exit = _mm_min_sd(exit, _mm_unpackhi_pd(exit, exit));
+  return _mm_comile_sd(enter, exit);
+}
+#endif
+
+#if defined(RAYTRACER_SIMD)
+/* A float Tuple is one register, the sign mask comes from a compare */
+inline bool SlabTest(const float* lower, const float* upper,
+                     const float* origin, const float* invDirection,
+                     float tMin, float tMax) noexcept {
+  const __m128 vLower = _mm_loadu_ps(lower);
+  const __m128 vUpper = _mm_loadu_ps(upper);
+  const __m128 vOrigin = _mm_loadu_ps(origin);
+  const __m128 vInv = _mm_loadu_ps(invDirection);
+  const __m128 negative = _mm_cmplt_ps(vInv, _mm_setzero_ps());
+  const __m128 nearPlane = _mm_or_ps(_mm_and_ps(negative, vUpper),
+                                     _mm_andnot_ps(negative, vLower));
+  const __m128 farPlane = _mm_or_ps(_mm_and_ps(negative, vLower),
+                                    _mm_andnot_ps(negative, vUpper));
+  const __m128 vMin = _mm_set1_ps(tMin);
+  const __m128 vMax = _mm_set1_ps(tMax);
+  const __m128 tNear = Detail::KeepW(
+      _mm_mul_ps(_mm_sub_ps(nearPlane, vOrigin), vInv), vMin);
+  const __m128 tFar = Detail::KeepW(
+      _mm_mul_ps(_mm_sub_ps(farPlane, vOrigin), vInv), vMax);
+  __m128 enter = _mm_max_ps(tNear, vMin);
+  __m128 exit = _mm_min_ps(tFar, vMax);
+  enter = _mm_max_ps(enter, _mm_movehl_ps(enter, enter));
+  exit = _mm_min_ps(exit, _mm_movehl_ps(exit, exit));
+  constexpr int laneY = _MM_SHUFFLE(1, 1, 1, 1);
+  enter = _mm_max_ss(enter, _mm_shuffle_ps(enter, enter, laneY));
+  exit = _mm_min_ss(exit, _mm_shuffle_ps(exit, exit, laneY));
+  return _mm_comile_ss(enter, exit);
+}
+#endif
+
+/*
+-------------------------------------------------------------------------
+Wide slab test kernel: one ray against the boxes of a wide BVH node.
+
+Boxes are stored per axis as arrays of `Width` lower and upper bounds
+(SoA). The caller passes, for each axis, the array of near planes and the
+one of far planes, picked once per ray from the sign of its direction, so
+that no lane needs a blend. Returns the mask of the boxes crossed within
+[tMin, tMax], bit i for box i, and writes their entry distance to `tEntry`.
+NaN distances do not clip the interval, as in SlabTest. `Width` must be a
+multiple of 4.
+-------------------------------------------------------------------------
+*/
+namespace Scalar {
+template <std::size_t Width, typename T>
+inline unsigned SlabTestWide(const T* const* nearPlanes,
+                             const T* const* farPlanes, const T* origin,
+                             const T* invDirection, T tMin, T tMax,
+                             T* tEntry) noexcept {
+  unsigned mask = 0;
+  for (std::size_t lane = 0; lane < Width; ++lane) {
+    T t0 = tMin;
+    T t1 = tMax;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      const T tNear =
+          (nearPlanes[axis][lane] - origin[axis]) * invDirection[axis];
+      const T tFar =
+          (farPlanes[axis][lane] - origin[axis]) * invDirection[axis];
+      t0 = tNear > t0 ? tNear : t0;
+      t1 = tFar < t1 ? tFar : t1;
+    }
+    tEntry[lane] = t0;
+    mask |= static_cast<unsigned>(t0 <= t1) << lane;
+  }
+  return mask;
+}
+}  // namespace Scalar
+
+using Scalar::SlabTestWide;
+
+#if defined(RAYTRACER_SIMD) && defined(__AVX__)
+/* Four boxes per register */
+template <std::size_t Width>
+inline unsigned SlabTestWide(const double* const* nearPlanes,
+                             const double* const* farPlanes,
+                             const double* origin, const double* invDirection,
+                             double tMin, double tMax,
+                             double* tEntry) noexcept {
+  static_assert(Width % 4 == 0);
+  const __m256d o[3] = {_mm256_set1_pd(origin[0]), _mm256_set1_pd(origin[1]),
+                        _mm256_set1_pd(origin[2])};
+  const __m256d inv[3] = {_mm256_set1_pd(invDirection[0]),
+                          _mm256_set1_pd(invDirection[1]),
+                          _mm256_set1_pd(invDirection[2])};
+  unsigned mask = 0;
+  for (std::size_t lane = 0; lane < Width; lane += 4) {
+    __m256d t0 = _mm256_set1_pd(tMin);
+    __m256d t1 = _mm256_set1_pd(tMax);
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      const __m256d tNear = _mm256_mul_pd(
+          _mm256_sub_pd(_mm256_loadu_pd(nearPlanes[axis] + lane), o[axis]),
+          inv[axis]);
+      const __m256d tFar = _mm256_mul_pd(
+          _mm256_sub_pd(_mm256_loadu_pd(farPlanes[axis] + lane), o[axis]),
+          inv[axis]);
+      // the second operand is kept on NaN
+      t0 = _mm256_max_pd(tNear, t0);
+      t1 = _mm256_min_pd(tFar, t1);
+    }
+    _mm256_storeu_pd(tEntry + lane, t0);
+    mask |= static_cast<unsigned>(
+                _mm256_movemask_pd(_mm256_cmp_pd(t0, t1, _CMP_LE_OQ)))
+            << lane;
+  }
+  return mask;
+}
+
+#elif defined(RAYTRACER_SIMD)
+/* Two boxes per register */
+template <std::size_t Width>
+inline unsigned SlabTestWide(const double* const* nearPlanes,
+                             const double* const* farPlanes,
+                             const double* origin, const double* invDirection,
+                             double tMin, double tMax,
+                             double* tEntry) noexcept {
+  static_assert(Width % 4 == 0);
+  const __m128d o[3] = {_mm_set1_pd(origin[0]), _mm_set1_pd(origin[1]),
+                        _mm_set1_pd(origin[2])};
+  const __m128d inv[3] = {_mm_set1_pd(invDirection[0]),
+                          _mm_set1_pd(invDirection[1]),
+                          _mm_set1_pd(invDirection[2])};
+  unsigned mask = 0;
+  for (std::size_t lane = 0; lane < Width; lane += 2) {
+    __m128d t0 = _mm_set1_pd(tMin);
+    __m128d t1 = _mm_set1_pd(tMax);
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      const __m128d tNear = _mm_mul_pd(
+          _mm_sub_pd(_mm_loadu_pd(nearPlanes[axis] + lane), o[axis]),
+          inv[axis]);
+      const __m128d tFar = _mm_mul_pd(
+          _mm_sub_pd(_mm_loadu_pd(farPlanes[axis] + lane), o[axis]),
+          inv[axis]);
+      t0 = _mm_max_pd(tNear, t0);
+      t1 = _mm_min_pd(tFar, t1);
+    }
+    _mm_storeu_pd(tEntry + lane, t0);
+    mask |= static_cast<unsigned>(_mm_movemask_pd(_mm_cmple_pd(t0, t1)))
+            << lane;
+  }
+  return mask;
+}
+#endif
+
+#if defined(RAYTRACER_SIMD)
+/* Four float boxes per SSE register */
+template <std::size_t Width>
+inline unsigned SlabTestWide(const float* const* nearPlanes,
+                             const float* const* farPlanes,
+                             const float* origin, const float* invDirection,
+                             float tMin, float tMax, float* tEntry) noexcept {
+  static_assert(Width % 4 == 0);
+  const __m128 o[3] = {_mm_set1_ps(origin[0]), _mm_set1_ps(origin[1]),
+                       _mm_set1_ps(origin[2])};
+  const __m128 inv[3] = {_mm_set1_ps(invDirection[0]),
+                         _mm_set1_ps(invDirection[1]),
+                         _mm_set1_ps(invDirection[2])};
+  unsigned mask = 0;
+  for (std::size_t lane = 0; lane < Width; lane += 4) {
+    __m128 t0 = _mm_set1_ps(tMin);
+    __m128 t1 = _mm_set1_ps(tMax);
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      const __m128 tNear = _mm_mul_ps(
+          _mm_sub_ps(_mm_loadu_ps(nearPlanes[axis] + lane), o[axis]),
+          inv[axis]);
+      const __m128 tFar = _mm_mul_ps(
+          _mm_sub_ps(_mm_loadu_ps(farPlanes[axis] + lane), o[axis]),
+          inv[axis]);
+      t0 = _mm_max_ps(tNear, t0);
+      t1 = _mm_min_ps(tFar, t1);
+    }
+    _mm_storeu_ps(tEntry + lane, t0);
+    mask |= static_cast<unsigned>(_mm_movemask_ps(_mm_cmple_ps(t0, t1)))
+            << lane;
+  }
+  return mask;
+}
+#endif
+
+/*
+-------------------------------------------------------------------------
+Batched sphere kernel: one ray against `count` unit spheres, each given by
+its world-to-object affine transform in SoA form, coefficient (row, col)
+of sphere i being `inverse[row * 4 + col][i]`.
+
+Every lane moves the ray to the object space of one sphere and solves the
+quadratic there, masking out the spheres it misses: a negative
+discriminant is a miss unless within 1e-4 of zero, a tangent ray whose
+roots are both -b / 2a (see MathUtils::SolveQuadratic). Each lane keeps
+its nearest root inside [tMin, best], `best` being the nearest one the
+lane found so far, so that like a scan clipping the ray after each hit a
+later sphere wins a tie. Lanes are reduced to the nearest hit at the end,
+and spheres past the last full register go through the scalar loop.
+
+Returns the index of the sphere hit first, or `count` if none, and writes
+its distance to `tNearest`.
+
+`AnySphereHit` is the any-hit variant for shadow rays: whether a sphere has
+a root inside [tMin, tMax], returning at the first register holding one.
+-------------------------------------------------------------------------
+*/
+namespace Scalar {
+/* Spheres [first, count), clipping `tMax` to each hit found in `nearest` */
+template <typename T>
+inline void ScanSpheres(const T* const* inverse, std::size_t first,
+                        std::size_t count, const T* origin,
+                        const T* direction, T tMin, T& tMax,
+                        std::size_t& nearest) noexcept {
+  for (std::size_t i = first; i < count; ++i) {
+    T o[3];
+    T d[3];
+    for (std::size_t row = 0; row < 3; ++row) {
+      const T* const* m = inverse + row * 4;
+      o[row] = m[0][i] * origin[0] + m[1][i] * origin[1] +
+               m[2][i] * origin[2] + m[3][i];
+      d[row] = m[0][i] * direction[0] + m[1][i] * direction[1] +
+               m[2][i] * direction[2];
+    }
+    const T a = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+    const T b = 2 * (d[0] * o[0] + d[1] * o[1] + d[2] * o[2]);
+    const T c = o[0] * o[0] + o[1] * o[1] + o[2] * o[2] - 1;
+    const T discriminant = (b * b) - (4 * a * c);
+    const bool tangent = std::abs(discriminant) < T(1e-4);
+    if (!tangent && discriminant < 0)
+      continue;
+    const T sqrtD = tangent ? T(0) : std::sqrt(discriminant);
+    const T denominator = 1 / (2 * a);
+    const T r1 = (-b - sqrtD) * denominator;
+    const T r2 = (-b + sqrtD) * denominator;
+    const bool in1 = tMin <= r1 && r1 <= tMax;
+    if (in1 || (tMin <= r2 && r2 <= tMax)) {
+      tMax = in1 ? r1 : r2;
+      nearest = i;
+    }
+  }
+}
+
+/* Whether a sphere of [first, count) has a root inside [tMin, tMax] */
+template <typename T>
+inline bool HitsAnySphere(const T* const* inverse, std::size_t first,
+                          std::size_t count, const T* origin,
+                          const T* direction, T tMin, T tMax) noexcept {
+  for (std::size_t i = first; i < count; ++i) {
+    std::size_t hit = count;
+    T limit = tMax;
+    ScanSpheres(inverse, i, i + 1, origin, direction, tMin, limit, hit);
+    if (hit < count)
+      return true;
+  }
+  return false;
+}
+
+template <typename T>
+inline std::size_t NearestSphereRoot(const T* const* inverse,
+                                     std::size_t count, const T* origin,
+                                     const T* direction, T tMin, T tMax,
+                                     T* tNearest) noexcept {
+  std::size_t nearest = count;
+  ScanSpheres(inverse, 0, count, origin, direction, tMin, tMax, nearest);
+  if (nearest < count)
+    *tNearest = tMax;
+  return nearest;
+}
+
+template <typename T>
+inline bool AnySphereHit(const T* const* inverse, std::size_t count,
+                         const T* origin, const T* direction, T tMin,
+                         T tMax) noexcept {
+  return HitsAnySphere(inverse, 0, count, origin, direction, tMin, tMax);
+}
+}  // namespace Scalar
+
+using Scalar::AnySphereHit;
+using Scalar::NearestSphereRoot;
+
+namespace Detail {
+/*
+ * Reduce the per-lane nearest roots `best` of the spheres `index` (negative
+ * for a lane without hit) to the nearest one, the later sphere on a tie,
+ * then scan the spheres [first, count) left over.
+ */
+template <typename T, typename IndexType, std::size_t Lanes>
+inline std::size_t ReduceSphereLanes(const T (&best)[Lanes],
+                                     const IndexType (&index)[Lanes],
+                                     const T* const* inverse,
+                                     std::size_t first, std::size_t count,
+                                     const T* origin, const T* direction,
+                                     T tMin, T tMax, T* tNearest) noexcept {
+  std::size_t nearest = count;
+  for (std::size_t lane = 0; lane < Lanes; ++lane) {
+    if (index[lane] < 0)
+      continue;
+    const auto i = static_cast<std::size_t>(index[lane]);
+    if (best[lane] < tMax ||
+        (best[lane] == tMax && (nearest == count || i > nearest))) {
+      tMax = best[lane];
+      nearest = i;
+    }
+  }
+  Scalar::ScanSpheres(inverse, first, count, origin, direction, tMin, tMax,
+                      nearest);
+  if (nearest < count)
+    *tNearest = tMax;
+  return nearest;
+}
+}  // namespace Detail
+
+#if defined(RAYTRACER_SIMD) && defined(__AVX__)
+namespace Detail {
+/*
+ * The four spheres from `i` against the ray broadcast in `o` and `d`: the
+ * lanes with a root inside [vMin, vMax] are set in the returned mask, with
+ * the nearest such root in `root`.
+ */
+inline __m256d SphereRoots(const double* const* inverse, std::size_t i,
+                           const __m256d (&o)[3], const __m256d (&d)[3],
+                           __m256d vMin, __m256d vMax,
+                           __m256d& root) noexcept {
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d signBit = _mm256_set1_pd(-0.0);
+  __m256d so[3];
+  __m256d sd[3];
+  for (std::size_t row = 0; row < 3; ++row) {
+    const double* const* m = inverse + row * 4;
+    const __m256d m0 = _mm256_loadu_pd(m[0] + i);
+    const __m256d m1 = _mm256_loadu_pd(m[1] + i);
+    const __m256d m2 = _mm256_loadu_pd(m[2] + i);
+    so[row] = _mm256_add_pd(
+        _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(m0, o[0]),
+                                    _mm256_mul_pd(m1, o[1])),
+                      _mm256_mul_pd(m2, o[2])),
+        _mm256_loadu_pd(m[3] + i));
+    sd[row] = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(m0, d[0]),
+                                          _mm256_mul_pd(m1, d[1])),
+                            _mm256_mul_pd(m2, d[2]));
+  }
+  const auto dot = [](const __m256d* u, const __m256d* v) {
+    return _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(u[0], v[0]),
+                                       _mm256_mul_pd(u[1], v[1])),
+                         _mm256_mul_pd(u[2], v[2]));
+  };
+  const __m256d a = dot(sd, sd);
+  const __m256d b = _mm256_mul_pd(_mm256_set1_pd(2), dot(sd, so));
+  const __m256d c = _mm256_sub_pd(dot(so, so), _mm256_set1_pd(1));
+  const __m256d discriminant =
+      _mm256_sub_pd(_mm256_mul_pd(b, b),
+                    _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(4), a), c));
+  const __m256d tangent =
+      _mm256_cmp_pd(_mm256_andnot_pd(signBit, discriminant),
+                    _mm256_set1_pd(1e-4), _CMP_LT_OQ);
+  const __m256d real =
+      _mm256_or_pd(tangent, _mm256_cmp_pd(discriminant, zero, _CMP_GE_OQ));
+  const __m256d sqrtD = _mm256_andnot_pd(
+      tangent, _mm256_sqrt_pd(_mm256_max_pd(discriminant, zero)));
+  const __m256d denominator =
+      _mm256_div_pd(_mm256_set1_pd(1), _mm256_add_pd(a, a));
+  const __m256d negB = _mm256_xor_pd(b, signBit);
+  const __m256d r1 = _mm256_mul_pd(_mm256_sub_pd(negB, sqrtD), denominator);
+  const __m256d r2 = _mm256_mul_pd(_mm256_add_pd(negB, sqrtD), denominator);
+  const __m256d in1 = _mm256_and_pd(_mm256_cmp_pd(vMin, r1, _CMP_LE_OQ),
+                                    _mm256_cmp_pd(r1, vMax, _CMP_LE_OQ));
+  const __m256d in2 = _mm256_and_pd(_mm256_cmp_pd(vMin, r2, _CMP_LE_OQ),
+                                    _mm256_cmp_pd(r2, vMax, _CMP_LE_OQ));
+  root = _mm256_blendv_pd(r2, r1, in1);
+  return _mm256_and_pd(real, _mm256_or_pd(in1, in2));
+}
+}  // namespace Detail
+
+/* Four spheres per register, the sphere index of a lane kept as a double */
+inline std::size_t NearestSphereRoot(const double* const* inverse,
+                                     std::size_t count, const double* origin,
+                                     const double* direction, double tMin,
+                                     double tMax, double* tNearest) noexcept {
+  const __m256d o[3] = {_mm256_set1_pd(origin[0]), _mm256_set1_pd(origin[1]),
+                        _mm256_set1_pd(origin[2])};
+  const __m256d d[3] = {_mm256_set1_pd(direction[0]),
+                        _mm256_set1_pd(direction[1]),
+                        _mm256_set1_pd(direction[2])};
+  const __m256d vMin = _mm256_set1_pd(tMin);
+  __m256d best = _mm256_set1_pd(tMax);
+  __m256d bestIndex = _mm256_set1_pd(-1);
+  __m256d laneIndex = _mm256_set_pd(3, 2, 1, 0);
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256d root;
+    const __m256d hit = Detail::SphereRoots(inverse, i, o, d, vMin, best, root);
+    best = _mm256_blendv_pd(best, root, hit);
+    bestIndex = _mm256_blendv_pd(bestIndex, laneIndex, hit);
+    laneIndex = _mm256_add_pd(laneIndex, _mm256_set1_pd(4));
+  }
+  double lanes[4];
+  double indices[4];
+  _mm256_storeu_pd(lanes, best);
+  _mm256_storeu_pd(indices, bestIndex);
+  return Detail::ReduceSphereLanes(lanes, indices, inverse, i, count, origin,
+                                   direction, tMin, tMax, tNearest);
+}
+
+inline bool AnySphereHit(const double* const* inverse, std::size_t count,
+                         const double* origin, const double* direction,
+                         double tMin, double tMax) noexcept {
+  const __m256d o[3] = {_mm256_set1_pd(origin[0]), _mm256_set1_pd(origin[1]),
+                        _mm256_set1_pd(origin[2])};
+  const __m256d d[3] = {_mm256_set1_pd(direction[0]),
+                        _mm256_set1_pd(direction[1]),
+                        _mm256_set1_pd(direction[2])};
+  const __m256d vMin = _mm256_set1_pd(tMin);
+  const __m256d vMax = _mm256_set1_pd(tMax);
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256d root;
+    if (_mm256_movemask_pd(
+            Detail::SphereRoots(inverse, i, o, d, vMin, vMax, root)) != 0)
+      return true;
+  }
+  return Scalar::HitsAnySphere(inverse, i, count, origin, direction, tMin,
+                               tMax);
+}
+
+#elif defined(RAYTRACER_SIMD)
+namespace Detail {
+/* `ifTrue` where `mask` is set, `otherwise` elsewhere (SSE2, no blendvpd) */
+inline __m128d Select(__m128d mask, __m128d ifTrue,
+                      __m128d otherwise) noexcept {
+  return _mm_or_pd(_mm_and_pd(mask, ifTrue), _mm_andnot_pd(mask, otherwise));
+}
+
+/* Same as the AVX version above for two spheres */
+inline __m128d SphereRoots(const double* const* inverse, std::size_t i,
+                           const __m128d (&o)[3], const __m128d (&d)[3],
+                           __m128d vMin, __m128d vMax,
+                           __m128d& root) noexcept {
+  const __m128d zero = _mm_setzero_pd();
+  const __m128d signBit = _mm_set1_pd(-0.0);
+  __m128d so[3];
+  __m128d sd[3];
+  for (std::size_t row = 0; row < 3; ++row) {
+    const double* const* m = inverse + row * 4;
+    const __m128d m0 = _mm_loadu_pd(m[0] + i);
+    const __m128d m1 = _mm_loadu_pd(m[1] + i);
+    const __m128d m2 = _mm_loadu_pd(m[2] + i);
+    so[row] = _mm_add_pd(
+        _mm_add_pd(_mm_add_pd(_mm_mul_pd(m0, o[0]), _mm_mul_pd(m1, o[1])),
+                   _mm_mul_pd(m2, o[2])),
+        _mm_loadu_pd(m[3] + i));
+    sd[row] =
+        _mm_add_pd(_mm_add_pd(_mm_mul_pd(m0, d[0]), _mm_mul_pd(m1, d[1])),
+                   _mm_mul_pd(m2, d[2]));
+  }
+  const auto dot = [](const __m128d* u, const __m128d* v) {
+    return _mm_add_pd(
+        _mm_add_pd(_mm_mul_pd(u[0], v[0]), _mm_mul_pd(u[1], v[1])),
+        _mm_mul_pd(u[2], v[2]));
+  };
+  const __m128d a = dot(sd, sd);
+  const __m128d b = _mm_mul_pd(_mm_set1_pd(2), dot(sd, so));
+  const __m128d c = _mm_sub_pd(dot(so, so), _mm_set1_pd(1));
+  const __m128d discriminant = _mm_sub_pd(
+      _mm_mul_pd(b, b), _mm_mul_pd(_mm_mul_pd(_mm_set1_pd(4), a), c));
+  const __m128d tangent = _mm_cmplt_pd(_mm_andnot_pd(signBit, discriminant),
+                                       _mm_set1_pd(1e-4));
+  const __m128d real = _mm_or_pd(tangent, _mm_cmpge_pd(discriminant, zero));
+  const __m128d sqrtD =
+      _mm_andnot_pd(tangent, _mm_sqrt_pd(_mm_max_pd(discriminant, zero)));
+  const __m128d denominator = _mm_div_pd(_mm_set1_pd(1), _mm_add_pd(a, a));
+  const __m128d negB = _mm_xor_pd(b, signBit);
+  const __m128d r1 = _mm_mul_pd(_mm_sub_pd(negB, sqrtD), denominator);
+  const __m128d r2 = _mm_mul_pd(_mm_add_pd(negB, sqrtD), denominator);
+  const __m128d in1 =
+      _mm_and_pd(_mm_cmple_pd(vMin, r1), _mm_cmple_pd(r1, vMax));
+  const __m128d in2 =
+      _mm_and_pd(_mm_cmple_pd(vMin, r2), _mm_cmple_pd(r2, vMax));
+  root = Select(in1, r1, r2);
+  return _mm_and_pd(real, _mm_or_pd(in1, in2));
+}
+}  // namespace Detail
+
+/* Two spheres per register, the sphere index of a lane kept as a double */
+inline std::size_t NearestSphereRoot(const double* const* inverse,
+                                     std::size_t count, const double* origin,
+                                     const double* direction, double tMin,
+                                     double tMax, double* tNearest) noexcept {
+  const __m128d o[3] = {_mm_set1_pd(origin[0]), _mm_set1_pd(origin[1]),
+                        _mm_set1_pd(origin[2])};
+  const __m128d d[3] = {_mm_set1_pd(direction[0]), _mm_set1_pd(direction[1]),
+                        _mm_set1_pd(direction[2])};
+  const __m128d vMin = _mm_set1_pd(tMin);
+  __m128d best = _mm_set1_pd(tMax);
+  __m128d bestIndex = _mm_set1_pd(-1);
+  __m128d laneIndex = _mm_set_pd(1, 0);
+  std::size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m128d root;
+    const __m128d hit = Detail::SphereRoots(inverse, i, o, d, vMin, best, root);
+    best = Detail::Select(hit, root, best);
+    bestIndex = Detail::Select(hit, laneIndex, bestIndex);
+    laneIndex = _mm_add_pd(laneIndex, _mm_set1_pd(2));
+  }
+  double lanes[2];
+  double indices[2];
+  _mm_storeu_pd(lanes, best);
+  _mm_storeu_pd(indices, bestIndex);
+  return Detail::ReduceSphereLanes(lanes, indices, inverse, i, count, origin,
+                                   direction, tMin, tMax, tNearest);
+}
+
+inline bool AnySphereHit(const double* const* inverse, std::size_t count,
+                         const double* origin, const double* direction,
+                         double tMin, double tMax) noexcept {
+  const __m128d o[3] = {_mm_set1_pd(origin[0]), _mm_set1_pd(origin[1]),
+                        _mm_set1_pd(origin[2])};
+  const __m128d d[3] = {_mm_set1_pd(direction[0]), _mm_set1_pd(direction[1]),
+                        _mm_set1_pd(direction[2])};
+  const __m128d vMin = _mm_set1_pd(tMin);
+  const __m128d vMax = _mm_set1_pd(tMax);
+  std::size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m128d root;
+    if (_mm_movemask_pd(
+            Detail::SphereRoots(inverse, i, o, d, vMin, vMax, root)) != 0)
+      return true;
+  }
+  return Scalar::HitsAnySphere(inverse, i, count, origin, direction, tMin,
+                               tMax);
+}
+#endif
+
+#if defined(RAYTRACER_SIMD) && defined(__AVX__)
+namespace Detail {
+/* Same as the double version above for eight float spheres */
+inline __m256 SphereRoots(const float* const* inverse, std::size_t i,
+                          const __m256 (&o)[3], const __m256 (&d)[3],
+                          __m256 vMin, __m256 vMax, __m256& root) noexcept {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 signBit = _mm256_set1_ps(-0.0f);
+  __m256 so[3];
+  __m256 sd[3];
+  for (std::size_t row = 0; row < 3; ++row) {
+    const float* const* m = inverse + row * 4;
+    const __m256 m0 = _mm256_loadu_ps(m[0] + i);
+    const __m256 m1 = _mm256_loadu_ps(m[1] + i);
+    const __m256 m2 = _mm256_loadu_ps(m[2] + i);
+    so[row] = _mm256_add_ps(
+        _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, o[0]),
+                                    _mm256_mul_ps(m1, o[1])),
+                      _mm256_mul_ps(m2, o[2])),
+        _mm256_loadu_ps(m[3] + i));
+    sd[row] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, d[0]),
+                                          _mm256_mul_ps(m1, d[1])),
+                            _mm256_mul_ps(m2, d[2]));
+  }
+  const auto dot = [](const __m256* u, const __m256* v) {
+    return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(u[0], v[0]),
+                                       _mm256_mul_ps(u[1], v[1])),
+                         _mm256_mul_ps(u[2], v[2]));
+  };
+  const __m256 a = dot(sd, sd);
+  const __m256 b = _mm256_mul_ps(_mm256_set1_ps(2), dot(sd, so));
+  const __m256 c = _mm256_sub_ps(dot(so, so), _mm256_set1_ps(1));
+  const __m256 discriminant =
+      _mm256_sub_ps(_mm256_mul_ps(b, b),
+                    _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(4), a), c));
+  const __m256 tangent =
+      _mm256_cmp_ps(_mm256_andnot_ps(signBit, discriminant),
+                    _mm256_set1_ps(1e-4f), _CMP_LT_OQ);
+  const __m256 real =
+      _mm256_or_ps(tangent, _mm256_cmp_ps(discriminant, zero, _CMP_GE_OQ));
+  const __m256 sqrtD = _mm256_andnot_ps(
+      tangent, _mm256_sqrt_ps(_mm256_max_ps(discriminant, zero)));
+  const __m256 denominator =
+      _mm256_div_ps(_mm256_set1_ps(1), _mm256_add_ps(a, a));
+  const __m256 negB = _mm256_xor_ps(b, signBit);
+  const __m256 r1 = _mm256_mul_ps(_mm256_sub_ps(negB, sqrtD), denominator);
+  const __m256 r2 = _mm256_mul_ps(_mm256_add_ps(negB, sqrtD), denominator);
+  const __m256 in1 = _mm256_and_ps(_mm256_cmp_ps(vMin, r1, _CMP_LE_OQ),
+                                   _mm256_cmp_ps(r1, vMax, _CMP_LE_OQ));
+  const __m256 in2 = _mm256_and_ps(_mm256_cmp_ps(vMin, r2, _CMP_LE_OQ),
+                                   _mm256_cmp_ps(r2, vMax, _CMP_LE_OQ));
+  root = _mm256_blendv_ps(r2, r1, in1);
+  return _mm256_and_ps(real, _mm256_or_ps(in1, in2));
+}
+}  // namespace Detail
+
+/*
+ * Eight float spheres per register. A lane keeps the index of the first
+ * sphere of the register it last hit in, as an integer since a float only
+ * holds integers exactly up to 2^24, and its own offset is added back at
+ * the end: AVX has no 256-bit integer add to step per-lane indices.
+ */
+inline std::size_t NearestSphereRoot(const float* const* inverse,
+                                     std::size_t count, const float* origin,
+                                     const float* direction, float tMin,
+                                     float tMax, float* tNearest) noexcept {
+  const __m256 o[3] = {_mm256_set1_ps(origin[0]), _mm256_set1_ps(origin[1]),
+                       _mm256_set1_ps(origin[2])};
+  const __m256 d[3] = {_mm256_set1_ps(direction[0]),
+                       _mm256_set1_ps(direction[1]),
+                       _mm256_set1_ps(direction[2])};
+  const __m256 vMin = _mm256_set1_ps(tMin);
+  __m256 best = _mm256_set1_ps(tMax);
+  __m256 bestBase = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 root;
+    const __m256 hit = Detail::SphereRoots(inverse, i, o, d, vMin, best, root);
+    best = _mm256_blendv_ps(best, root, hit);
+    bestBase = _mm256_blendv_ps(
+        bestBase,
+        _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<std::int32_t>(i))),
+        hit);
+  }
+  float lanes[8];
+  std::int32_t indices[8];
+  _mm256_storeu_ps(lanes, best);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(indices),
+                      _mm256_castps_si256(bestBase));
+  for (std::int32_t lane = 0; lane < 8; ++lane) {
+    if (indices[lane] >= 0)
+      indices[lane] += lane;
+  }
+  return Detail::ReduceSphereLanes(lanes, indices, inverse, i, count, origin,
+                                   direction, tMin, tMax, tNearest);
+}
+
+inline bool AnySphereHit(const float* const* inverse, std::size_t count,
+                         const float* origin, const float* direction,
+                         float tMin, float tMax) noexcept {
+  const __m256 o[3] = {_mm256_set1_ps(origin[0]), _mm256_set1_ps(origin[1]),
+                       _mm256_set1_ps(origin[2])};
+  const __m256 d[3] = {_mm256_set1_ps(direction[0]),
+                       _mm256_set1_ps(direction[1]),
+                       _mm256_set1_ps(direction[2])};
+  const __m256 vMin = _mm256_set1_ps(tMin);
+  const __m256 vMax = _mm256_set1_ps(tMax);
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 root;
+    if (_mm256_movemask_ps(
+            Detail::SphereRoots(inverse, i, o, d, vMin, vMax, root)) != 0)
+      return true;
+  }
+  return Scalar::HitsAnySphere(inverse, i, count, origin, direction, tMin,
+                               tMax);
+}
+
+#elif defined(RAYTRACER_SIMD)
+namespace Detail {
+/* `ifTrue` where `mask` is set, `otherwise` elsewhere */
+inline __m128 Select(__m128 mask, __m128 ifTrue, __m128 otherwise) noexcept {
+  return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, otherwise));
+}
+
+/* Same as the double version above for four float spheres */
+inline __m128 SphereRoots(const float* const* inverse, std::size_t i,
+                          const __m128 (&o)[3], const __m128 (&d)[3],
+                          __m128 vMin, __m128 vMax, __m128& root) noexcept {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 signBit = _mm_set1_ps(-0.0f);
+  __m128 so[3];
+  __m128 sd[3];
+  for (std::size_t row = 0; row < 3; ++row) {
+    const float* const* m = inverse + row * 4;
+    const __m128 m0 = _mm_loadu_ps(m[0] + i);
+    const __m128 m1 = _mm_loadu_ps(m[1] + i);
+    const __m128 m2 = _mm_loadu_ps(m[2] + i);
+    so[row] = _mm_add_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, o[0]), _mm_mul_ps(m1, o[1])),
+                   _mm_mul_ps(m2, o[2])),
+        _mm_loadu_ps(m[3] + i));
+    sd[row] =
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, d[0]), _mm_mul_ps(m1, d[1])),
+                   _mm_mul_ps(m2, d[2]));
+  }
+  const auto dot = [](const __m128* u, const __m128* v) {
+    return _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(u[0], v[0]), _mm_mul_ps(u[1], v[1])),
+        _mm_mul_ps(u[2], v[2]));
+  };
+  const __m128 a = dot(sd, sd);
+  const __m128 b = _mm_mul_ps(_mm_set1_ps(2), dot(sd, so));
+  const __m128 c = _mm_sub_ps(dot(so, so), _mm_set1_ps(1));
+  const __m128 discriminant = _mm_sub_ps(
+      _mm_mul_ps(b, b), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(4), a), c));
+  const __m128 tangent = _mm_cmplt_ps(_mm_andnot_ps(signBit, discriminant),
+                                      _mm_set1_ps(1e-4f));
+  const __m128 real = _mm_or_ps(tangent, _mm_cmpge_ps(discriminant, zero));
+  const __m128 sqrtD =
+      _mm_andnot_ps(tangent, _mm_sqrt_ps(_mm_max_ps(discriminant, zero)));
+  const __m128 denominator = _mm_div_ps(_mm_set1_ps(1), _mm_add_ps(a, a));
+  const __m128 negB = _mm_xor_ps(b, signBit);
+  const __m128 r1 = _mm_mul_ps(_mm_sub_ps(negB, sqrtD), denominator);
+  const __m128 r2 = _mm_mul_ps(_mm_add_ps(negB, sqrtD), denominator);
+  const __m128 in1 =
+      _mm_and_ps(_mm_cmple_ps(vMin, r1), _mm_cmple_ps(r1, vMax));
+  const __m128 in2 =
+      _mm_and_ps(_mm_cmple_ps(vMin, r2), _mm_cmple_ps(r2, vMax));
+  root = Select(in1, r1, r2);
+  return _mm_and_ps(real, _mm_or_ps(in1, in2));
+}
+}  // namespace Detail
+
+/*
+ * Four float spheres per SSE register. The sphere index of a lane is kept
+ * as an integer, a float only holds integers exactly up to 2^24.
+ */
+inline std::size_t NearestSphereRoot(const float* const* inverse,
+                                     std::size_t count, const float* origin,
+                                     const float* direction, float tMin,
+                                     float tMax, float* tNearest) noexcept {
+  const __m128 o[3] = {_mm_set1_ps(origin[0]), _mm_set1_ps(origin[1]),
+                       _mm_set1_ps(origin[2])};
+  const __m128 d[3] = {_mm_set1_ps(direction[0]), _mm_set1_ps(direction[1]),
+                       _mm_set1_ps(direction[2])};
+  const __m128 vMin = _mm_set1_ps(tMin);
+  __m128 best = _mm_set1_ps(tMax);
+  __m128 bestIndex = _mm_castsi128_ps(_mm_set1_epi32(-1));
+  __m128i laneIndex = _mm_set_epi32(3, 2, 1, 0);
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 root;
+    const __m128 hit = Detail::SphereRoots(inverse, i, o, d, vMin, best, root);
+    best = Detail::Select(hit, root, best);
+    bestIndex = Detail::Select(hit, _mm_castsi128_ps(laneIndex), bestIndex);
+    laneIndex = _mm_add_epi32(laneIndex, _mm_set1_epi32(4));
+  }
+  float lanes[4];
+  std::int32_t indices[4];
+  _mm_storeu_ps(lanes, best);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(indices),
+                   _mm_castps_si128(bestIndex));
+  return Detail::ReduceSphereLanes(lanes, indices, inverse, i, count, origin,
+                                   direction, tMin, tMax, tNearest);
+}
+
+inline bool AnySphereHit(const float* const* inverse, std::size_t count,
+                         const float* origin, const float* direction,
+                         float tMin, float tMax) noexcept {
+  const __m128 o[3] = {_mm_set1_ps(origin[0]), _mm_set1_ps(origin[1]),
+                       _mm_set1_ps(origin[2])};
+  const __m128 d[3] = {_mm_set1_ps(direction[0]), _mm_set1_ps(direction[1]),
+                       _mm_set1_ps(direction[2])};
+  const __m128 vMin = _mm_set1_ps(tMin);
+  const __m128 vMax = _mm_set1_ps(tMax);
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 root;
+    if (_mm_movemask_ps(
+            Detail::SphereRoots(inverse, i, o, d, vMin, vMax, root)) != 0)
+      return true;
+  }
+  return Scalar::HitsAnySphere(inverse, i, count, origin, direction, tMin,
+                               tMax);
+}
+#endif
+
+}  // namespace SimdUtils
+}  // namespace RayTracer
+
+#endif
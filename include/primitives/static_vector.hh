@@ -3,6 +3,8 @@
 #include <array>
 #include <cassert>
 #include <concepts>
+#include <stdexcept>
+#include <utils/checks.hh>
 namespace RayTracer {
 
 template <typename T, std::size_t Size>
@@ -68,12 +70,20 @@ class StaticVector : protected std::array<T, Size> {
     return data()[pos];
   }
 
-  constexpr void push_back(value_type value) noexcept {
+  /* Past the capacity, throws when `Checks::Enabled` (terminating a noexcept
+   * caller), is undefined behaviour otherwise */
+  constexpr void push_back(value_type value) noexcept(!Checks::Enabled) {
+    if constexpr (Checks::Enabled) {
+      if (m_size == Size)
+        throw std::length_error("push_back on a full static vector");
+    }
     data()[m_size++] = std::move(value);
   }
 
   constexpr void pop_back() noexcept { --m_size; }
 
+  constexpr void clear() noexcept { m_size = 0; }
+
   [[nodiscard]] constexpr const value_type& back() const noexcept {
     return data()[m_size - 1];
   }
@@ -2,8 +2,16 @@
 #define VEC_HH
 #include <algorithm>
 #include <array>
+#include <ostream>
 #include <primitive_traits.hh>
+#include <primitives/simd.hh>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <utils/checks.hh>
 #include <utils/math.hh>
+#include <utils/real.hh>
 namespace RayTracer {
 
 struct TupleConstants {
@@ -12,8 +20,8 @@ struct TupleConstants {
   constexpr static int z = 2;
   constexpr static int w = 3;
   /** Here we follow the instructions in the book to regard flag=1 as points and flag=0 as vector */
-  constexpr static double PointFlag = 1;
-  constexpr static double VectorFlag = 0;
+  constexpr static Real PointFlag = 1;
+  constexpr static Real VectorFlag = 0;
 };
 
 struct ColourConstants {
@@ -32,15 +40,17 @@ class Vec final {
   static constexpr std::size_t size() { return Length; }
 
   constexpr T& operator[](std::size_t index) {
-    if (index >= Length) {
-      throw std::out_of_range("out of range vector access");
+    if constexpr (Checks::Enabled) {
+      if (index >= Length)
+        throw std::out_of_range("out of range vector access");
     }
     return contents[index];
   }
 
   constexpr const T& operator[](std::size_t index) const {
-    if (index >= Length) {
-      throw std::out_of_range("out of range vector access");
+    if constexpr (Checks::Enabled) {
+      if (index >= Length)
+        throw std::out_of_range("out of range vector access");
     }
     return contents[index];
   }
@@ -57,7 +67,7 @@ class Vec final {
     return MathUtils::ConstExprSqrtf(DotProduct(*this));
   }
 
-  constexpr Vec Normalize() const noexcept { return Vec{*this / Magnitude()}; }
+  constexpr Vec Normalize() const noexcept { return *this / Magnitude(); }
 
   constexpr Vec CrossProduct(const Vec& rhs) const noexcept {
     static_assert(Length == 4,
@@ -71,7 +81,7 @@ class Vec final {
   }
 
   constexpr Vec Reflect(const Vec& normal) const noexcept {
-    return (*this) - normal * 2.0 * DotProduct(normal);
+    return (*this) - normal * T(2) * DotProduct(normal);
   }
 
   friend std::ostream& operator<<(std::ostream& stream,
@@ -156,135 +166,506 @@ constexpr decltype(auto) Generate(Func&& func) {
   return ElementWise(func, SeqVec<N, std::size_t>());
 }
 
+/* Elementwise minimum of two vectors */
+template <typename T, std::size_t N>
+constexpr Vec<T, N> Min(const Vec<T, N>& a, const Vec<T, N>& b) noexcept {
+  return ElementWise([](T x, T y) { return x < y ? x : y; }, a, b);
+}
+
+/* Elementwise maximum of two vectors */
+template <typename T, std::size_t N>
+constexpr Vec<T, N> Max(const Vec<T, N>& a, const Vec<T, N>& b) noexcept {
+  return ElementWise([](T x, T y) { return x > y ? x : y; }, a, b);
+}
+
 }  // namespace VecUtils
 
-/* Negate vector */
+/*
+-------------------------------------------------------------------------------
+Expression templates
+
+Arithmetic on vectors does not compute anything by itself: it returns a lazy
+`VecUtils::Expr` node over its operands, and the whole expression tree is
+evaluated in a single fused pass once it is converted to a `Vec` (assigned to
+a Vec, returned as one or bound to a `const Vec&` parameter). An expression
+such as `point + normal * EPSILON` therefore writes its result once instead
+of building a temporary per operator, which also cuts the number of constexpr
+evaluation steps of a compile-time render.
+
+Operands are stored by value, so a node never dangles and `constexpr auto e =
+a + b;` remains a constant expression. At run time, a Tuple tree is computed
+on the register kernels of simd.hh, each node combining the registers of its
+operands, and stored once at its root; a Colour node over two Colours uses
+its SIMD kernel, and deeper Colour trees the fused lane loop.
+
+Lane w of a Tuple (4 x Real) result is not computed but taken from the vector
+operand (the left one for vector-vector operators), so arithmetic keeps the
+point/vector flag of the book's convention.
+-------------------------------------------------------------------------------
+*/
+namespace VecUtils {
+
+template <typename T>
+struct IsVec : std::false_type {};
 
-/** Numerical negative, element-wise. */
 template <typename T, std::size_t N>
-constexpr Vec<T, N> operator-(const Vec<T, N>& vec) noexcept {
-  return VecUtils::ElementWise([](T x) { return -1.0 * x; }, vec);
-}
+struct IsVec<Vec<T, N>> : std::true_type {};
 
-/* Operator overloading for `+`/`+=`*/
+/* Lazy expression node */
+template <typename E>
+concept LazyVec = PrimitiveTraits::RemoveCVR<E>::IsVecExpr;
+
+/* Anything that reads like a vector, a Vec or a lazy expression of one */
+template <typename E>
+concept VecExpression =
+    IsVec<PrimitiveTraits::RemoveCVR<E>>::value || LazyVec<E>;
+
+template <typename A, typename B>
+concept SameShape =
+    std::is_same_v<typename A::ValueType, typename B::ValueType> &&
+    A::Length == B::Length;
+
+/* Tuple results keep lane w of their vector operand */
 template <typename T, std::size_t N>
-constexpr Vec<T, N> operator+(const Vec<T, N>& vec, T scalar) noexcept {
-  return VecUtils::ElementWise([scalar](T x) { return x + scalar; }, vec);
+constexpr bool KeepsW = (N == 4 && std::is_same_v<T, Real>);
+
+/* A scalar operand, seen as a vector holding `value` in every lane */
+template <typename T>
+struct Broadcast {
+  T value;
+};
+
+/* Lane `index` of an operand, unchecked since nodes are always full width */
+template <typename E>
+constexpr auto Lane(const E& operand, std::size_t index) noexcept {
+  if constexpr (LazyVec<E>)
+    return operand[index];
+  else if constexpr (VecExpression<E>)
+    return operand.contents[index];
+  else
+    return operand.value;
+}
+
+/* The Vec itself, or the evaluated result of a lazy expression */
+template <VecExpression E>
+constexpr decltype(auto) Evaluate(const E& expr) noexcept {
+  if constexpr (LazyVec<E>)
+    return expr.Eval();
+  else
+    return (expr);
+}
+
+/* What the SIMD kernels get for a leaf operand: vector or scalar */
+template <typename E>
+constexpr decltype(auto) KernelOperand(const E& operand) noexcept {
+  if constexpr (VecExpression<E>)
+    return (operand);
+  else
+    return (operand.value);
+}
+
+/* The Vec leaf of an operand that its lane w comes from */
+template <VecExpression E>
+constexpr const auto& KeptWOf(const E& operand) noexcept {
+  if constexpr (LazyVec<E>)
+    return operand.KeptW();
+  else
+    return operand;
+}
+
+/* The registers of a Tuple operand, a sub-tree being computed in place */
+template <typename E>
+inline auto PackOf(const E& operand) noexcept {
+  if constexpr (LazyVec<E>)
+    return operand.Pack();
+  else if constexpr (VecExpression<E>)
+    return SimdUtils::Load4(operand.contents.data());
+  else
+    return SimdUtils::Set4(operand.value);
 }
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N> operator+(T scalar, const Vec<T, N>& vec) noexcept {
-  return VecUtils::ElementWise([scalar](T x) { return scalar + x; }, vec);
+/*
+  Operations of the expression nodes: the lane-wise `Apply` used at compile
+  time, `Packed` on the registers of a Tuple tree, and `Kernel` overloads for
+  the Colour shapes that have a SIMD kernel (the lane loop is used for
+  everything else).
+*/
+struct Plus {
+  template <typename T>
+  static constexpr T Apply(T a, T b) noexcept {
+    return a + b;
+  }
+  template <typename P>
+  static P Packed(const P& a, const P& b) noexcept {
+    return SimdUtils::Add4(a, b);
+  }
+  static void Kernel(const Vec<Real, 3>& a, const Vec<Real, 3>& b,
+                     Vec<Real, 3>& out) noexcept {
+    SimdUtils::Add3(a.contents.data(), b.contents.data(), out.contents.data());
+  }
+};
+
+struct Minus {
+  template <typename T>
+  static constexpr T Apply(T a, T b) noexcept {
+    return a - b;
+  }
+  template <typename P>
+  static P Packed(const P& a, const P& b) noexcept {
+    return SimdUtils::Sub4(a, b);
+  }
+  static void Kernel(const Vec<Real, 3>& a, const Vec<Real, 3>& b,
+                     Vec<Real, 3>& out) noexcept {
+    SimdUtils::Sub3(a.contents.data(), b.contents.data(), out.contents.data());
+  }
+};
+
+struct Multiplies {
+  template <typename T>
+  static constexpr T Apply(T a, T b) noexcept {
+    return a * b;
+  }
+  template <typename P>
+  static P Packed(const P& a, const P& b) noexcept {
+    return SimdUtils::Mul4(a, b);
+  }
+  static void Kernel(const Vec<Real, 3>& a, const Vec<Real, 3>& b,
+                     Vec<Real, 3>& out) noexcept {
+    SimdUtils::Mul3(a.contents.data(), b.contents.data(), out.contents.data());
+  }
+  static void Kernel(const Vec<Real, 3>& a, Real b,
+                     Vec<Real, 3>& out) noexcept {
+    SimdUtils::Scale3(a.contents.data(), b, out.contents.data());
+  }
+  static void Kernel(Real a, const Vec<Real, 3>& b,
+                     Vec<Real, 3>& out) noexcept {
+    SimdUtils::Scale3(b.contents.data(), a, out.contents.data());
+  }
+};
+
+struct Divides {
+  template <typename T>
+  static constexpr T Apply(T a, T b) noexcept {
+    return a / b;
+  }
+  template <typename P>
+  static P Packed(const P& a, const P& b) noexcept {
+    return SimdUtils::Div4(a, b);
+  }
+};
+
+struct Negate {
+  template <typename T>
+  static constexpr T Apply(T a) noexcept {
+    return -a;
+  }
+  template <typename P>
+  static P Packed(const P& a) noexcept {
+    return SimdUtils::Neg4(a);
+  }
+};
+
+/* Shared read-only Vec interface of the expression nodes */
+template <typename Derived, typename T, std::size_t N>
+class ExprBase {
+ public:
+  static constexpr bool IsVecExpr = true;
+  using ValueType = T;
+  static constexpr std::size_t Length = N;
+  using ResultType = Vec<T, N>;
+  static constexpr std::size_t size() { return Length; }
+
+  constexpr operator ResultType() const noexcept { return Self().Eval(); }
+
+  constexpr T DotProduct(const ResultType& rhs) const noexcept {
+    return Self().Eval().DotProduct(rhs);
+  }
+
+  constexpr T Magnitude() const noexcept { return Self().Eval().Magnitude(); }
+
+  constexpr ResultType Normalize() const noexcept {
+    return Self().Eval().Normalize();
+  }
+
+  constexpr ResultType CrossProduct(const ResultType& rhs) const noexcept {
+    return Self().Eval().CrossProduct(rhs);
+  }
+
+  constexpr ResultType Reflect(const ResultType& normal) const noexcept {
+    return Self().Eval().Reflect(normal);
+  }
+
+  friend std::ostream& operator<<(std::ostream& stream,
+                                  const ExprBase& expr) noexcept {
+    return stream << expr.Self().Eval();
+  }
+
+ protected:
+  /* One pass over the lanes of the whole expression tree */
+  constexpr ResultType FusedEval() const noexcept {
+    return FusedEval(std::make_index_sequence<N>{});
+  }
+
+  /*
+   * The whole Tuple tree in registers at run time, stored once, with lane w
+   * taken from the vector operand like in `operator[]`.
+   */
+  ResultType PackedEval() const noexcept {
+    ResultType ret;
+    SimdUtils::StoreXYZ(Self().Pack(),
+                        SimdUtils::Load4(Self().KeptW().contents.data()),
+                        ret.contents.data());
+    return ret;
+  }
+
+ private:
+  template <std::size_t... I>
+  constexpr ResultType FusedEval(std::index_sequence<I...>) const noexcept {
+    return ResultType{Self()[I]...};
+  }
+
+  constexpr const Derived& Self() const noexcept {
+    return static_cast<const Derived&>(*this);
+  }
+};
+
+template <typename L, typename R>
+using VecOperandOf = std::conditional_t<VecExpression<L>, L, R>;
+
+/* Lazy `lhs Op rhs`, one of the operands may be a Broadcast scalar */
+template <typename Op, typename L, typename R>
+class Expr
+    : public ExprBase<Expr<Op, L, R>,
+                      typename VecOperandOf<L, R>::ValueType,
+                      VecOperandOf<L, R>::Length> {
+  using Base = ExprBase<Expr<Op, L, R>, typename VecOperandOf<L, R>::ValueType,
+                        VecOperandOf<L, R>::Length>;
+
+ public:
+  using typename Base::ResultType;
+  using typename Base::ValueType;
+
+  constexpr Expr(const L& lhs_, const R& rhs_) noexcept
+      : lhs{lhs_}, rhs{rhs_} {}
+
+  constexpr ValueType operator[](std::size_t index) const {
+    if constexpr (KeepsW<ValueType, Base::Length>) {
+      if (index == TupleConstants::w) {
+        if constexpr (VecExpression<L>)
+          return Lane(lhs, index);
+        else
+          return Lane(rhs, index);
+      }
+    }
+    return Op::Apply(Lane(lhs, index), Lane(rhs, index));
+  }
+
+  constexpr ResultType Eval() const noexcept {
+    if constexpr (KeepsW<ValueType, Base::Length>) {
+      if (!std::is_constant_evaluated())
+        return this->PackedEval();
+    } else if constexpr (!LazyVec<L> && !LazyVec<R> &&
+                         requires(ResultType & out) {
+                           Op::Kernel(KernelOperand(lhs), KernelOperand(rhs),
+                                      out);
+                         }) {
+      if (!std::is_constant_evaluated()) {
+        ResultType ret;
+        Op::Kernel(KernelOperand(lhs), KernelOperand(rhs), ret);
+        return ret;
+      }
+    }
+    return this->FusedEval();
+  }
+
+  /* This node on the registers of its operands, see `PackOf` */
+  auto Pack() const noexcept { return Op::Packed(PackOf(lhs), PackOf(rhs)); }
+
+  /* The Vec leaf lane w of the result comes from */
+  constexpr const ResultType& KeptW() const noexcept {
+    return KeptWOf(VecOperand());
+  }
+
+ private:
+  constexpr const VecOperandOf<L, R>& VecOperand() const noexcept {
+    if constexpr (VecExpression<L>)
+      return lhs;
+    else
+      return rhs;
+  }
+
+  L lhs;
+  R rhs;
+};
+
+/* Lazy `Op operand` */
+template <typename Op, typename E>
+class UnaryExpr
+    : public ExprBase<UnaryExpr<Op, E>, typename E::ValueType, E::Length> {
+  using Base = ExprBase<UnaryExpr<Op, E>, typename E::ValueType, E::Length>;
+
+ public:
+  using typename Base::ResultType;
+  using typename Base::ValueType;
+
+  constexpr explicit UnaryExpr(const E& operand_) noexcept
+      : operand{operand_} {}
+
+  constexpr ValueType operator[](std::size_t index) const {
+    if constexpr (KeepsW<ValueType, Base::Length>) {
+      if (index == TupleConstants::w)
+        return Lane(operand, index);
+    }
+    return Op::Apply(Lane(operand, index));
+  }
+
+  constexpr ResultType Eval() const noexcept {
+    if constexpr (KeepsW<ValueType, Base::Length>) {
+      if (!std::is_constant_evaluated())
+        return this->PackedEval();
+    }
+    return this->FusedEval();
+  }
+
+  auto Pack() const noexcept { return Op::Packed(PackOf(operand)); }
+
+  constexpr const ResultType& KeptW() const noexcept {
+    return KeptWOf(operand);
+  }
+
+ private:
+  E operand;
+};
+
+template <typename Op, typename L, typename R>
+constexpr auto MakeExpr(const L& lhs, const R& rhs) noexcept {
+  return Expr<Op, L, R>{lhs, rhs};
 }
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N>& operator+=(Vec<T, N>& vec, T scalar) noexcept {
-  for (std::size_t i = 0; i < N; ++i)
-    vec[i] += scalar;
-  return vec;
+template <typename Op, typename L>
+constexpr auto MakeScalarExpr(const L& lhs,
+                              typename L::ValueType scalar) noexcept {
+  using Scalar = Broadcast<typename L::ValueType>;
+  return Expr<Op, L, Scalar>{lhs, Scalar{scalar}};
 }
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N> operator+(const Vec<T, N>& vecA,
-                              const Vec<T, N>& vecB) noexcept {
-  return VecUtils::ElementWise(std::plus<T>(), vecA, vecB);
+template <typename Op, typename R>
+constexpr auto MakeScalarExpr(typename R::ValueType scalar,
+                              const R& rhs) noexcept {
+  using Scalar = Broadcast<typename R::ValueType>;
+  return Expr<Op, Scalar, R>{Scalar{scalar}, rhs};
 }
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N>& operator+=(Vec<T, N>& vecA,
-                                const Vec<T, N>& vecB) noexcept {
-  for (std::size_t i = 0; i < N; ++i)
-    vecA[i] += vecB[i];
-  return vecA;
+}  // namespace VecUtils
+
+/* Equality against a lazy expression compares its evaluated result */
+template <VecUtils::VecExpression A, VecUtils::VecExpression B>
+requires(VecUtils::LazyVec<A> || VecUtils::LazyVec<B>) &&
+    VecUtils::SameShape<A, B>
+constexpr bool operator==(const A& exprA, const B& exprB) noexcept {
+  return VecUtils::Evaluate(exprA) == VecUtils::Evaluate(exprB);
 }
 
-/* Operator overloading for - / -=*/
+template <VecUtils::VecExpression A, VecUtils::VecExpression B>
+requires(VecUtils::LazyVec<A> || VecUtils::LazyVec<B>) &&
+    VecUtils::SameShape<A, B>
+constexpr bool operator!=(const A& exprA, const B& exprB) noexcept {
+  return !(exprA == exprB);
+}
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N> operator-(const Vec<T, N>& vec, T scalar) noexcept {
-  return VecUtils::ElementWise([scalar](T x) { return x - scalar; }, vec);
+/** Numerical negative, element-wise. */
+template <VecUtils::VecExpression E>
+constexpr auto operator-(const E& expr) noexcept {
+  return VecUtils::UnaryExpr<VecUtils::Negate, E>{expr};
 }
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N>& operator-=(Vec<T, N>& vec, T scalar) noexcept {
-  for (std::size_t i = 0; i < N; ++i)
-    vec[i] -= scalar;
-  return vec;
+/* Operator overloading for `+`/`+=`*/
+template <VecUtils::VecExpression E>
+constexpr auto operator+(const E& expr,
+                         typename E::ValueType scalar) noexcept {
+  return VecUtils::MakeScalarExpr<VecUtils::Plus>(expr, scalar);
 }
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N> operator-(const Vec<T, N>& vecA,
-                              const Vec<T, N>& vecB) noexcept {
-  return VecUtils::ElementWise(std::minus<T>(), vecA, vecB);
+template <VecUtils::VecExpression E>
+constexpr auto operator+(typename E::ValueType scalar,
+                         const E& expr) noexcept {
+  return VecUtils::MakeScalarExpr<VecUtils::Plus>(scalar, expr);
 }
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N>& operator-=(Vec<T, N>& vecA,
-                                const Vec<T, N>& vecB) noexcept {
-  for (std::size_t i = 0; i < N; ++i)
-    vecA[i] -= vecB[i];
-  return vecA;
+template <VecUtils::VecExpression L, VecUtils::VecExpression R>
+requires VecUtils::SameShape<L, R> constexpr auto operator+(
+    const L& lhs, const R& rhs) noexcept {
+  return VecUtils::MakeExpr<VecUtils::Plus>(lhs, rhs);
 }
 
-/* Operator overloading for `*` / `*=` */
+/* Operator overloading for `-`/`-=`*/
+template <VecUtils::VecExpression E>
+constexpr auto operator-(const E& expr,
+                         typename E::ValueType scalar) noexcept {
+  return VecUtils::MakeScalarExpr<VecUtils::Minus>(expr, scalar);
+}
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N> operator*(const Vec<T, N>& vec, T scalar) noexcept {
-  return VecUtils::ElementWise([scalar](T x) { return x * scalar; }, vec);
+template <VecUtils::VecExpression L, VecUtils::VecExpression R>
+requires VecUtils::SameShape<L, R> constexpr auto operator-(
+    const L& lhs, const R& rhs) noexcept {
+  return VecUtils::MakeExpr<VecUtils::Minus>(lhs, rhs);
 }
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N> operator*(T scalar, const Vec<T, N>& vec) noexcept {
-  return VecUtils::ElementWise([scalar](T x) { return scalar * x; }, vec);
+/* Operator overloading for `*`/`*=`*/
+template <VecUtils::VecExpression E>
+constexpr auto operator*(const E& expr,
+                         typename E::ValueType scalar) noexcept {
+  return VecUtils::MakeScalarExpr<VecUtils::Multiplies>(expr, scalar);
 }
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N>& operator*=(Vec<T, N>& vec, T scalar) noexcept {
-  for (std::size_t i = 0; i < N; ++i)
-    vec[i] *= scalar;
-  return vec;
+template <VecUtils::VecExpression E>
+constexpr auto operator*(typename E::ValueType scalar,
+                         const E& expr) noexcept {
+  return VecUtils::MakeScalarExpr<VecUtils::Multiplies>(scalar, expr);
 }
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N> operator*(const Vec<T, N>& vecA,
-                              const Vec<T, N>& vecB) noexcept {
-  return VecUtils::ElementWise(std::multiplies<T>(), vecA, vecB);
+template <VecUtils::VecExpression L, VecUtils::VecExpression R>
+requires VecUtils::SameShape<L, R> constexpr auto operator*(
+    const L& lhs, const R& rhs) noexcept {
+  return VecUtils::MakeExpr<VecUtils::Multiplies>(lhs, rhs);
 }
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N>& operator*=(Vec<T, N>& vecA,
-                                const Vec<T, N>& vecB) noexcept {
-  for (std::size_t i = 0; i < N; ++i)
-    vecA[i] *= vecB[i];
-  return vecA;
+/* Operator overloading for `/`/`/=`*/
+template <VecUtils::VecExpression E>
+constexpr auto operator/(const E& expr,
+                         typename E::ValueType scalar) noexcept {
+  return VecUtils::MakeScalarExpr<VecUtils::Divides>(expr, scalar);
 }
 
-/* Operator overloading for / and /= */
+template <VecUtils::VecExpression L, VecUtils::VecExpression R>
+requires VecUtils::SameShape<L, R> constexpr auto operator/(
+    const L& lhs, const R& rhs) noexcept {
+  return VecUtils::MakeExpr<VecUtils::Divides>(lhs, rhs);
+}
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N> operator/(const Vec<T, N>& vec, T scalar) noexcept {
-  return VecUtils::ElementWise([scalar](T x) { return x / scalar; }, vec);
+/* Compound assignment evaluates the expression straight into the vector */
+template <typename T, std::size_t N, typename E>
+requires VecUtils::VecExpression<E> || std::convertible_to<E, T>
+constexpr Vec<T, N>& operator+=(Vec<T, N>& vec, const E& rhs) noexcept {
+  return vec = vec + rhs;
 }
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N>& operator/=(Vec<T, N>& vec, T scalar) noexcept {
-  for (std::size_t i = 0; i < N; ++i)
-    vec[i] /= scalar;
-  return vec;
+template <typename T, std::size_t N, typename E>
+requires VecUtils::VecExpression<E> || std::convertible_to<E, T>
+constexpr Vec<T, N>& operator-=(Vec<T, N>& vec, const E& rhs) noexcept {
+  return vec = vec - rhs;
 }
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N> operator/(const Vec<T, N>& vecA,
-                              const Vec<T, N>& vecB) noexcept {
-  return VecUtils::ElementWise(std::divides<T>(), vecA, vecB);
+template <typename T, std::size_t N, typename E>
+requires VecUtils::VecExpression<E> || std::convertible_to<E, T>
+constexpr Vec<T, N>& operator*=(Vec<T, N>& vec, const E& rhs) noexcept {
+  return vec = vec * rhs;
 }
 
-template <typename T, std::size_t N>
-constexpr Vec<T, N>& operator/=(Vec<T, N>& vecA,
-                                const Vec<T, N>& vecB) noexcept {
-  for (std::size_t i = 0; i < N; ++i)
-    vecA[i] /= vecB[i];
-  return vecA;
+template <typename T, std::size_t N, typename E>
+requires VecUtils::VecExpression<E> || std::convertible_to<E, T>
+constexpr Vec<T, N>& operator/=(Vec<T, N>& vec, const E& rhs) noexcept {
+  return vec = vec / rhs;
 }
 
 /*
@@ -292,16 +673,19 @@ constexpr Vec<T, N>& operator/=(Vec<T, N>& vecA,
 Tuple specialization
 ---------------------
 */
-using Tuple = Vec<double, 4>;
+using Tuple = Vec<Real, 4>;
 
 template <>
-constexpr Tuple& operator*=(Tuple& tuple, const Tuple& rhs) noexcept;
+constexpr Tuple::ValueType Tuple::DotProduct(const Tuple& rhs) const noexcept;
 
 template <>
-constexpr Tuple operator/(const Tuple& tuple, double scalar) noexcept;
+constexpr Tuple Tuple::CrossProduct(const Tuple& rhs) const noexcept;
 
 template <>
-constexpr Tuple::ValueType Tuple::DotProduct(const Tuple& rhs) const noexcept;
+constexpr Tuple Tuple::Normalize() const noexcept;
+
+template <>
+constexpr Tuple Tuple::Reflect(const Tuple& normal) const noexcept;
 
 constexpr bool IsPoint(const Tuple& tuple) {
   return tuple[TupleConstants::w] == TupleConstants::PointFlag;
@@ -311,19 +695,19 @@ constexpr bool IsVector(const Tuple& tuple) {
   return tuple[TupleConstants::w] == TupleConstants::VectorFlag;
 }
 
-constexpr Tuple MakePoint(double dx, double dy, double dz) {
+constexpr Tuple MakePoint(Real dx, Real dy, Real dz) {
   return Tuple{dx, dy, dz, TupleConstants::PointFlag};
 }
 
-constexpr Tuple MakeNormalizedPoint(double dx, double dy, double dz) {
+constexpr Tuple MakeNormalizedPoint(Real dx, Real dy, Real dz) {
   return Tuple{dx, dy, dz, TupleConstants::PointFlag}.Normalize();
 }
 
-constexpr Tuple MakeVector(double dx, double dy, double dz) {
+constexpr Tuple MakeVector(Real dx, Real dy, Real dz) {
   return Tuple{dx, dy, dz, TupleConstants::VectorFlag};
 }
 
-constexpr Tuple MakeNormalizedVector(double dx, double dy, double dz) {
+constexpr Tuple MakeNormalizedVector(Real dx, Real dy, Real dz) {
   return Tuple{dx, dy, dz, TupleConstants::VectorFlag}.Normalize();
 }
 
@@ -354,159 +738,52 @@ constexpr bool operator==(const Tuple& tupleA, const Tuple& tupleB) noexcept {
   // clang-format on
 }
 
-/* Negate Tuple */
-
-/** Numerical negative, element-wise. */
-template <>
-constexpr Tuple operator-(const Tuple& tuple) noexcept {
-  return Tuple{tuple[TupleConstants::x] * -1.0, tuple[TupleConstants::y] * -1.0,
-               tuple[TupleConstants::z] * -1.0, tuple[TupleConstants::w]};
-}
-
-/* Operator overloading Tuple '+' / '+=' */
-
-template <>
-constexpr Tuple operator+(const Tuple& tuple, double scalar) noexcept {
-  return Tuple{tuple[TupleConstants::x] + scalar,
-               tuple[TupleConstants::y] + scalar,
-               tuple[TupleConstants::z] + scalar, tuple[TupleConstants::w]};
-}
-
-template <>
-constexpr Tuple operator+(double scalar, const Tuple& tuple) noexcept {
-  return Tuple{tuple[TupleConstants::x] + scalar,
-               tuple[TupleConstants::y] + scalar,
-               tuple[TupleConstants::z] + scalar, tuple[TupleConstants::w]};
-}
-
-template <>
-constexpr Tuple& operator+=(Tuple& tuple, double scalar) noexcept {
-  for (std::size_t i = 0; i < 3; ++i)
-    tuple[i] += scalar;
-  return tuple;
-}
-
-template <>
-constexpr Tuple operator+(const Tuple& tuple, const Tuple& rhs) noexcept {
-  return Tuple{tuple[TupleConstants::x] + rhs[TupleConstants::x],
-               tuple[TupleConstants::y] + rhs[TupleConstants::y],
-               tuple[TupleConstants::z] + rhs[TupleConstants::z],
-               tuple[TupleConstants::w]};
-}
-
-template <>
-constexpr Tuple& operator+=(Tuple& tuple, const Tuple& rhs) noexcept {
-  for (std::size_t i = 0; i < 3; ++i)
-    tuple[i] += rhs[i];
-  return tuple;
-}
-
-/* Operator overloading Tuple '-' / '-=' */
-
-template <>
-constexpr Tuple operator-(const Tuple& tuple, double scalar) noexcept {
-  return Tuple{tuple[TupleConstants::x] - scalar,
-               tuple[TupleConstants::y] - scalar,
-               tuple[TupleConstants::z] - scalar, tuple[TupleConstants::w]};
-}
-
-template <>
-constexpr Tuple& operator-=(Tuple& tuple, double scalar) noexcept {
-  for (std::size_t i = 0; i < 3; ++i)
-    tuple[i] -= scalar;
-  return tuple;
-}
-
-template <>
-constexpr Tuple operator-(const Tuple& tuple, const Tuple& rhs) noexcept {
-  return Tuple{tuple[TupleConstants::x] - rhs[TupleConstants::x],
-               tuple[TupleConstants::y] - rhs[TupleConstants::y],
-               tuple[TupleConstants::z] - rhs[TupleConstants::z],
-               tuple[TupleConstants::w]};
-}
-
-template <>
-constexpr Tuple& operator-=(Tuple& tuple, const Tuple& rhs) noexcept {
-  for (std::size_t i = 0; i < 3; ++i)
-    tuple[i] -= rhs[i];
-  return tuple;
-}
-
-/* Operator overloading Tuple '*' / '*=' */
-
-template <>
-constexpr Tuple operator*(const Tuple& tuple, double scalar) noexcept {
-  return Tuple{tuple[TupleConstants::x] * scalar,
-               tuple[TupleConstants::y] * scalar,
-               tuple[TupleConstants::z] * scalar, tuple[TupleConstants::w]};
-}
-
-template <>
-constexpr Tuple operator*(double scalar, const Tuple& tuple) noexcept {
-  return Tuple{tuple[TupleConstants::x] * scalar,
-               tuple[TupleConstants::y] * scalar,
-               tuple[TupleConstants::z] * scalar, tuple[TupleConstants::w]};
-}
-
-template <>
-constexpr Tuple& operator*=(Tuple& tuple, double scalar) noexcept {
-  for (std::size_t i = 0; i < 3; ++i)
-    tuple[i] *= scalar;
-  return tuple;
-}
-
-template <>
-constexpr Tuple operator*(const Tuple& tuple, const Tuple& rhs) noexcept {
-  return Tuple{tuple[TupleConstants::x] * rhs[TupleConstants::x],
-               tuple[TupleConstants::y] * rhs[TupleConstants::y],
-               tuple[TupleConstants::z] * rhs[TupleConstants::z],
-               tuple[TupleConstants::w]};
-}
-
 template <>
-constexpr Tuple& operator*=(Tuple& tuple, const Tuple& rhs) noexcept {
-  for (std::size_t i = 0; i < 3; ++i)
-    tuple[i] *= rhs[i];
-  return tuple;
-}
-
-/* Operator overloading Tuple '/' / '/=' */
-template <>
-constexpr Tuple operator/(const Tuple& tuple, double scalar) noexcept {
-  return Tuple{tuple[TupleConstants::x] / scalar,
-               tuple[TupleConstants::y] / scalar,
-               tuple[TupleConstants::z] / scalar, tuple[TupleConstants::w]};
-}
-
-template <>
-constexpr Tuple& operator/=(Tuple& tuple, double scalar) noexcept {
-  for (std::size_t i = 0; i < 3; ++i)
-    tuple[i] /= scalar;
-  return tuple;
+constexpr Tuple::ValueType Tuple::DotProduct(const Tuple& rhs) const noexcept {
+  if (!std::is_constant_evaluated())
+    return SimdUtils::Dot3(contents.data(), rhs.contents.data());
+  ValueType result{};
+  result += ((contents[TupleConstants::x] * rhs[TupleConstants::x]) +
+             (contents[TupleConstants::y] * rhs[TupleConstants::y]) +
+             (contents[TupleConstants::z] * rhs[TupleConstants::z]));
+  return result;
 }
 
 template <>
-constexpr Tuple operator/(const Tuple& tuple, const Tuple& rhs) noexcept {
-  return Tuple{tuple[TupleConstants::x] / rhs[TupleConstants::x],
-               tuple[TupleConstants::y] / rhs[TupleConstants::y],
-               tuple[TupleConstants::z] / rhs[TupleConstants::z],
-               tuple[TupleConstants::w]};
+constexpr Tuple Tuple::CrossProduct(const Tuple& rhs) const noexcept {
+  if (!std::is_constant_evaluated()) {
+    Tuple ret;
+    SimdUtils::Cross3(contents.data(), rhs.contents.data(),
+                      ret.contents.data());
+    return ret;
+  }
+  // clang-format off
+  return Tuple{contents[TupleConstants::y] * rhs[TupleConstants::z] - contents[TupleConstants::z] * rhs[TupleConstants::y],
+               contents[TupleConstants::z] * rhs[TupleConstants::x] - contents[TupleConstants::x] * rhs[TupleConstants::z],
+               contents[TupleConstants::x] * rhs[TupleConstants::y] - contents[TupleConstants::y] * rhs[TupleConstants::x],
+               TupleConstants::VectorFlag};
+  // clang-format on
 }
 
 template <>
-constexpr Tuple& operator/=(Tuple& tuple, const Tuple& rhs) noexcept {
-  for (std::size_t i = 0; i < 3; ++i)
-    tuple[i] /= rhs[i];
-  return tuple;
+constexpr Tuple Tuple::Normalize() const noexcept {
+  if (!std::is_constant_evaluated()) {
+    Tuple ret;
+    SimdUtils::Normalize3(contents.data(), ret.contents.data());
+    return ret;
+  }
+  return *this / Magnitude();
 }
 
 template <>
-constexpr Tuple::ValueType Tuple::DotProduct(const Tuple& rhs) const noexcept {
-  ValueType result{};
-  result += ((contents[TupleConstants::x] * rhs[TupleConstants::x]) +
-             (contents[TupleConstants::y] * rhs[TupleConstants::y]) +
-             (contents[TupleConstants::z] * rhs[TupleConstants::z]));
-  return result;
+constexpr Tuple Tuple::Reflect(const Tuple& normal) const noexcept {
+  if (!std::is_constant_evaluated()) {
+    Tuple ret;
+    SimdUtils::Reflect3(contents.data(), normal.contents.data(),
+                        ret.contents.data());
+    return ret;
+  }
+  return (*this) - normal * Real(2) * DotProduct(normal);
 }
 
 constexpr Tuple ToVector(const Tuple& tuple) {
@@ -527,11 +804,12 @@ struct PredefinedTuples {
   static constexpr Tuple UnitVecY{0, 1, 0, TupleConstants::VectorFlag};
   static constexpr Tuple UnitVecZ{0, 0, 1, TupleConstants::VectorFlag};
   static constexpr Tuple MinPoint{
-      MathUtils::MathConstants::INF<>, MathUtils::MathConstants::INF<>,
-      MathUtils::MathConstants::INF<>, TupleConstants::PointFlag};
+      MathUtils::MathConstants::INF<Real>, MathUtils::MathConstants::INF<Real>,
+      MathUtils::MathConstants::INF<Real>, TupleConstants::PointFlag};
   static constexpr Tuple MaxPoint{
-      MathUtils::MathConstants::NINF<>, MathUtils::MathConstants::NINF<>,
-      MathUtils::MathConstants::NINF<>, TupleConstants::PointFlag};
+      MathUtils::MathConstants::NINF<Real>,
+      MathUtils::MathConstants::NINF<Real>,
+      MathUtils::MathConstants::NINF<Real>, TupleConstants::PointFlag};
 };
 
 /*
@@ -539,7 +817,7 @@ struct PredefinedTuples {
   Colour specialization
   ---------------------
 */
-using Colour = Vec<double, 3>;
+using Colour = Vec<Real, 3>;
 
 constexpr bool IsValidColour(const Colour& colour) {
   return 0 <= colour[ColourConstants::r] && colour[ColourConstants::r] <= 1 &&
@@ -547,14 +825,14 @@ constexpr bool IsValidColour(const Colour& colour) {
          0 <= colour[ColourConstants::b] && colour[ColourConstants::b] <= 1;
 }
 
-constexpr Colour MakeColour(double r, double g, double b) {
+constexpr Colour MakeColour(Real r, Real g, Real b) {
   return Colour{r, g, b};
 }
 
 constexpr Colour ToValidColour(const Colour& colour) {
-  const double r = std::clamp(colour[ColourConstants::r], 0.0, 1.0);
-  const double g = std::clamp(colour[ColourConstants::g], 0.0, 1.0);
-  const double b = std::clamp(colour[ColourConstants::b], 0.0, 1.0);
+  const Real r = std::clamp(colour[ColourConstants::r], Real(0), Real(1));
+  const Real g = std::clamp(colour[ColourConstants::g], Real(0), Real(1));
+  const Real b = std::clamp(colour[ColourConstants::b], Real(0), Real(1));
   return MakeColour(r, g, b);
 }
 
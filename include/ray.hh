@@ -1,25 +1,84 @@
 #ifndef RAY_HH
 #define RAY_HH
+#include <cstdint>
 #include <primitives/vec.hh>
 #include <transform.hh>
+#include <utils/math.hh>
 namespace RayTracer {
+/*!
+ * \brief A ray `origin + t * direction` restricted to t in [tMin, tMax].
+ *
+ * Shapes only report hits inside the interval, so a closest-hit search can
+ * shrink `tMax` to the nearest hit found so far and have every farther
+ * candidate rejected at the source. The interval survives `Transform`
+ * unchanged since the direction is not renormalized.
+ *
+ * The inverse of the direction and its signs are computed once on
+ * construction, for the slab tests of bounding boxes along a traversal.
+ * `TransformToShape` skips them for a ray that is only intersected with the
+ * surface of a shape, see `GetInvDirection`.
+ */
 class Ray final {
  private:
   Tuple origin, direction;
+  /// 1 / direction per axis, +inf along the axes the ray is parallel to
+  Tuple invDirection;
+  Real tMin{0};
+  Real tMax{MathUtils::MathConstants::INF<Real>};
+  /// bit i is set when the direction is negative along axis i
+  std::uint8_t dirSigns{0};
+
+  /* Zero components give +inf without dividing by zero, which would not be a
+   * constant expression. Reads the lanes directly, this runs for every ray
+   * transformed into the space of an instance. */
+  static constexpr Tuple InverseOf(const Tuple& direction) noexcept {
+    constexpr Real inf = MathUtils::MathConstants::INF<Real>;
+    const auto& d = direction.contents;
+    return Tuple{d[0] == 0 ? inf : 1 / d[0], d[1] == 0 ? inf : 1 / d[1],
+                 d[2] == 0 ? inf : 1 / d[2], TupleConstants::VectorFlag};
+  }
+
+  static constexpr std::uint8_t SignsOf(const Tuple& direction) noexcept {
+    const auto& d = direction.contents;
+    return (d[0] < 0) | (d[1] < 0) << 1 | (d[2] < 0) << 2;
+  }
+
+  /* Tag of the constructor leaving the inverse direction and signs unset */
+  struct WithoutInverse {};
+
+  /* The operands of a transformed ray are already checked */
+  constexpr Ray(const Tuple& origin, const Tuple& direction, Real tMin,
+                Real tMax, WithoutInverse) noexcept
+      : origin{origin},
+        direction{direction},
+        invDirection{PredefinedTuples::ZeroVector},
+        tMin{tMin},
+        tMax{tMax} {}
 
  public:
   /* Create a ray with origin located at (0,0,0) but no direction */
   constexpr explicit Ray() noexcept
       : origin{PredefinedTuples::ZeroPoint},
-        direction{PredefinedTuples::ZeroVector} {}
+        direction{PredefinedTuples::ZeroVector},
+        invDirection{InverseOf(direction)} {}
 
-  constexpr explicit Ray(const Tuple& origin, const Tuple& direction)
-      : origin{origin}, direction{direction} {
-    if (!IsPoint(origin))
-      throw std::invalid_argument("Ray requires origin to be a point-type");
+  constexpr explicit Ray(
+      const Tuple& origin, const Tuple& direction, Real tMin = 0,
+      Real tMax = MathUtils::MathConstants::INF<Real>)
+      : origin{origin},
+        direction{direction},
+        invDirection{InverseOf(direction)},
+        tMin{tMin},
+        tMax{tMax},
+        dirSigns{SignsOf(direction)} {
+    if constexpr (Checks::Enabled) {
+      if (!IsPoint(origin))
+        throw std::invalid_argument("Ray requires origin to be a point-type");
 
-    if (!IsVector(direction))
-      throw std::invalid_argument("Ray requires direction to be a vector-type");
+      if (!IsVector(direction))
+        throw std::invalid_argument(
+            "Ray requires direction to be a vector-type");
+    }
   }
 
   constexpr Ray(const Ray&) noexcept = default;
@@ -31,13 +90,54 @@ class Ray final {
 
   constexpr Tuple GetDirection() const noexcept { return direction; }
 
-  constexpr Tuple PositionAlong(double t) const noexcept {
+  /// Unset (zero) on a ray from `TransformToShape`
+  constexpr Tuple GetInvDirection() const noexcept { return invDirection; }
+
+  /// Whether the direction is negative along `axis`, unset like above
+  constexpr bool IsNegative(std::size_t axis) const noexcept {
+    return (dirSigns >> axis) & 1;
+  }
+
+  constexpr Real GetTMin() const noexcept { return tMin; }
+
+  constexpr Real GetTMax() const noexcept { return tMax; }
+
+  /// Whether a hit at distance t lies in [tMin, tMax]
+  constexpr bool Contains(Real t) const noexcept {
+    return tMin <= t && t <= tMax;
+  }
+
+  /// Shrink the interval to end at t, e.g once a hit at t has been found
+  constexpr void ClipTo(Real t) noexcept {
+    if (t < tMax)
+      tMax = t;
+  }
+
+  constexpr Tuple PositionAlong(Real t) const noexcept {
     return origin + t * direction;
   }
 
   /// Create a new Ray by applying a transformation to this one.
   constexpr Ray Transform(const Transform& transform) const noexcept {
-    return Ray{transform * origin, transform * direction};
+    return Ray{transform * origin, transform * direction, tMin, tMax};
+  }
+
+  /// Same as above for an affine transform, skipping the constant bottom row
+  constexpr Ray Transform(const AffineTransform& transform) const noexcept {
+    return Ray{transform.TransformPoint(origin),
+               transform.TransformVector(direction), tMin, tMax};
+  }
+
+  /*!
+   * \brief Same as above without computing the inverse direction and signs,
+   * which cost three divisions: for a ray in the object space of a shape
+   * whose surface is intersected directly, never slab tested.
+   */
+  constexpr Ray TransformToShape(
+      const AffineTransform& transform) const noexcept {
+    return Ray{transform.TransformPoint(origin),
+               transform.TransformVector(direction), tMin, tMax,
+               WithoutInverse{}};
   }
 };
 }  // namespace RayTracer
@@ -1,27 +1,28 @@
 #ifndef TRANSFORM_HH
 #define TRANSFORM_HH
 #include <primitives/matrix.hh>
+#include <primitives/quaternion.hh>
 #include <utils/math.hh>
 
 namespace RayTracer {
-using TransformMatrix = Matrix<double, 4, 4>;
+using TransformMatrix = Matrix<Real, 4, 4>;
 /* Forward declaration */
 class Transform;
 
 namespace MatrixUtils {
-constexpr Transform Translation(double offsetX, double offsetY, double offsetZ);
-constexpr Transform Scale(double ratioX, double ratioY, double ratioZ);
-constexpr Transform RotateX(double radians);
-constexpr Transform RotateY(double radians);
-constexpr Transform RotateZ(double radians);
-constexpr Transform Shearing(double xy, double xz, double yx, double yz,
-                             double zx, double zy);
+constexpr Transform Translation(Real offsetX, Real offsetY, Real offsetZ);
+constexpr Transform Scale(Real ratioX, Real ratioY, Real ratioZ);
+constexpr Transform RotateX(Real radians);
+constexpr Transform RotateY(Real radians);
+constexpr Transform RotateZ(Real radians);
+constexpr Transform Shearing(Real xy, Real xz, Real yx, Real yz,
+                             Real zx, Real zy);
 }  // namespace MatrixUtils
 
 class Transform : public TransformMatrix {
  public:
   constexpr Transform() noexcept
-      : TransformMatrix{PredefinedMatrices::I<double, 4>} {};
+      : TransformMatrix{PredefinedMatrices::I<Real, 4>} {};
 
   constexpr Transform(const TransformMatrix& other) noexcept
       : TransformMatrix(other) {}
@@ -39,29 +40,29 @@ class Transform : public TransformMatrix {
 
   constexpr Transform& operator=(Transform&& other) noexcept = default;
 
-  constexpr Transform Translation(double offsetX, double offsetY,
-                                  double offsetZ) {
+  constexpr Transform Translation(Real offsetX, Real offsetY,
+                                  Real offsetZ) {
     return MatrixUtils::Translation(offsetX, offsetY, offsetZ) * (*this);
   }
 
-  constexpr Transform Scale(double ratioX, double ratioY, double ratioZ) {
+  constexpr Transform Scale(Real ratioX, Real ratioY, Real ratioZ) {
     return MatrixUtils::Scale(ratioX, ratioY, ratioZ) * (*this);
   }
 
-  constexpr Transform RotateX(double radians) {
+  constexpr Transform RotateX(Real radians) {
     return MatrixUtils::RotateX(radians) * (*this);
   }
 
-  constexpr Transform RotateY(double radians) {
+  constexpr Transform RotateY(Real radians) {
     return MatrixUtils::RotateY(radians) * (*this);
   }
 
-  constexpr Transform RotateZ(double radians) {
+  constexpr Transform RotateZ(Real radians) {
     return MatrixUtils::RotateZ(radians) * (*this);
   }
 
-  constexpr Transform Shearing(double xy, double xz, double yx, double yz,
-                               double zx, double zy) {
+  constexpr Transform Shearing(Real xy, Real xz, Real yx, Real yz,
+                               Real zx, Real zy) {
     return MatrixUtils::Shearing(xy, xz, yx, yz, zx, zy) * (*this);
   }
 
@@ -76,27 +77,27 @@ class Transform : public TransformMatrix {
 };
 
 namespace MatrixUtils {
-constexpr Transform Translation(double offsetX, double offsetY,
-                                double offsetZ) {
-  TransformMatrix translation = PredefinedMatrices::I<double, 4>;
+constexpr Transform Translation(Real offsetX, Real offsetY,
+                                Real offsetZ) {
+  TransformMatrix translation = PredefinedMatrices::I<Real, 4>;
   translation[0][3] = offsetX;
   translation[1][3] = offsetY;
   translation[2][3] = offsetZ;
   return translation;
 }
 
-constexpr Transform Scale(double ratioX, double ratioY, double ratioZ) {
-  TransformMatrix scale = PredefinedMatrices::I<double, 4>;
+constexpr Transform Scale(Real ratioX, Real ratioY, Real ratioZ) {
+  TransformMatrix scale = PredefinedMatrices::I<Real, 4>;
   scale[0][0] = ratioX;
   scale[1][1] = ratioY;
   scale[2][2] = ratioZ;
   return scale;
 }
 
-constexpr Transform RotateX(double radians) {
-  double sine = MathUtils::Sine(radians);
-  double cosine = MathUtils::Cosine(radians);
-  TransformMatrix rotateX = PredefinedMatrices::I<double, 4>;
+constexpr Transform RotateX(Real radians) {
+  Real sine = MathUtils::Sine(radians);
+  Real cosine = MathUtils::Cosine(radians);
+  TransformMatrix rotateX = PredefinedMatrices::I<Real, 4>;
 
   rotateX[1][1] = cosine;
   rotateX[1][2] = -sine;
@@ -105,10 +106,10 @@ constexpr Transform RotateX(double radians) {
   return rotateX;
 }
 
-constexpr Transform RotateY(double radians) {
-  double sine = MathUtils::Sine(radians);
-  double cosine = MathUtils::Cosine(radians);
-  TransformMatrix rotateY = PredefinedMatrices::I<double, 4>;
+constexpr Transform RotateY(Real radians) {
+  Real sine = MathUtils::Sine(radians);
+  Real cosine = MathUtils::Cosine(radians);
+  TransformMatrix rotateY = PredefinedMatrices::I<Real, 4>;
   rotateY[0][0] = cosine;
   rotateY[0][2] = sine;
   rotateY[2][0] = -sine;
@@ -116,10 +117,10 @@ constexpr Transform RotateY(double radians) {
   return rotateY;
 }
 
-constexpr Transform RotateZ(double radians) {
-  double sine = MathUtils::Sine(radians);
-  double cosine = MathUtils::Cosine(radians);
-  TransformMatrix rotateZ = PredefinedMatrices::I<double, 4>;
+constexpr Transform RotateZ(Real radians) {
+  Real sine = MathUtils::Sine(radians);
+  Real cosine = MathUtils::Cosine(radians);
+  TransformMatrix rotateZ = PredefinedMatrices::I<Real, 4>;
   rotateZ[0][0] = cosine;
   rotateZ[0][1] = -sine;
   rotateZ[1][0] = sine;
@@ -127,9 +128,9 @@ constexpr Transform RotateZ(double radians) {
   return rotateZ;
 }
 
-constexpr Transform Shearing(double xy, double xz, double yx, double yz,
-                             double zx, double zy) {
-  TransformMatrix shearing = PredefinedMatrices::I<double, 4>;
+constexpr Transform Shearing(Real xy, Real xz, Real yx, Real yz,
+                             Real zx, Real zy) {
+  TransformMatrix shearing = PredefinedMatrices::I<Real, 4>;
   shearing[0][1] = xy;
   shearing[0][2] = xz;
   shearing[1][0] = yx;
@@ -145,7 +146,7 @@ constexpr Transform ViewTransform(const Tuple& from, const Tuple& to,
   const auto left = forward.CrossProduct(ToNormalizedVector(up));
   const auto fixedUp = left.CrossProduct(forward);
 
-  TransformMatrix orientation = PredefinedMatrices::I<double, 4>;
+  TransformMatrix orientation = PredefinedMatrices::I<Real, 4>;
   orientation[0][0] = left[0];
   orientation[0][1] = left[1];
   orientation[0][2] = left[2];
@@ -159,5 +160,289 @@ constexpr Transform ViewTransform(const Tuple& from, const Tuple& to,
   return orientation * Translation(-from[0], -from[1], -from[2]);
 }
 }  // namespace MatrixUtils
+
+using AffineMatrix = Matrix<Real, 3, 4>;
+
+/*!
+ * \brief Affine transform stored as the upper 3x4 block of a `TransformMatrix`.
+ *
+ * Every transform produced by `MatrixUtils` has a constant (0, 0, 0, 1) bottom
+ * row, so storing it only wastes memory and multiplies. Points and vectors are
+ * mapped through dedicated kernels (the translation column is skipped for
+ * vectors), and the inverse only needs the 3x3 linear part to be inverted.
+ */
+class AffineTransform : public AffineMatrix {
+ public:
+  // clang-format off
+  constexpr AffineTransform() noexcept
+      : AffineMatrix{1., 0., 0., 0.,
+                     0., 1., 0., 0.,
+                     0., 0., 1., 0.} {}
+  // clang-format on
+
+  /* Drop the bottom row of an affine `TransformMatrix` */
+  constexpr explicit AffineTransform(const TransformMatrix& mat) noexcept
+      : AffineMatrix{} {
+    assert(IsAffine(mat));
+    for (std::size_t row = 0u; row < Rows; row++)
+      for (std::size_t col = 0u; col < Cols; col++)
+        contents[row][col] = mat[row][col];
+  }
+
+  static constexpr bool IsAffine(const TransformMatrix& mat) noexcept {
+    return MathUtils::ApproxEqual(mat[3][0], 0.0) &&
+           MathUtils::ApproxEqual(mat[3][1], 0.0) &&
+           MathUtils::ApproxEqual(mat[3][2], 0.0) &&
+           MathUtils::ApproxEqual(mat[3][3], 1.0);
+  }
+
+  /* Expand back to a full 4x4 matrix */
+  constexpr TransformMatrix ToMatrix() const noexcept {
+    TransformMatrix mat = PredefinedMatrices::I<Real, 4>;
+    for (std::size_t row = 0u; row < Rows; row++)
+      for (std::size_t col = 0u; col < Cols; col++)
+        mat[row][col] = contents[row][col];
+    return mat;
+  }
+
+  constexpr Tuple TransformPoint(const Tuple& point) const noexcept {
+    const Real x = point[TupleConstants::x];
+    const Real y = point[TupleConstants::y];
+    const Real z = point[TupleConstants::z];
+    return MakePoint(
+        contents[0][0] * x + contents[0][1] * y + contents[0][2] * z +
+            contents[0][3],
+        contents[1][0] * x + contents[1][1] * y + contents[1][2] * z +
+            contents[1][3],
+        contents[2][0] * x + contents[2][1] * y + contents[2][2] * z +
+            contents[2][3]);
+  }
+
+  constexpr Tuple TransformVector(const Tuple& vec) const noexcept {
+    const Real x = vec[TupleConstants::x];
+    const Real y = vec[TupleConstants::y];
+    const Real z = vec[TupleConstants::z];
+    return MakeVector(
+        contents[0][0] * x + contents[0][1] * y + contents[0][2] * z,
+        contents[1][0] * x + contents[1][1] * y + contents[1][2] * z,
+        contents[2][0] * x + contents[2][1] * y + contents[2][2] * z);
+  }
+
+  /* Map a vector through the transpose of the linear part, e.g transforming
+   * object-space normals with the inverse transform */
+  constexpr Tuple TransposeTransformVector(const Tuple& vec) const noexcept {
+    const Real x = vec[TupleConstants::x];
+    const Real y = vec[TupleConstants::y];
+    const Real z = vec[TupleConstants::z];
+    return MakeVector(
+        contents[0][0] * x + contents[1][0] * y + contents[2][0] * z,
+        contents[0][1] * x + contents[1][1] * y + contents[2][1] * z,
+        contents[0][2] * x + contents[1][2] * y + contents[2][2] * z);
+  }
+};
+
+/* affine * tuple, translation is weighted by the w component */
+constexpr Tuple operator*(const AffineTransform& transform,
+                          const Tuple& tuple) noexcept {
+  const auto& m = transform.contents;
+  const Real x = tuple[TupleConstants::x];
+  const Real y = tuple[TupleConstants::y];
+  const Real z = tuple[TupleConstants::z];
+  const Real w = tuple[TupleConstants::w];
+  return Tuple{m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3] * w,
+               m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3] * w,
+               m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3] * w, w};
+}
+
+/* Composition of affine transforms: (lhs * rhs) applies rhs first */
+constexpr AffineTransform operator*(const AffineTransform& lhs,
+                                    const AffineTransform& rhs) noexcept {
+  AffineTransform ret{};
+  for (std::size_t row = 0u; row < 3u; row++) {
+    for (std::size_t col = 0u; col < 4u; col++) {
+      ret[row][col] = (col == 3u) ? lhs[row][3] : 0.0;
+      for (std::size_t c = 0u; c < 3u; c++)
+        ret[row][col] += lhs[row][c] * rhs[c][col];
+    }
+  }
+  return ret;
+}
+
+/*!
+ * \brief Inverse of an affine transform.
+ *
+ * The 3x3 linear part L is inverted through its adjugate and the translation
+ * becomes -L^-1 * t, which is far cheaper than a full 4x4 inversion.
+ *
+ * \return The inverse transform, or nullopt if the linear part is singular
+ *         (within the tolerance of `Invertible`).
+ */
+constexpr std::optional<AffineTransform> TryInverse(
+    const AffineTransform& transform) {
+  const auto& m = transform.contents;
+  // cofactors of the first column
+  const Real c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+  const Real c10 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+  const Real c20 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+  const Real det = m[0][0] * c00 + m[0][1] * c10 + m[0][2] * c20;
+  // same tolerance as `Invertible`, on the linear part
+  if (NearlySingular<3>(transform, det))
+    return std::nullopt;
+  const Real invDet = 1 / det;
+
+  AffineTransform inv{};
+  inv[0][0] = c00 * invDet;
+  inv[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * invDet;
+  inv[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * invDet;
+  inv[1][0] = c10 * invDet;
+  inv[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * invDet;
+  inv[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * invDet;
+  inv[2][0] = c20 * invDet;
+  inv[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * invDet;
+  inv[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * invDet;
+  for (std::size_t row = 0u; row < 3u; row++)
+    inv[row][3] = -(inv[row][0] * m[0][3] + inv[row][1] * m[1][3] +
+                    inv[row][2] * m[2][3]);
+  return inv;
+}
+
+constexpr AffineTransform Inverse(const AffineTransform& transform) {
+  const auto result = TryInverse(transform);
+  assert(result.has_value());
+  return result.value();
+}
+/*!
+ * \brief Transform kept as its translation, rotation and scale (T * R * S).
+ *
+ * Composing, inverting and interpolating TRS values is much cheaper than the
+ * equivalent 4x4 matrix work: rotations are quaternions and no determinant is
+ * ever needed. Build the transform of an object (or of an animation frame) as
+ * a TRS, and only expand it to a matrix once it is handed to a shape, see
+ * `ToAffine` / `InverseAffine` and `Shape::SetTransform(const TRS&)`.
+ */
+class TRS final {
+ public:
+  /* Identity transform */
+  constexpr TRS() noexcept
+      : translation{PredefinedTuples::ZeroVector},
+        rotation{},
+        scale{MakeVector(1, 1, 1)} {}
+
+  constexpr TRS(const Tuple& translation_, const Quaternion& rotation_,
+                const Tuple& scale_ = MakeVector(1, 1, 1)) noexcept
+      : translation{ToVector(translation_)},
+        rotation{rotation_},
+        scale{ToVector(scale_)} {}
+
+  static constexpr TRS Translation(Real offsetX, Real offsetY,
+                                   Real offsetZ) noexcept {
+    return TRS{MakeVector(offsetX, offsetY, offsetZ), Quaternion{}};
+  }
+
+  static constexpr TRS Rotation(const Quaternion& rotation) noexcept {
+    return TRS{PredefinedTuples::ZeroVector, rotation};
+  }
+
+  static constexpr TRS Scale(Real ratioX, Real ratioY, Real ratioZ) noexcept {
+    return TRS{PredefinedTuples::ZeroVector, Quaternion{},
+               MakeVector(ratioX, ratioY, ratioZ)};
+  }
+
+  constexpr bool HasUniformScale() const noexcept {
+    return MathUtils::ApproxEqual(scale[TupleConstants::x],
+                                  scale[TupleConstants::y]) &&
+           MathUtils::ApproxEqual(scale[TupleConstants::x],
+                                  scale[TupleConstants::z]);
+  }
+
+  constexpr Tuple TransformPoint(const Tuple& point) const noexcept {
+    return rotation.Rotate(point * scale) + translation;
+  }
+
+  constexpr Tuple TransformVector(const Tuple& vec) const noexcept {
+    return rotation.Rotate(vec * scale);
+  }
+
+  /* Object-to-world matrix, the linear part is R with its columns scaled */
+  constexpr AffineTransform ToAffine() const noexcept {
+    const auto rot = rotation.ToMatrix();
+    AffineTransform ret{};
+    for (std::size_t row = 0u; row < 3u; row++) {
+      for (std::size_t col = 0u; col < 3u; col++)
+        ret[row][col] = rot[row][col] * scale[col];
+      ret[row][3] = translation[row];
+    }
+    return ret;
+  }
+
+  /* World-to-object matrix S^-1 * R^T * T^-1, exact for any scale */
+  constexpr AffineTransform InverseAffine() const noexcept {
+    const auto rot = rotation.ToMatrix();
+    AffineTransform ret{};
+    for (std::size_t row = 0u; row < 3u; row++) {
+      const Real invScale = Real(1) / scale[row];
+      for (std::size_t col = 0u; col < 3u; col++)
+        ret[row][col] = rot[col][row] * invScale;
+      ret[row][3] = -(ret[row][0] * translation[TupleConstants::x] +
+                      ret[row][1] * translation[TupleConstants::y] +
+                      ret[row][2] * translation[TupleConstants::z]);
+    }
+    return ret;
+  }
+
+  constexpr Transform ToMatrix() const noexcept {
+    return ToAffine().ToMatrix();
+  }
+
+  constexpr operator Transform() const noexcept { return ToMatrix(); }
+
+  /* translation of the object, as a vector */
+  Tuple translation;
+  /* unit quaternion */
+  Quaternion rotation;
+  /* scale factor along each axis, as a vector */
+  Tuple scale;
+};
+
+/*!
+ * \brief Composition of TRS transforms: (lhs * rhs) applies rhs first.
+ *
+ * The result is again a TRS only when `lhs` scales uniformly (or `rhs` does
+ * not rotate); otherwise compose the matrices (`ToAffine`) instead.
+ */
+constexpr TRS operator*(const TRS& lhs, const TRS& rhs) noexcept {
+  assert(lhs.HasUniformScale() || rhs.rotation == Quaternion{});
+  return TRS{
+      lhs.TransformPoint(PredefinedTuples::ZeroPoint + rhs.translation),
+      (lhs.rotation * rhs.rotation).Normalize(), lhs.scale * rhs.scale};
+}
+
+constexpr bool operator==(const TRS& lhs, const TRS& rhs) noexcept {
+  return lhs.translation == rhs.translation && lhs.rotation == rhs.rotation &&
+         lhs.scale == rhs.scale;
+}
+
+/* Inverse of a uniformly scaled TRS (see `InverseAffine` for any scale) */
+constexpr TRS Inverse(const TRS& transform) noexcept {
+  assert(transform.HasUniformScale());
+  const Real invScale = Real(1) / transform.scale[TupleConstants::x];
+  const Quaternion invRotation = transform.rotation.Conjugate();
+  return TRS{-invRotation.Rotate(transform.translation) * invScale,
+             invRotation, MakeVector(invScale, invScale, invScale)};
+}
+
+/*!
+ * \brief Interpolate two transforms, e.g between animation key frames.
+ *
+ * Translation and scale are interpolated linearly and the rotation along the
+ * shortest arc (`Slerp`).
+ *
+ * \param t interpolation parameter, 0 gives `from` and 1 gives `to`
+ */
+constexpr TRS Interpolate(const TRS& from, const TRS& to, Real t) noexcept {
+  return TRS{from.translation + (to.translation - from.translation) * t,
+             Slerp(from.rotation, to.rotation, t),
+             from.scale + (to.scale - from.scale) * t};
+}
 }  // namespace RayTracer
 #endif
@@ -0,0 +1,23 @@
+#ifndef CHECKS_HH
+#define CHECKS_HH
+namespace RayTracer {
+
+/*
+ * Validation policy of the primitives: the bounds checks of `Vec::operator[]`
+ * and `Matrix::Row/Column`, and the point/vector checks of the `Ray`
+ * constructor. Enabled by default (tests always keep them), define
+ * RAYTRACER_UNCHECKED (cmake -DUNCHECKED_ACCESS=ON or `make unchecked=1`) for
+ * release render builds, where accesses compile to raw loads. Constant
+ * evaluation still rejects an out-of-bounds read on its own.
+ */
+namespace Checks {
+#if defined(RAYTRACER_UNCHECKED)
+inline constexpr bool Enabled = false;
+#else
+inline constexpr bool Enabled = true;
+#endif
+}  // namespace Checks
+
+}  // namespace RayTracer
+
+#endif
@@ -1,10 +1,12 @@
 #ifndef MATH_HH
 #define MATH_HH
+#include <bit>
 #include <cmath>
 #include <cstdint>
 #include <numeric>
 #include <optional>
 #include <primitive_traits.hh>
+#include <type_traits>
 #include <utility>
 #define EPSILON 1e-4
 namespace RayTracer {
@@ -21,21 +23,6 @@ template <typename T = double>
 constexpr T NINF = -std::numeric_limits<T>::infinity();
 };  // namespace MathConstants
 
-/* Constexpr square root value for floating point value. */
-template <std::floating_point T>
-constexpr T ConstExprSqrtf(T x) {
-  if (x >= 0 && x < std::numeric_limits<T>::infinity()) {
-    T curr{x}, prev{0.0f};
-    while (curr != prev) {
-      prev = curr;
-      curr = 0.5f * (curr + x / curr);
-    }
-
-    return curr;
-  }
-  return std::numeric_limits<T>::quiet_NaN();
-}
-
 /* constexpr absolute value of a floating point value. */
 template <std::floating_point T>
 constexpr T ConstExprAbsf(T val) {
@@ -80,61 +67,255 @@ constexpr int NumOfDigits(Ts... args) {
   return (NumOfDigitsHelper(args) + ...);
 }
 
-/** @brief compute taylor series for sine/cosine in recursive fasion
- * @param x: initial value
- * @param sum: summation term from previous funtion call
- * @param fact: factorial term, e.g 3!, 5!, ...
- * @param i: iteration index for this iteration
- * @param sign: sign for this iteration
- * @param xProduct: product term of x, e.g x^2, x^4, ...
- * @return Traiangle expannsion value
+/*
+  Pure constexpr kernels, this is what a compile-time render evaluates.
+  The functions below them dispatch to <cmath> when not constant evaluated
+  and only fall back to these during constant evaluation; they stay callable
+  directly so tests can pin both modes against each other.
+*/
+namespace ConstExpr {
+
+namespace Detail {
+/*
+ * First sqrt estimate: halving the biased exponent directly in the bit
+ * pattern gives a guess within ~6%, Newton then needs 4-5 steps instead of
+ * the dozens it takes when starting from x itself.
  */
 template <std::floating_point T>
-constexpr T TaylorSeries(T x, T sum, T fact, int i, int sign, T xProduct) {
+constexpr T SqrtGuess(T x) {
+  if constexpr (std::is_same_v<T, double>) {
+    const auto bits = std::bit_cast<uint64_t>(x);
+    return std::bit_cast<double>((bits >> 1) + (uint64_t{1023} << 51));
+  } else if constexpr (std::is_same_v<T, float>) {
+    const auto bits = std::bit_cast<uint32_t>(x);
+    return std::bit_cast<float>((bits >> 1) + (uint32_t{127} << 22));
+  } else {
+    return x;
+  }
+}
+
+/* sin(r) for r in [-pi/4, pi/4]: Taylor polynomial up to r^15 in Horner
+ * form, the truncation error there is below 1e-16 */
+template <std::floating_point T>
+constexpr T SinPoly(T r) {
+  const T r2 = r * r;
+  // clang-format off
+  return r * (T(1) + r2 * (T(-1.0 / 6) + r2 * (T(1.0 / 120) +
+         r2 * (T(-1.0 / 5040) + r2 * (T(1.0 / 362880) +
+         r2 * (T(-1.0 / 39916800) + r2 * (T(1.0 / 6227020800) +
+         r2 * T(-1.0 / 1307674368000))))))));
+  // clang-format on
+}
+
+/* cos(r) for r in [-pi/4, pi/4]: Taylor polynomial up to r^16 */
+template <std::floating_point T>
+constexpr T CosPoly(T r) {
+  const T r2 = r * r;
   // clang-format off
-            return Feq(sum, sum + xProduct * sign / fact) ? sum : \
-                TaylorSeries(x, sum + xProduct * sign / fact, fact * i * (i + 1), i + 2, -sign, xProduct * x * x);
+  return T(1) + r2 * (T(-1.0 / 2) + r2 * (T(1.0 / 24) +
+         r2 * (T(-1.0 / 720) + r2 * (T(1.0 / 40320) +
+         r2 * (T(-1.0 / 3628800) + r2 * (T(1.0 / 479001600) +
+         r2 * (T(-1.0 / 87178291200) + r2 * T(1.0 / 20922789888000))))))));
   // clang-format on
 }
 
-/* Constexpr calculation sin by Taylor series expansion */
+/*
+ * Range reduction x = quadrant * pi/2 + r with r in [-pi/4, pi/4]; pi/2 is
+ * split in a high and a low part (Cody-Waite) so r keeps its precision for
+ * large x. Returns the quadrant modulo 4.
+ */
+template <std::floating_point T>
+constexpr int ReduceQuarterPi(T x, T& r) {
+  constexpr long double halfPi = 1.5707963267948966192313216916397514L;
+  constexpr T halfPiHi = T(halfPi);
+  constexpr T halfPiLo = T(halfPi - halfPiHi);
+  const T scaled = x * T(1 / halfPi);
+  const auto quadrant =
+      static_cast<int64_t>(scaled >= T() ? scaled + T(0.5) : scaled - T(0.5));
+  r = (x - T(quadrant) * halfPiHi) - T(quadrant) * halfPiLo;
+  return static_cast<int>(quadrant & 3);
+}
+
+template <std::floating_point T>
+constexpr bool IsFinite(T x) {
+  return x == x && ConstExprAbsf(x) != std::numeric_limits<T>::infinity();
+}
+}  // namespace Detail
+
+/* Square root by Newton iterations from an exponent based first guess */
+template <std::floating_point T>
+constexpr T Sqrt(T x) {
+  if (x == T())
+    return x;
+  if (x > 0 && x < std::numeric_limits<T>::infinity()) {
+    T curr{Detail::SqrtGuess(x)}, prev{0.0f};
+    while (curr != prev) {
+      prev = curr;
+      curr = 0.5f * (curr + x / curr);
+    }
+
+    return curr;
+  }
+  return std::numeric_limits<T>::quiet_NaN();
+}
+
+/*
+ * sin by range reduction to [-pi/4, pi/4] and a fixed polynomial. float goes
+ * through double so compile-time results round like the run-time std::sin.
+ */
 template <std::floating_point T>
 constexpr T Sine(T rad) {
-  // sinx = x - \frac{x^3}{3!} + \frac{x^5}{5!} - ...
-  int sign = -1;
-  int idx = 4;
-  T t = rad * rad * rad;  // x^3
-  T fact = 6.0;           // 3!
-  return TaylorSeries(rad, rad, fact, idx, sign, t);
+  if constexpr (std::is_same_v<T, float>)
+    return static_cast<float>(Sine(static_cast<double>(rad)));
+  if (!Detail::IsFinite(rad))
+    return std::numeric_limits<T>::quiet_NaN();
+  T r{};
+  switch (Detail::ReduceQuarterPi(rad, r)) {
+    case 0:
+      return Detail::SinPoly(r);
+    case 1:
+      return Detail::CosPoly(r);
+    case 2:
+      return -Detail::SinPoly(r);
+    default:
+      return -Detail::CosPoly(r);
+  }
 }
 
-/* Constexpr calculation cos by Taylor series expansion */
+/* cos by range reduction to [-pi/4, pi/4] and a fixed polynomial */
 template <std::floating_point T>
 constexpr T Cosine(T rad) {
-  // cosx = 1.0 - \frac{x^2}{2!} + \frac{x^4}{4!} - ...
-  int sign = -1;
-  int idx = 3;
-  T t = rad * rad;  // x^2
-  T fact = 2.0;     // 2!
-  return TaylorSeries(rad, 1.0, fact, idx, sign, t);
+  if constexpr (std::is_same_v<T, float>)
+    return static_cast<float>(Cosine(static_cast<double>(rad)));
+  if (!Detail::IsFinite(rad))
+    return std::numeric_limits<T>::quiet_NaN();
+  T r{};
+  switch (Detail::ReduceQuarterPi(rad, r)) {
+    case 0:
+      return Detail::CosPoly(r);
+    case 1:
+      return -Detail::SinPoly(r);
+    case 2:
+      return -Detail::CosPoly(r);
+    default:
+      return Detail::SinPoly(r);
+  }
 }
 
-/* Constexpr calculation cos by Taylor series expansion */
+/*
+ * acos on [-1, 1]: a polynomial first guess (Abramowitz & Stegun 4.4.45,
+ * error below 7e-5) refined by Newton steps on cos(theta) = x.
+ */
 template <std::floating_point T>
-constexpr T Tangent(T rad) {
-  return Sine(rad) / Cosine(rad);
+constexpr T ArcCosine(T x) {
+  if constexpr (std::is_same_v<T, float>)
+    return static_cast<float>(ArcCosine(static_cast<double>(x)));
+  if (!(x >= T(-1) && x <= T(1)))
+    return std::numeric_limits<T>::quiet_NaN();
+  const T a = ConstExprAbsf(x);
+  // clang-format off
+  T theta = Sqrt(T(1) - a) * (T(1.5707288) + a * (T(-0.2121144) +
+            a * (T(0.0742610) + a * T(-0.0187293))));
+  // clang-format on
+  if (x < T())
+    theta = T(3.1415926535897932385L) - theta;
+  for (int i = 0; i < 3; i++) {
+    const T sine = Sine(theta);
+    if (sine == T())
+      break;
+    theta += (Cosine(theta) - x) / sine;
+  }
+  return theta;
 }
 
-/*  computes base^exponent, base to the power of exponent (with an integer exponent) */
+/* base^exponent for a non-negative integer exponent, by squaring */
 template <std::floating_point T>
-constexpr T ConstExprExp(const T base, const int32_t exponent) {
+constexpr T Pow(const T base, const int32_t exponent) {
   T ret = (T)1;
-  for (int32_t i = 0; i < exponent; ++i) {
-    ret *= base;
+  T square = base;
+  for (int32_t e = exponent; e > 0; e >>= 1) {
+    if (e & 1)
+      ret *= square;
+    square *= square;
   }
   return ret;
 }
 
+/* Remainder of x / y with the sign of x, same as std::fmod */
+template <std::floating_point T>
+constexpr T Modulo(const T x, const T y) {
+  return (x < T() ? T(-1) : T(1)) *
+         ((x < T() ? -x : x) -
+          static_cast<long long int>((x / y < T() ? -x / y : x / y)) *
+              (y < T() ? -y : y));
+}
+
+template <std::floating_point T>
+constexpr T Floor(const T val) {
+  // casting to int truncates the value, which is floor(val) for positive values,
+  // but we have to substract 1 for negative values (unless val is already floored == recasted int val)
+  const auto valInt = (int64_t)val;
+  const T fvalInt = (T)valInt;
+  return (val >= T() ? fvalInt : (val == fvalInt ? val : fvalInt - (T)1));
+}
+
+template <std::floating_point T>
+constexpr T Ceil(const T val) {
+  const auto valInt = (int64_t)val;
+  const T fvalInt = (T)valInt;
+  return (val == fvalInt ? fvalInt : fvalInt + ((val > 0) ? (T)1 : T()));
+}
+
+}  // namespace ConstExpr
+
+/* Square root: std::sqrt at run time, ConstExpr::Sqrt at compile time */
+template <std::floating_point T>
+constexpr T ConstExprSqrtf(T x) {
+  if (!std::is_constant_evaluated())
+    return std::sqrt(x);
+  return ConstExpr::Sqrt(x);
+}
+
+/* sin: std::sin at run time, ConstExpr::Sine at compile time */
+template <std::floating_point T>
+constexpr T Sine(T rad) {
+  if (!std::is_constant_evaluated())
+    return std::sin(rad);
+  return ConstExpr::Sine(rad);
+}
+
+/* cos: std::cos at run time, ConstExpr::Cosine at compile time */
+template <std::floating_point T>
+constexpr T Cosine(T rad) {
+  if (!std::is_constant_evaluated())
+    return std::cos(rad);
+  return ConstExpr::Cosine(rad);
+}
+
+/* tan: std::tan at run time, sin / cos series at compile time */
+template <std::floating_point T>
+constexpr T Tangent(T rad) {
+  if (!std::is_constant_evaluated())
+    return std::tan(rad);
+  return ConstExpr::Sine(rad) / ConstExpr::Cosine(rad);
+}
+
+/* acos: std::acos at run time, ConstExpr::ArcCosine at compile time */
+template <std::floating_point T>
+constexpr T ArcCosine(T x) {
+  if (!std::is_constant_evaluated())
+    return std::acos(x);
+  return ConstExpr::ArcCosine(x);
+}
+
+/*  computes base^exponent, base to the power of exponent (with an integer exponent) */
+template <std::floating_point T>
+constexpr T ConstExprExp(const T base, const int32_t exponent) {
+  if (!std::is_constant_evaluated())
+    return static_cast<T>(std::pow(base, exponent));
+  return ConstExpr::Pow(base, exponent);
+}
+
 template <std::floating_point T>
 constexpr std::optional<std::pair<T, T>> SolveQuadratic(T a, T b, T c) {
   T discriminant = (b * b) - (4.0 * a * c);
@@ -158,26 +339,23 @@ constexpr std::optional<std::pair<T, T>> SolveQuadratic(T a, T b, T c) {
 
 template <std::floating_point T>
 constexpr T Modulo(const T x, const T y) {
-  return (x < T() ? T(-1) : T(1)) *
-         ((x < T() ? -x : x) -
-          static_cast<long long int>((x / y < T() ? -x / y : x / y)) *
-              (y < T() ? -y : y));
+  if (!std::is_constant_evaluated())
+    return std::fmod(x, y);
+  return ConstExpr::Modulo(x, y);
 }
 
 template <std::floating_point T>
 constexpr T Floor(const T val) {
-  // casting to int truncates the value, which is floor(val) for positive values,
-  // but we have to substract 1 for negative values (unless val is already floored == recasted int val)
-  const auto valInt = (int64_t)val;
-  const T fvalInt = (T)valInt;
-  return (val >= T() ? fvalInt : (val == fvalInt ? val : fvalInt - (T)1));
+  if (!std::is_constant_evaluated())
+    return std::floor(val);
+  return ConstExpr::Floor(val);
 }
 
 template <std::floating_point T>
 constexpr T Ceil(const T val) {
-  const auto valInt = (int64_t)val;
-  const T fvalInt = (T)valInt;
-  return (val == fvalInt ? fvalInt : fvalInt + ((val > 0) ? (T)1 : T()));
+  if (!std::is_constant_evaluated())
+    return std::ceil(val);
+  return ConstExpr::Ceil(val);
 }
 
 }  // namespace MathUtils
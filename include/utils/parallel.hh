@@ -0,0 +1,61 @@
+#ifndef PARALLEL_HH
+#define PARALLEL_HH
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+namespace RayTracer {
+
+/*
+ * Run-time helpers spreading loops over every core, for the builders of the
+ * acceleration structures. Callers keep a sequential path for constant
+ * evaluation, where no thread can be started.
+ */
+namespace ParallelUtils {
+
+/* Number of worker threads, at least one */
+inline std::size_t NumThreads() noexcept {
+  return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+/*!
+ * \brief Call `func(i)` for every i in [0, count), from up to `NumThreads()`
+ * threads including the calling one.
+ *
+ * Indices are handed out in blocks of `grain` from a shared counter, so
+ * uneven iterations still balance. Runs inline when a single block would
+ * cover the whole range. `func` must not throw.
+ */
+template <typename Func>
+void ParallelFor(std::size_t count, Func&& func, std::size_t grain = 1) {
+  grain = std::max<std::size_t>(grain, 1);
+  const std::size_t numBlocks = (count + grain - 1) / grain;
+  const std::size_t numThreads = std::min(NumThreads(), numBlocks);
+  if (numThreads <= 1) {
+    for (std::size_t i = 0; i < count; i++)
+      func(i);
+    return;
+  }
+  std::atomic<std::size_t> nextBlock{0};
+  const auto work = [&] {
+    for (std::size_t block = nextBlock++; block < numBlocks;
+         block = nextBlock++) {
+      const std::size_t end = std::min(count, (block + 1) * grain);
+      for (std::size_t i = block * grain; i < end; i++)
+        func(i);
+    }
+  };
+  std::vector<std::thread> workers;
+  workers.reserve(numThreads - 1);
+  for (std::size_t t = 1; t < numThreads; t++)
+    workers.emplace_back(work);
+  work();
+  for (std::thread& worker : workers)
+    worker.join();
+}
+
+}  // namespace ParallelUtils
+}  // namespace RayTracer
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef REAL_HH
+#define REAL_HH
+namespace RayTracer {
+
+/*
+ * Scalar type used throughout the pipeline: Tuple, Colour, Transform, Ray,
+ * Intersection, Shape, World and Camera all store and compute in `Real`.
+ * Defaults to double, define RAYTRACER_USE_FLOAT (cmake -DUSE_FLOAT=ON or
+ * `make float=1`) for a float32 build, e.g to compare a render against the
+ * double one.
+ */
+#if defined(RAYTRACER_USE_FLOAT)
+using Real = float;
+#else
+using Real = double;
+#endif
+
+}  // namespace RayTracer
+
+#endif
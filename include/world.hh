@@ -1,8 +1,12 @@
 #ifndef WORLD_HH
 #define WORLD_HH
+#include <accel/linear.hh>
+#include <algorithm>
 #include <concepts>
 #include <primitives.hh>
 #include <tuple>
+#include <utility>
+#include <vector>
 namespace RayTracer {
 
 template <typename... Ts>
@@ -22,7 +26,14 @@ struct NumXSOf<Plane, Ts...> {
       ShapeTraits::PlaneTrait::NumIntersections + NumXSOf<Ts...>::numXS;
 };
 
-template <typename ShapeContType, typename LightContType, std::size_t NXs = 10>
+template <typename... Ts>
+struct NumXSOf<Instance, Ts...> {
+  static constexpr int numXS =
+      ShapeTraits::InstanceTrait::NumIntersections + NumXSOf<Ts...>::numXS;
+};
+
+template <typename ShapeContType, typename LightContType, std::size_t NXs = 10,
+          typename AccelType = LinearAccel>
 requires requires(ShapeContType shapeArgs, LightContType lightArgs) {
   // number of possible intersections should > 0 for valid ray intersection result
   requires NXs > 0;
@@ -36,33 +47,94 @@ requires requires(ShapeContType shapeArgs, LightContType lightArgs) {
 class World {
  public:
   constexpr World(ShapeContType&& shapeArgs, LightContType&& lightArgs)
-      : shapes{std::forward<ShapeContType>(shapeArgs)},
-        lights{std::forward<LightContType>(lightArgs)} {}
-
-  static constexpr std::size_t NumXS{NXs};
-
-  constexpr auto IntersectWithRay(const Ray& ray) const
-      -> std::array<Intersection, NumXS> {
-    std::array<Intersection, NumXS> ret = {};
-    std::size_t iter = 0;
-    for (int i = 0; i < shapes.size(); i++) {
-      const auto variant = shapes[i].IntersectWith(ray);
-      auto visitor = [&](auto&& v) {
-        using T = PrimitiveTraits::RemoveCVR<decltype(v)>;
-        if constexpr (std::same_as<T, StaticVector<Intersection, 2>>) {
-          const auto xs = std::get<StaticVector<Intersection, 2>>(variant);
-          for (std::size_t i = 0; i < 2; i++)
-            ret[iter++] = std::move(xs[i]);
-        } else if constexpr (std::same_as<T, StaticVector<Intersection, 1>>) {
-          const auto xs = std::get<StaticVector<Intersection, 1>>(variant);
-          ret[iter++] = std::move(xs[0]);
-        }
-      };
-      // visit the variant
-      std::visit(visitor, variant);
+      // parentheses, braces would pick the initializer_list constructor of a
+      // std::vector of shapes
+      : shapes(std::forward<ShapeContType>(shapeArgs)),
+        lights(std::forward<LightContType>(lightArgs)),
+        accel{shapes} {}
+
+  /* Whether the shapes are a fixed size array, e.g a `std::array` */
+  static constexpr bool FixedSize =
+      requires { std::tuple_size<ShapeContType>::value; };
+
+  using ShapeValueType = typename ShapeContType::value_type;
+
+  /*!
+   * \brief Most hits a ray can have in a fixed size world: every shape hit
+   * `MaxHits` times, at least one for a valid buffer. A dynamically sized
+   * world collects its hits in a `std::vector`, `NXs` being only its
+   * initial capacity.
+   */
+  static constexpr std::size_t NumXS = [] {
+    if constexpr (FixedSize)
+      return std::max<std::size_t>(
+          std::tuple_size_v<ShapeContType> * ShapeValueType::MaxHits, 1);
+    else
+      return NXs;
+  }();
+
+  using IntersectionList =
+      std::conditional_t<FixedSize, StaticVector<Intersection, NumXS>,
+                         std::vector<Intersection>>;
+
+  /* The `Intersection` a buffered hit of this world refers to */
+  constexpr Intersection ToIntersection(const Hit& hit) const {
+    return Intersection(hit.t, &shapes[hit.shapeIndex], hit.primIndex);
+  }
+
+  /*!
+   * \brief All hits of a ray inside its [tMin, tMax] interval, sorted from
+   * near to far.
+   */
+  constexpr IntersectionList IntersectWithRay(const Ray& ray) const {
+    if constexpr (FixedSize) {
+      HitBuffer<NumXS> hits;
+      for (std::size_t i = 0; i < shapes.size(); i++)
+        shapes[i].IntersectInto(ray, static_cast<std::uint32_t>(i), hits);
+      return SortedIntersections(hits);
+    } else {
+      std::vector<Hit> hits;
+      hits.reserve(NumXS);
+      for (std::size_t i = 0; i < shapes.size(); i++) {
+        HitBuffer<ShapeValueType::MaxHits> shapeHits;
+        shapes[i].IntersectInto(ray, static_cast<std::uint32_t>(i), shapeHits);
+        hits.insert(hits.end(), shapeHits.begin(), shapeHits.end());
+      }
+      return SortedIntersections(hits);
     }
-    // Sort intersections before return
-    return IntersectionUtils::SortIntersections(ret);
+  }
+
+  /*!
+   * \brief Find the most visible hit of a ray, without building and sorting
+   * the whole intersection list like `IntersectWithRay` does.
+   *
+   * Forwarded to the acceleration structure, which clips the far end of the
+   * ray interval to each hit found so that farther shapes report nothing.
+   *
+   * \return Same as `VisibleHit(IntersectWithRay(ray))`: the nearest
+   * intersection inside the ray interval, or nullopt if the ray misses.
+   */
+  constexpr std::optional<Intersection> ClosestHit(const Ray& ray) const {
+    const std::optional<Hit> closest = accel.ClosestHit(shapes, ray);
+    if (!closest)
+      return std::nullopt;
+    return ToIntersection(*closest);
+  }
+
+  /*!
+   * \brief Any-hit query: whether some shape is hit inside the ray interval.
+   *
+   * The acceleration structure returns at the first shape that reports such
+   * a hit, without finding the nearest one, which is all a shadow ray needs.
+   */
+  constexpr bool Occluded(const Ray& ray) const {
+    return accel.Occluded(shapes, ray);
+  }
+
+  /* Same as above for hits at t in [EPSILON, tMax] */
+  constexpr bool Occluded(const Ray& ray, Real tMax) const {
+    return Occluded(
+        Ray{ray.GetOrigin(), ray.GetDirection(), Real(EPSILON), tMax});
   }
 
   constexpr Colour ShadeHit(const HitRecord& hitRecord) const {
@@ -80,24 +152,17 @@ class World {
   constexpr bool IsShadowed(const Tuple& point, const PointLight& light) const {
     // direction vector from point to light
     const Tuple v = (light.position - point);
-    const double distance = v.Magnitude();
+    const Real distance = v.Magnitude();
     const Tuple direction = ToNormalizedVector(v);
-    const Ray shadowRay = Ray(point, direction);
+    const Ray shadowRay = Ray(point, direction, Real(EPSILON), distance);
 
-    // Cast a shadow ray to see if it intersects anything.
-    const auto xs = this->IntersectWithRay(shadowRay);
-
-    // find the hit from the resulting intersections
-    const auto I = IntersectionUtils::VisibleHit(xs);
-
-    return I.has_value() && I.value().GetIntersectDistance() < distance;
+    // Any hit between the point and the light casts a shadow
+    return this->Occluded(shadowRay);
   }
 
   constexpr Colour ColorAt(const Ray& ray) const {
-    // find the intersections with given ray
-    const auto xs = this->IntersectWithRay(ray);
-    // find the hit from the resulting intersections
-    const auto I = IntersectionUtils::VisibleHit(xs);
+    // find the nearest hit of the given ray
+    const auto I = this->ClosestHit(ray);
     // return the color black if there is no such intersection
     if (!I.has_value() || !I.value().shapePtr || I == std::nullopt)
       return PredefinedColours::BLACK;
@@ -119,8 +184,264 @@ class World {
 
   constexpr LightContType const& GetLights() const { return lights; }
 
+  constexpr AccelType const& GetAccelerator() const { return accel; }
+
+  /*!
+   * \brief Update the acceleration structure once the transforms of `shapes`
+   * changed, e.g between two frames of an animation.
+   *
+   * \return Whether the structure was rebuilt rather than refitted
+   */
+  constexpr bool UpdateAccelerator() { return accel.Update(shapes); }
+
   ShapeContType shapes;
   LightContType lights;
+  /// built from `shapes` on construction, declared after them for that reason
+  AccelType accel;
+
+ private:
+  template <typename HitList>
+  constexpr IntersectionList SortedIntersections(HitList& hits) const {
+    // every hit lies in the ray interval, no negative distance to skip
+    std::sort(hits.begin(), hits.end(),
+              [](const Hit& lhs, const Hit& rhs) { return lhs.t < rhs.t; });
+    IntersectionList ret;
+    if constexpr (!FixedSize)
+      ret.reserve(hits.size());
+    for (const Hit& hit : hits)
+      ret.push_back(ToIntersection(hit));
+    return ret;
+  }
+};
+
+/*!
+ * \brief `World` whose shapes are grouped by concrete type, given as a
+ * `std::tuple` of per-type arrays, e.g
+ * `std::tuple<std::array<Sphere, 5>, std::array<Plane, 1>>`.
+ *
+ * Every query runs one loop per shape type, unrolled at compile time over the
+ * tuple, so shapes are tested without going through the `std::variant` of
+ * `ShapeWrapper`, and the hit capacity `NumXS` is derived from the types
+ * instead of a hand-written `NumXSOf`. Hits use a flat shape index: the
+ * shapes of the k-th array come after those of the previous arrays, see
+ * `Offsets`.
+ */
+template <typename ShapeTupleType, typename LightContType>
+class TypedWorld;
+
+/*
+ * A fixed size array of one shape type, e.g `std::array<Sphere, 5>`: its size
+ * and the hits of each shape are known at compile time.
+ */
+template <typename ArrayType>
+concept TypedShapeArray = requires(const ArrayType& array, const Ray& ray,
+                                   HitBuffer<1>& hits) {
+  typename ArrayType::value_type;
+  { std::tuple_size<ArrayType>::value } -> std::convertible_to<std::size_t>;
+  { ArrayType::value_type::MaxHits } -> std::convertible_to<std::size_t>;
+  array[0].IntersectInto(ray, std::uint32_t{0}, hits);
+  { array[0].Occludes(ray) } -> std::same_as<bool>;
+};
+
+template <typename... ShapeArrays, typename LightContType>
+requires requires(LightContType lightArgs) {
+  requires sizeof...(ShapeArrays) > 0;
+  requires(TypedShapeArray<ShapeArrays> && ...);
+  typename LightContType::size_type;
+  { lightArgs.size() } -> std::same_as<typename LightContType::size_type>;
+}
+class TypedWorld<std::tuple<ShapeArrays...>, LightContType> {
+ public:
+  using ShapeTupleType = std::tuple<ShapeArrays...>;
+
+  static constexpr std::size_t NumTypes = sizeof...(ShapeArrays);
+
+  /* Flat index of the first shape of each array, then the shape count */
+  static constexpr std::array<std::size_t, NumTypes + 1> Offsets = [] {
+    std::array<std::size_t, NumTypes + 1> ret{};
+    const std::array<std::size_t, NumTypes> sizes = {
+        std::tuple_size_v<ShapeArrays>...};
+    for (std::size_t k = 0; k < NumTypes; k++)
+      ret[k + 1] = ret[k] + sizes[k];
+    return ret;
+  }();
+
+  static constexpr std::size_t NumShapes = Offsets[NumTypes];
+
+  /* Most hits a ray can have, at least one for a valid buffer */
+  static constexpr std::size_t NumXS = std::max<std::size_t>(
+      (std::size_t{0} + ... +
+       (std::tuple_size_v<ShapeArrays> * ShapeArrays::value_type::MaxHits)),
+      1);
+
+  constexpr TypedWorld(ShapeTupleType&& shapeArgs, LightContType&& lightArgs)
+      : shapes(std::forward<ShapeTupleType>(shapeArgs)),
+        lights(std::forward<LightContType>(lightArgs)) {}
+
+  /*!
+   * \brief All hits of a ray inside its [tMin, tMax] interval, sorted from
+   * near to far.
+   */
+  constexpr auto IntersectWithRay(const Ray& ray) const -> HitBuffer<NumXS> {
+    HitBuffer<NumXS> hits;
+    ForEachType([&]<std::size_t K>() {
+      const auto& array = std::get<K>(shapes);
+      for (std::size_t i = 0; i < array.size(); i++)
+        array[i].IntersectInto(ray, FlatIndex<K>(i), hits);
+    });
+    std::sort(hits.begin(), hits.end(),
+              [](const Hit& lhs, const Hit& rhs) { return lhs.t < rhs.t; });
+    return hits;
+  }
+
+  /* Nearest hit inside the ray interval, see `World::ClosestHit` */
+  constexpr std::optional<Hit> ClosestHit(const Ray& ray) const {
+    std::optional<Hit> closest = std::nullopt;
+    Ray clipped = ray;
+    [&]<std::size_t... K>(std::index_sequence<K...>) {
+      (ClosestHitIn<K>(clipped, closest), ...);
+    }(std::make_index_sequence<NumTypes>{});
+    return closest;
+  }
+
+  /* Any-hit query, returns at the first shape hit inside the ray interval */
+  constexpr bool Occluded(const Ray& ray) const {
+    return [&]<std::size_t... K>(std::index_sequence<K...>) {
+      return (OccludedBy<K>(ray) || ...);
+    }(std::make_index_sequence<NumTypes>{});
+  }
+
+  /* Same as above for hits at t in [EPSILON, tMax] */
+  constexpr bool Occluded(const Ray& ray, Real tMax) const {
+    return Occluded(
+        Ray{ray.GetOrigin(), ray.GetDirection(), Real(EPSILON), tMax});
+  }
+
+  /*!
+   * \brief Call `func` with the concrete shape of flat index `index`,
+   * returning its result.
+   */
+  template <typename Func>
+  constexpr decltype(auto) VisitShape(std::size_t index, Func&& func) const {
+    return VisitShapeOf<0>(index, std::forward<Func>(func));
+  }
+
+  constexpr bool IsShadowed(const Tuple& point, const PointLight& light) const {
+    // direction vector from point to light
+    const Tuple v = (light.position - point);
+    const Real distance = v.Magnitude();
+    const Tuple direction = ToNormalizedVector(v);
+    const Ray shadowRay = Ray(point, direction, Real(EPSILON), distance);
+
+    // Any hit between the point and the light casts a shadow
+    return this->Occluded(shadowRay);
+  }
+
+  /*!
+   * \brief Shade `hit`, `hitRecord` having no `shapePtr`.
+   *
+   * Only the `Lighting` call is dispatched on the shape type: shadow rays run
+   * once for all types, instead of being instantiated again for each of them.
+   */
+  constexpr Colour ShadeHit(const Hit& hit, const HitRecord& hitRecord) const {
+    Colour color = PredefinedColours::BLACK;
+    for (std::size_t i = 0; i < lights.size(); i++) {
+      bool isInShadow = IsShadowed(hitRecord.pointOverSurface, lights[i]);
+      color += VisitShape(hit.shapeIndex, [&](const auto& shape) {
+        return Lighting(shape.GetMaterial(), shape, lights[i],
+                        hitRecord.pointOverSurface, hitRecord.eyeV,
+                        hitRecord.normalV, isInShadow);
+      });
+    }
+    return color;
+  }
+
+  constexpr Colour ColorAt(const Ray& ray) const {
+    const std::optional<Hit> hit = ClosestHit(ray);
+    if (!hit)
+      return PredefinedColours::BLACK;
+    const HitRecord hitRecord =
+        VisitShape(hit->shapeIndex, [&](const auto& shape) {
+          return PrepareHitRecord(hit->t, ray, [&](const Tuple& point) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(shape)>,
+                                         Instance>)
+              return shape.WorldNormalAt(point, hit->primIndex);
+            else
+              return shape.WorldNormalAt(point);
+          });
+        });
+    return ShadeHit(*hit, hitRecord);
+  }
+
+  template <typename ShapeType>
+  constexpr bool ContainShape(const ShapeType& shape) const {
+    bool found = false;
+    ForEachType([&]<std::size_t K>() {
+      using ElemType =
+          typename std::tuple_element_t<K, ShapeTupleType>::value_type;
+      if constexpr (std::is_same_v<ElemType, ShapeType>) {
+        for (const ElemType& elem : std::get<K>(shapes))
+          found = found || shape == elem;
+      }
+    });
+    return found;
+  }
+
+  constexpr ShapeTupleType const& GetShapes() const { return shapes; }
+
+  constexpr LightContType const& GetLights() const { return lights; }
+
+  ShapeTupleType shapes;
+  LightContType lights;
+
+ private:
+  template <std::size_t K>
+  static constexpr std::uint32_t FlatIndex(std::size_t i) {
+    return static_cast<std::uint32_t>(Offsets[K] + i);
+  }
+
+  /* `func.template operator()<K>()` for every array index K, in order */
+  template <typename Func>
+  static constexpr void ForEachType(Func&& func) {
+    [&]<std::size_t... K>(std::index_sequence<K...>) {
+      (func.template operator()<K>(), ...);
+    }(std::make_index_sequence<NumTypes>{});
+  }
+
+  /* Closest hit among the shapes of the K-th array, clipping `clipped` */
+  template <std::size_t K>
+  constexpr void ClosestHitIn(Ray& clipped, std::optional<Hit>& closest) const {
+    using ShapeType =
+        typename std::tuple_element_t<K, ShapeTupleType>::value_type;
+    const auto& array = std::get<K>(shapes);
+    for (std::size_t i = 0; i < array.size(); i++) {
+      HitBuffer<ShapeType::MaxHits> hits;
+      array[i].IntersectInto(clipped, FlatIndex<K>(i), hits);
+      if (!hits.empty()) {
+        closest = hits[0];
+        clipped.ClipTo(hits[0].t);
+      }
+    }
+  }
+
+  template <std::size_t K>
+  constexpr bool OccludedBy(const Ray& ray) const {
+    for (const auto& shape : std::get<K>(shapes)) {
+      if (shape.Occludes(ray))
+        return true;
+    }
+    return false;
+  }
+
+  template <std::size_t K, typename Func>
+  constexpr decltype(auto) VisitShapeOf(std::size_t index, Func&& func) const {
+    // the last array holds every index past the previous ones
+    if constexpr (K + 1 < NumTypes) {
+      if (index >= Offsets[K + 1])
+        return VisitShapeOf<K + 1>(index, std::forward<Func>(func));
+    }
+    return func(std::get<K>(shapes)[index - Offsets[K]]);
+  }
 };
 
 namespace WorldUtils {
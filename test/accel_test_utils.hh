@@ -0,0 +1,133 @@
+#ifndef ACCEL_TEST_UTILS_HH
+#define ACCEL_TEST_UTILS_HH
+#include <gtest/gtest.h>
+#include <accel/linear.hh>
+#include <algorithm>
+#include <array>
+#include <random>
+#include <type_traits>
+#include <vector>
+#include <world.hh>
+namespace RayTracer {
+namespace AccelTestUtils {
+
+/* Random spheres of various sizes in [-10, 10]^3, plus a floor */
+inline std::vector<ShapeWrapper> RandomShapes(std::size_t count,
+                                              unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<Real> position(-10, 10);
+  std::uniform_real_distribution<Real> radius(0.05, 1);
+  std::vector<ShapeWrapper> shapes;
+  shapes.reserve(count + 1);
+  shapes.emplace_back(Plane{MatrixUtils::Translation(0, -11, 0)});
+  for (std::size_t i = 0; i < count; i++) {
+    const Real r = radius(gen);
+    shapes.emplace_back(Sphere{Transform(
+        MatrixUtils::Translation(position(gen), position(gen), position(gen)) *
+        MatrixUtils::Scale(r, r, r))});
+  }
+  return shapes;
+}
+
+/* Rays from random points of [-15, 15]^3 in random directions */
+inline std::vector<Ray> RandomRays(std::size_t count, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<Real> position(-15, 15);
+  std::uniform_real_distribution<Real> direction(-1, 1);
+  std::vector<Ray> rays;
+  for (std::size_t i = 0; i < count; i++)
+    rays.emplace_back(
+        MakePoint(position(gen), position(gen), position(gen)),
+        MakeNormalizedVector(direction(gen), direction(gen), direction(gen)));
+  // axis-aligned directions, with infinite inverse components
+  rays.emplace_back(MakePoint(0, 0, -20), MakeVector(0, 0, 1));
+  rays.emplace_back(MakePoint(0.5, 20, 0.5), MakeVector(0, -1, 0));
+  return rays;
+}
+
+/* Rays from `eye` through random points of the z = 0 square of half side
+ * `extent`, like the pixels of a camera looking at the origin */
+inline std::vector<Ray> EyeRays(std::size_t count, unsigned seed,
+                                const Tuple& eye, Real extent) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<Real> position(-extent, extent);
+  std::vector<Ray> rays;
+  for (std::size_t i = 0; i < count; i++) {
+    const Tuple target = MakePoint(position(gen), position(gen), 0);
+    rays.emplace_back(eye, ToNormalizedVector(target - eye));
+  }
+  return rays;
+}
+
+/*
+ * Results reached along two paths, e.g through an instance or a flattened
+ * copy, agree to EPSILON in double. A float build loses a few ulps relative
+ * to the distance in the sphere quadratic of a far away ray, and a little
+ * more once shaded, so there they agree relative to their magnitude.
+ */
+constexpr Real FloatTolerance = 2e-3;
+
+inline bool Near(Real value, Real expected) {
+  if constexpr (std::is_same_v<Real, float>) {
+    return MathUtils::ConstExprAbsf(value - expected) <=
+           FloatTolerance *
+               std::max(Real(1), MathUtils::ConstExprAbsf(expected));
+  }
+  return MathUtils::ApproxEqual(value, expected);
+}
+
+/* `Near` for every component of a `Tuple` or a `Colour` */
+template <typename VecType>
+bool NearVec(const VecType& value, const VecType& expected) {
+  for (std::size_t i = 0; i < value.contents.size(); i++) {
+    if (!Near(value[i], expected[i]))
+      return false;
+  }
+  return true;
+}
+
+/* `AccelType` reports the same closest hits and shadow rays as LinearAccel */
+template <typename AccelType>
+void ExpectSameQueries(const std::vector<ShapeWrapper>& shapes,
+                       const std::vector<Ray>& rays = RandomRays(1000, 13)) {
+  const AccelType accel{shapes};
+  const LinearAccel linear{shapes};
+  for (const Ray& ray : rays) {
+    const auto expected = linear.ClosestHit(shapes, ray);
+    const auto hit = accel.ClosestHit(shapes, ray);
+    ASSERT_EQ(hit.has_value(), expected.has_value());
+    if (expected) {
+      EXPECT_EQ(hit->shapeIndex, expected->shapeIndex);
+      EXPECT_EQ(hit->primIndex, expected->primIndex);
+      EXPECT_TRUE(Near(hit->t, expected->t));
+    }
+    for (const Real tMax : {Real(1), Real(5), Real(50)}) {
+      const Ray shadow{ray.GetOrigin(), ray.GetDirection(), Real(EPSILON),
+                       tMax};
+      EXPECT_EQ(accel.Occluded(shapes, shadow),
+                linear.Occluded(shapes, shadow));
+    }
+  }
+}
+
+using Lights = std::array<PointLight, 1>;
+
+/* A single white light above the test scenes */
+inline Lights TestLights() {
+  return {PointLight(MakePoint(-10, 30, -10), MakeColour(1, 1, 1))};
+}
+
+/* Both worlds shade every ray alike */
+template <typename WorldType, typename ExpectedWorldType>
+void ExpectSameColours(const WorldType& world,
+                       const ExpectedWorldType& expected,
+                       const std::vector<Ray>& rays) {
+  for (const Ray& ray : rays) {
+    EXPECT_TRUE(NearVec(world.ColorAt(ray), expected.ColorAt(ray)))
+        << world.ColorAt(ray) << " != " << expected.ColorAt(ray);
+  }
+}
+
+}  // namespace AccelTestUtils
+}  // namespace RayTracer
+#endif
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <bounding_box.hh>
+#include <primitives.hh>
+using namespace RayTracer;
+
+TEST(BoundingBox, empty_box_is_identity_of_union) {
+  constexpr BoundingBox empty;
+  static_assert(empty.IsEmpty() && !empty.IsFinite());
+  static_assert(empty.SurfaceArea() == 0);
+  constexpr BoundingBox box{MakePoint(1, 2, 3), MakePoint(-1, 0, 5)};
+  static_assert(box.lower == MakePoint(-1, 0, 3));
+  static_assert(box.upper == MakePoint(1, 2, 5));
+  static_assert(Union(empty, box) == box && Union(box, empty) == box);
+  constexpr auto grown = Union(box, MakePoint(4, -1, 4));
+  static_assert(grown == BoundingBox{MakePoint(-1, -1, 3), MakePoint(4, 2, 5)});
+}
+
+TEST(BoundingBox, measures) {
+  constexpr BoundingBox box{MakePoint(0, 0, 0), MakePoint(1, 2, 3)};
+  static_assert(box.SurfaceArea() == 22);
+  static_assert(box.Centroid() == MakePoint(0.5, 1, 1.5));
+  static_assert(box.MaximumExtent() == TupleConstants::z);
+  static_assert(box.Corner(0) == box.lower && box.Corner(7) == box.upper);
+  static_assert(box.Corner(5) == MakePoint(1, 0, 3));
+  static_assert(box.Contains(MakePoint(1, 1, 1)));
+  static_assert(!box.Contains(MakePoint(1, 1, 4)));
+}
+
+TEST(BoundingBox, transform_encloses_transformed_corners) {
+  constexpr BoundingBox unit{MakePoint(-1, -1, -1), MakePoint(1, 1, 1)};
+  constexpr auto moved = unit.Transform(AffineTransform(
+      MatrixUtils::Translation(1, 2, 3) * MatrixUtils::Scale(2, 1, 1)));
+  static_assert(moved == BoundingBox{MakePoint(-1, 1, 2), MakePoint(3, 3, 4)});
+  constexpr auto rotated = unit.Transform(
+      AffineTransform(MatrixUtils::RotateY(MathUtils::MathConstants::PI<> / 4)));
+  constexpr Real diagonal = 1.4142135623730951;
+  EXPECT_EQ(rotated, BoundingBox(MakePoint(-diagonal, -1, -diagonal),
+                                 MakePoint(diagonal, 1, diagonal)));
+  static_assert(!BoundingBox::Infinite().IsFinite());
+  static_assert(!BoundingBox::Infinite()
+                     .Transform(AffineTransform(MatrixUtils::RotateX(1)))
+                     .IsFinite());
+}
+
+TEST(BoundingBox, slab_test) {
+  constexpr BoundingBox box{MakePoint(-1, -1, -1), MakePoint(1, 1, 1)};
+  struct Case {
+    Ray ray;
+    bool hit;
+  };
+  constexpr std::array cases = {
+      Case{Ray{MakePoint(0, 0, -5), MakeVector(0, 0, 1)}, true},
+      Case{Ray{MakePoint(0.5, 0, 0), MakeVector(0, 0, 1)}, true},
+      Case{Ray{MakePoint(0, 2, -5), MakeVector(0, 0, 1)}, false},
+      Case{Ray{MakePoint(0, 0, 5), MakeVector(0, 0, 1)}, false},
+      Case{Ray{MakePoint(0, 0, 5), MakeVector(0, 0, -1)}, true},
+      Case{Ray{MakePoint(-3, -3, -3), MakeNormalizedVector(1, 1, 1)}, true},
+      Case{Ray{MakePoint(3, 3, -3), MakeNormalizedVector(-1, -1, 1)}, true},
+      Case{Ray{MakePoint(3, 3, -3), MakeNormalizedVector(-1, 1, 1)}, false},
+      // the interval of the ray is honoured
+      Case{Ray{MakePoint(0, 0, -5), MakeVector(0, 0, 1), 0, 3.9}, false},
+      Case{Ray{MakePoint(0, 0, -5), MakeVector(0, 0, 1), 0, 4.1}, true},
+      Case{Ray{MakePoint(0, 0, -5), MakeVector(0, 0, 1), 6.1, 10}, false},
+      // rays lying on a face of the box, parallel to two of the slabs
+      Case{Ray{MakePoint(1, 0, -5), MakeVector(0, 0, 1)}, true},
+      Case{Ray{MakePoint(-1, -1, 5), MakeVector(0, 0, -1)}, true},
+      Case{Ray{MakePoint(1.01, 0, -5), MakeVector(0, 0, 1)}, false}};
+  // the constant-evaluated and the SIMD run-time path agree
+  static_assert(std::all_of(cases.begin(), cases.end(), [&](const Case& c) {
+    return box.IntersectP(c.ray) == c.hit;
+  }));
+  for (const Case& c : cases)
+    EXPECT_EQ(box.IntersectP(c.ray), c.hit) << c.ray.GetOrigin();
+}
+
+TEST(BoundingBox, shape_bounds) {
+  constexpr Sphere sphere{Transform(MatrixUtils::Translation(2, 0, 0) *
+                                    MatrixUtils::Scale(0.5, 0.5, 0.5))};
+  static_assert(sphere.Bounds() ==
+                BoundingBox{MakePoint(-1, -1, -1), MakePoint(1, 1, 1)});
+  static_assert(sphere.WorldBounds() == BoundingBox{MakePoint(1.5, -0.5, -0.5),
+                                                    MakePoint(2.5, 0.5, 0.5)});
+  constexpr Plane plane;
+  static_assert(!plane.Bounds().IsFinite() && !plane.WorldBounds().IsFinite());
+  static constexpr ShapeWrapper wrapper{sphere};
+  static_assert(wrapper.WorldBounds() == sphere.WorldBounds());
+  static_assert(wrapper.Bounds() == sphere.Bounds());
+  // ShapeTraits tell which shapes acceleration structures can hold
+  static_assert(Sphere::Bounded && wrapper.IsBounded());
+  static_assert(!Plane::Bounded && !ShapeWrapper{plane}.IsBounded());
+}
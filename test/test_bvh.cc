@@ -0,0 +1,272 @@
+#include <gtest/gtest.h>
+#include <accel/bvh.hh>
+#include <accel_test_utils.hh>
+#include <bit>
+#include <random>
+#include <vector>
+#include <world.hh>
+using namespace RayTracer;
+using namespace RayTracer::AccelTestUtils;
+
+namespace {
+
+/* Every shape but the floor lies in exactly one leaf, enclosed by it and by
+ * all of its ancestors */
+template <typename BVHType>
+void ExpectEnclosingTree(const BVHType& bvh,
+                         const std::vector<ShapeWrapper>& shapes) {
+  const auto& nodes = bvh.GetNodes();
+  const auto& indices = bvh.GetShapeIndices();
+  ASSERT_EQ(bvh.GetUnbounded().size(), 1);
+  EXPECT_EQ(bvh.GetUnbounded()[0], 0);
+  ASSERT_EQ(indices.size(), shapes.size() - 1);
+  ASSERT_LE(nodes.size(), 2 * indices.size() - 1);
+
+  std::vector<int> seen(shapes.size(), 0);
+  for (std::size_t i = 0; i < nodes.size(); i++) {
+    const BVHNode& node = nodes[i];
+    if (node.IsLeaf()) {
+      EXPECT_LE(node.count, BVHType::MaxLeafSize);
+      for (std::size_t j = 0; j < node.count; j++) {
+        const auto index = indices[node.offset + j];
+        seen[index]++;
+        const BoundingBox bounds = shapes[index].WorldBounds();
+        EXPECT_EQ(Union(node.bounds, bounds), node.bounds);
+      }
+    } else {
+      ASSERT_GT(node.offset, i + 1);
+      EXPECT_EQ(Union(nodes[i + 1].bounds, nodes[node.offset].bounds),
+                node.bounds);
+    }
+  }
+  for (std::size_t i = 1; i < shapes.size(); i++)
+    EXPECT_EQ(seen[i], 1);
+}
+
+}  // namespace
+
+TEST(BVH, nodes_enclose_their_shapes) {
+  const auto shapes = RandomShapes(500, 7);
+  const BVH bvh{shapes};
+  ExpectEnclosingTree(bvh, shapes);
+  // SAH cost of a tree is far below testing every shape
+  EXPECT_LT(bvh.SAHCost(), 500 / 10);
+}
+
+TEST(BVH, queries_match_linear_scan) {
+  ExpectSameQueries<BVH>(RandomShapes(300, 11), RandomRays(2000, 13));
+}
+
+TEST(BVH, degenerate_inputs) {
+  // no shape at all, and only unbounded shapes
+  const std::vector<ShapeWrapper> none;
+  const Ray ray{MakePoint(0, 1, 0), MakeVector(0, -1, 0)};
+  EXPECT_FALSE(BVH{none}.ClosestHit(none, ray).has_value());
+  std::vector<ShapeWrapper> planes;
+  planes.emplace_back(Plane{});
+  const BVH planeBvh{planes};
+  EXPECT_TRUE(planeBvh.GetNodes().empty());
+  EXPECT_EQ(planeBvh.ClosestHit(planes, ray)->t, 1);
+  // coincident shapes leave no split, and still end in small leaves
+  std::vector<ShapeWrapper> stacked;
+  for (int i = 0; i < 40; i++)
+    stacked.emplace_back(Sphere{});
+  const BVH stackedBvh{stacked};
+  for (const BVHNode& node : stackedBvh.GetNodes())
+    EXPECT_LE(node.count, BVH::MaxLeafSize);
+  const Ray towards{MakePoint(0, 0, -5), MakeVector(0, 0, 1)};
+  const auto hit = stackedBvh.ClosestHit(stacked, towards);
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_EQ(hit->t, 4);
+}
+
+TEST(LBVH, morton_codes) {
+  using BVHUtils::EncodeMorton;
+  static_assert(EncodeMorton(0, 0, 0) == 0);
+  // x takes the highest bit of each triple, z the lowest
+  static_assert(EncodeMorton(1, 0, 0) == 0b100);
+  static_assert(EncodeMorton(0, 1, 0) == 0b010);
+  static_assert(EncodeMorton(0, 0, 1) == 0b001);
+  static_assert(EncodeMorton(3, 0, 2) == 0b101'100);
+  constexpr BVHUtils::MortonCode gridMax =
+      (BVHUtils::MortonCode{1} << BVHUtils::MortonBitsPerAxis) - 1;
+  static_assert(std::bit_width(EncodeMorton(gridMax, gridMax, gridMax)) ==
+                3 * BVHUtils::MortonBitsPerAxis);
+  static_assert(BVHUtils::MortonAxis(2) == TupleConstants::x &&
+                BVHUtils::MortonAxis(4) == TupleConstants::y &&
+                BVHUtils::MortonAxis(6) == TupleConstants::z);
+}
+
+TEST(LBVH, radix_sort_is_stable) {
+  std::mt19937 gen(17);
+  std::uniform_int_distribution<BVHUtils::MortonCode> code(0, 1 << 12);
+  // enough entries to be sorted in several chunks
+  std::vector<BVHUtils::MortonEntry> items(100000);
+  for (std::size_t i = 0; i < items.size(); i++)
+    items[i] = {code(gen) << 20, static_cast<std::uint32_t>(i)};
+  BVHUtils::RadixSort(items);
+  for (std::size_t i = 1; i < items.size(); i++) {
+    ASSERT_TRUE(items[i - 1].code < items[i].code ||
+                (items[i - 1].code == items[i].code &&
+                 items[i - 1].entry < items[i].entry));
+  }
+}
+
+TEST(LBVH, nodes_enclose_their_shapes) {
+  // several treelets, spliced below the top levels
+  const auto shapes = RandomShapes(20000, 7);
+  ExpectEnclosingTree(LBVH{shapes}, shapes);
+  ExpectEnclosingTree(LBVH{RandomShapes(500, 9)}, RandomShapes(500, 9));
+}
+
+TEST(LBVH, queries_match_linear_scan) {
+  for (const std::size_t count : {300, 5000})
+    ExpectSameQueries<LBVH>(RandomShapes(count, 11), RandomRays(500, 13));
+  // coincident shapes share one Morton code, and still end in small leaves
+  std::vector<ShapeWrapper> stacked(40, ShapeWrapper{Sphere{}});
+  const LBVH stackedBvh{stacked};
+  for (const BVHNode& node : stackedBvh.GetNodes())
+    EXPECT_LE(node.count, LBVH::MaxLeafSize);
+  const auto hit = stackedBvh.ClosestHit(
+      stacked, Ray{MakePoint(0, 0, -5), MakeVector(0, 0, 1)});
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_EQ(hit->t, 4);
+}
+
+namespace {
+
+/* Move every sphere of `shapes` by a random offset of at most `step` */
+void Jitter(std::vector<ShapeWrapper>& shapes, Real step, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<Real> offset(-step, step);
+  for (std::size_t i = 1; i < shapes.size(); i++) {
+    shapes[i].SetTransform(
+        MatrixUtils::Translation(offset(gen), offset(gen), offset(gen)) *
+        shapes[i].GetTransform());
+  }
+}
+
+}  // namespace
+
+TEST(BVH, refit_follows_moved_shapes) {
+  // enough nodes for subtrees to be refitted as separate tasks
+  auto shapes = RandomShapes(8000, 21);
+  BVH bvh{shapes};
+  const auto nodeCount = bvh.GetNodes().size();
+  Jitter(shapes, 0.5, 4);
+  ASSERT_TRUE(bvh.Refit(shapes));
+  EXPECT_EQ(bvh.GetNodes().size(), nodeCount);
+  ExpectEnclosingTree(bvh, shapes);
+  const LinearAccel linear{shapes};
+  for (const Ray& ray : RandomRays(300, 8)) {
+    const auto expected = linear.ClosestHit(shapes, ray);
+    const auto hit = bvh.ClosestHit(shapes, ray);
+    ASSERT_EQ(hit.has_value(), expected.has_value());
+    if (expected) {
+      EXPECT_EQ(hit->shapeIndex, expected->shapeIndex);
+    }
+  }
+  // small moves keep the tree, which stays close to its built quality
+  EXPECT_FALSE(bvh.Update(shapes));
+  EXPECT_LE(bvh.SAHCost(), BVH::RebuildThreshold * bvh.BuiltSAHCost());
+}
+
+TEST(BVH, update_rebuilds_degraded_or_mismatched_trees) {
+  auto shapes = RandomShapes(500, 2);
+  LBVH lbvh{shapes};
+  // shapes scattered across the scene leave refitted nodes overlapping
+  Jitter(shapes, 20, 6);
+  LBVH refitted = lbvh;
+  ASSERT_TRUE(refitted.Refit(shapes));
+  EXPECT_GT(refitted.SAHCost(), LBVH::RebuildThreshold * lbvh.BuiltSAHCost());
+  EXPECT_TRUE(lbvh.Update(shapes));
+  EXPECT_LE(lbvh.SAHCost(), LBVH::RebuildThreshold * lbvh.BuiltSAHCost());
+  ExpectEnclosingTree(lbvh, shapes);
+  // the tree was not built from these shapes
+  shapes.emplace_back(Sphere{});
+  EXPECT_FALSE(lbvh.Refit(shapes));
+  EXPECT_TRUE(lbvh.Update(shapes));
+  EXPECT_EQ(lbvh.GetShapeIndices().size(), shapes.size() - 1);
+}
+
+TEST(BVH, world_updates_its_accelerator) {
+  World<std::vector<ShapeWrapper>, Lights, 10, BVH> world{RandomShapes(100, 3),
+                                                          TestLights()};
+  Jitter(world.shapes, 1, 12);
+  world.UpdateAccelerator();
+  World<std::vector<ShapeWrapper>, Lights> linearWorld{
+      std::vector<ShapeWrapper>(world.shapes), TestLights()};
+  EXPECT_FALSE(linearWorld.UpdateAccelerator());
+  ExpectSameColours(world, linearWorld, RandomRays(300, 5));
+}
+
+TEST(BVH, world_renders_like_linear_world) {
+  const auto shapes = RandomShapes(100, 3);
+  World<std::vector<ShapeWrapper>, Lights, 10, BVH> bvhWorld{
+      std::vector<ShapeWrapper>(shapes), TestLights()};
+  World<std::vector<ShapeWrapper>, Lights> linearWorld{
+      std::vector<ShapeWrapper>(shapes), TestLights()};
+  ExpectSameColours(bvhWorld, linearWorld, RandomRays(500, 5));
+}
+
+namespace {
+
+/* A row of spheres over a floor, built as a constant expression */
+template <typename AccelType>
+constexpr auto ConstexprGrid() {
+  constexpr std::size_t numSpheres = 12;
+  std::array<ShapeWrapper, numSpheres + 1> shapes = {Plane{}, Sphere{}, Sphere{},
+      Sphere{}, Sphere{}, Sphere{}, Sphere{}, Sphere{}, Sphere{}, Sphere{},
+      Sphere{}, Sphere{}, Sphere{}};
+  for (std::size_t i = 0; i < numSpheres; i++) {
+    const Real x = Real(3) * (Real(i % 4) - Real(1.5));
+    const Real z = Real(3) * Real(i / 4);
+    shapes[i + 1] = Sphere{MatrixUtils::Translation(x, 1, z)};
+  }
+  std::array<PointLight, 1> lights = {
+      PointLight(MakePoint(-10, 10, -10), MakeColour(1, 1, 1))};
+  return World<decltype(shapes), decltype(lights), 2 * numSpheres + 1,
+               AccelType>{std::move(shapes), std::move(lights)};
+}
+
+}  // namespace
+
+TEST(BVH, static_bvh_in_constexpr_world) {
+  constexpr auto static linearWorld = ConstexprGrid<LinearAccel>();
+  constexpr auto static bvhWorld = ConstexprGrid<StaticBVH<13>>();
+  constexpr const auto& bvh = bvhWorld.GetAccelerator();
+  static_assert(bvh.GetUnbounded().size() == 1);
+  static_assert(bvh.GetShapeIndices().size() == 12);
+  static_assert(bvh.GetNodes().size() <= BVHUtils::MaxNodes(12));
+
+  // the constexpr traversal finds the same hits and colours as the scan
+  constexpr Ray center{MakePoint(0, 1, -10), MakeVector(0, 0, 1)};
+  static_assert(bvhWorld.ClosestHit(center) == linearWorld.ClosestHit(center));
+  constexpr Ray slanted{MakePoint(-6, 5, -8), MakeNormalizedVector(1, -0.4, 1)};
+  static_assert(bvhWorld.ColorAt(slanted) == linearWorld.ColorAt(slanted));
+  constexpr Ray down{MakePoint(4.5, 10, 6), MakeVector(0, -1, 0)};
+  static_assert(bvhWorld.ClosestHit(down)->GetIntersectDistance() == 8);
+  static_assert(bvhWorld.ColorAt(down) == linearWorld.ColorAt(down));
+  static_assert(bvhWorld.IsShadowed(MakePoint(4.5, -0.5, 6),
+                                    bvhWorld.GetLights()[0]) ==
+                linearWorld.IsShadowed(MakePoint(4.5, -0.5, 6),
+                                       linearWorld.GetLights()[0]));
+
+  // a Morton build at compile time gives the same answers
+  constexpr auto static lbvhWorld =
+      ConstexprGrid<StaticBVH<13, BVHBuilder::Morton>>();
+  static_assert(lbvhWorld.GetAccelerator().GetShapeIndices().size() == 12);
+  static_assert(lbvhWorld.ClosestHit(center) == linearWorld.ClosestHit(center));
+  static_assert(lbvhWorld.ColorAt(slanted) == linearWorld.ColorAt(slanted));
+  static_assert(lbvhWorld.ColorAt(down) == linearWorld.ColorAt(down));
+
+  // refitting at compile time after moving a sphere out of the row
+  constexpr auto moved = [] {
+    auto world = ConstexprGrid<StaticBVH<13>>();
+    world.shapes[1].SetTransform(MatrixUtils::Translation(0, 1, -5));
+    const bool rebuilt = world.UpdateAccelerator();
+    const Ray ray{MakePoint(0, 1, -10), MakeVector(0, 0, 1)};
+    return std::pair{rebuilt, world.ClosestHit(ray)->GetIntersectDistance()};
+  }();
+  static_assert(!moved.first && moved.second == 4);
+}
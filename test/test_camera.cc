@@ -6,7 +6,7 @@ using testing::Eq;
 TEST(Camera, constrctor) {
   constexpr std::size_t hsize = 160;
   constexpr std::size_t vsize = 120;
-  constexpr auto fov = MathUtils::MathConstants::PI<double> * 0.5;
+  constexpr auto fov = MathUtils::MathConstants::PI<Real> / 2;
   constexpr Camera c{hsize, vsize, fov};
 
   EXPECT_EQ(c.HorizontalSize(), hsize);
@@ -19,23 +19,23 @@ TEST(Camera, constrctor) {
 TEST(Camera, pixel_size_horizontal) {
   constexpr std::size_t hsize = 200;
   constexpr std::size_t vsize = 125;
-  constexpr auto fov = MathUtils::MathConstants::PI<double> * 0.5;
+  constexpr auto fov = MathUtils::MathConstants::PI<Real> / 2;
   constexpr Camera c{hsize, vsize, fov};
-  EXPECT_EQ(c.PixelSize(), 0.01);
+  EXPECT_EQ(c.PixelSize(), Real(0.01));
 }
 
 TEST(Camera, pixel_size_vertical) {
   constexpr std::size_t hsize = 125;
   constexpr std::size_t vsize = 200;
-  constexpr auto fov = MathUtils::MathConstants::PI<double> * 0.5;
+  constexpr auto fov = MathUtils::MathConstants::PI<Real> / 2;
   constexpr Camera c{hsize, vsize, fov};
-  EXPECT_EQ(c.PixelSize(), 0.01);
+  EXPECT_EQ(c.PixelSize(), Real(0.01));
 }
 
 TEST(Camera, ray_through_corner) {
   constexpr std::size_t hsize = 201;
   constexpr std::size_t vsize = 101;
-  constexpr auto fov = MathUtils::MathConstants::PI<double> * 0.5;
+  constexpr auto fov = MathUtils::MathConstants::PI<Real> / 2;
   constexpr Camera c{hsize, vsize, fov};
   const auto ray = c.RayForPixel(0, 0);
   EXPECT_EQ(ray.GetOrigin(), PredefinedTuples::ZeroPoint);
@@ -45,7 +45,7 @@ TEST(Camera, ray_through_corner) {
 TEST(Camera, transform_camera) {
   constexpr std::size_t hsize = 201;
   constexpr std::size_t vsize = 101;
-  constexpr auto fov = MathUtils::MathConstants::PI<double> * 0.5;
+  constexpr auto fov = MathUtils::MathConstants::PI<Real> / 2;
   constexpr auto pi = MathUtils::MathConstants::PI<double>;
   constexpr auto transform =
       MatrixUtils::RotateY(pi / 4.0) * MatrixUtils::Translation(0, -2, 5);
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include <accel/grid.hh>
+#include <accel_test_utils.hh>
+#include <random>
+#include <vector>
+#include <world.hh>
+using namespace RayTracer;
+using namespace RayTracer::AccelTestUtils;
+
+namespace {
+
+/* Small spheres of similar size in [-10, 10]^3, plus a floor */
+std::vector<ShapeWrapper> Particles(std::size_t count, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<Real> position(-10, 10);
+  std::uniform_real_distribution<Real> radius(0.1, 0.3);
+  std::vector<ShapeWrapper> shapes;
+  shapes.emplace_back(Plane{MatrixUtils::Translation(0, -11, 0)});
+  for (std::size_t i = 0; i < count; i++) {
+    const Real r = radius(gen);
+    shapes.emplace_back(Sphere{Transform(
+        MatrixUtils::Translation(position(gen), position(gen), position(gen)) *
+        MatrixUtils::Scale(r, r, r))});
+  }
+  return shapes;
+}
+
+/* Two tight clusters far apart, mostly empty space in between */
+std::vector<ShapeWrapper> Clusters(std::size_t count, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<Real> position(-1, 1);
+  std::vector<ShapeWrapper> shapes;
+  for (std::size_t i = 0; i < count; i++) {
+    const Real offset = i % 2 == 0 ? -40 : 40;
+    shapes.emplace_back(Sphere{Transform(
+        MatrixUtils::Translation(position(gen) + offset, position(gen),
+                                 position(gen)) *
+        MatrixUtils::Scale(0.05, 0.05, 0.05))});
+  }
+  return shapes;
+}
+
+/* Shared random rays, plus one grazing the floor of the particles */
+std::vector<Ray> GridRays() {
+  std::vector<Ray> rays = RandomRays(1000, 13);
+  rays.emplace_back(MakePoint(-60, 0.01, 0.02), MakeVector(1, 0, 0));
+  return rays;
+}
+
+}  // namespace
+
+TEST(Grid, cells_list_every_overlapping_shape) {
+  const auto shapes = Particles(2000, 7);
+  const UniformGrid grid{shapes};
+  ASSERT_EQ(grid.GetUnbounded().size(), 1);
+  const auto& resolution = grid.GetResolution();
+  const std::size_t numCells =
+      static_cast<std::size_t>(resolution[0]) * resolution[1] * resolution[2];
+  EXPECT_EQ(grid.NumKeys(), numCells);
+  // about `CellsPerShape` cells per particle
+  EXPECT_GT(numCells, 2000);
+  EXPECT_LT(numCells, 2 * 2 * 2000);
+  std::vector<int> seen(shapes.size(), 0);
+  for (const std::uint32_t index : grid.GetCellShapes())
+    seen[index]++;
+  EXPECT_EQ(seen[0], 0);
+  for (std::size_t i = 1; i < shapes.size(); i++)
+    EXPECT_GE(seen[i], 1);
+
+  // hashed cells only grow with the particles, not with the empty space
+  const auto clusters = Clusters(2000, 3);
+  const HashedGrid hashed{clusters};
+  EXPECT_LE(hashed.NumKeys(), hashed.GetCellShapes().size());
+  EXPECT_GT(hashed.GetResolution()[0], 8 * hashed.GetResolution()[1]);
+}
+
+TEST(Grid, queries_match_linear_scan) {
+  const auto particles = Particles(500, 11);
+  ExpectSameQueries<UniformGrid>(particles, GridRays());
+  ExpectSameQueries<HashedGrid>(particles, GridRays());
+  const auto clusters = Clusters(300, 5);
+  ExpectSameQueries<UniformGrid>(clusters, GridRays());
+  ExpectSameQueries<HashedGrid>(clusters, GridRays());
+}
+
+TEST(Grid, large_shapes_stay_out_of_the_cells) {
+  // one sphere spanning the clusters would be listed in most fine cells
+  auto shapes = Clusters(500, 3);
+  shapes.emplace_back(Sphere{MatrixUtils::Scale(50, 50, 50)});
+  const HashedGrid hashed{shapes};
+  ASSERT_EQ(hashed.GetLarge().size(), 1);
+  EXPECT_EQ(hashed.GetLarge()[0], 500u);
+  EXPECT_LE(hashed.GetCellShapes().size(),
+            HashedGrid::MaxCellsPerShape * shapes.size());
+  // the clusters keep about as many cell references as on their own
+  EXPECT_LE(hashed.GetCellShapes().size(),
+            2 * HashedGrid{Clusters(500, 3)}.GetCellShapes().size());
+  ExpectSameQueries<HashedGrid>(shapes, RandomRays(300, 13));
+  // many large shapes coarsen the cells rather than be tested on every query
+  auto big = Clusters(1000, 3);
+  for (int i = 0; i < 20; i++) {
+    big.emplace_back(
+        Sphere{MatrixUtils::Translation(Real(i % 5) - 42, Real(i / 5) - 2, 0)});
+  }
+  const HashedGrid coarse{big};
+  EXPECT_LE(coarse.GetLarge().size() * HashedGrid::LargeShapeRatio,
+            big.size());
+  EXPECT_LE(coarse.GetCellShapes().size(),
+            HashedGrid::MaxCellsPerShape * big.size());
+  ExpectSameQueries<UniformGrid>(big, RandomRays(300, 13));
+  ExpectSameQueries<HashedGrid>(big, RandomRays(300, 13));
+}
+
+TEST(Grid, degenerate_inputs) {
+  const Ray ray{MakePoint(0, 1, 0), MakeVector(0, -1, 0)};
+  const std::vector<ShapeWrapper> none;
+  EXPECT_FALSE(UniformGrid{none}.ClosestHit(none, ray).has_value());
+  std::vector<ShapeWrapper> planes;
+  planes.emplace_back(Plane{});
+  EXPECT_EQ(HashedGrid{planes}.ClosestHit(planes, ray)->t, 1);
+  // a single shape in a single cell
+  const std::vector<ShapeWrapper> one{ShapeWrapper{Sphere{}}};
+  const UniformGrid single{one};
+  EXPECT_EQ(single.GetResolution()[0], 2);
+  EXPECT_EQ(single.ClosestHit(one, Ray{MakePoint(0, 0, -5),
+                                       MakeVector(0, 0, 1)})->t, 4);
+  // flat layout, the grid has no depth along z
+  std::vector<ShapeWrapper> row;
+  for (int i = 0; i < 10; i++) {
+    row.emplace_back(Sphere{Transform(MatrixUtils::Translation(Real(i), 0, 0) *
+                                      MatrixUtils::Scale(0.25, 0.25, 0.25))});
+  }
+  ExpectSameQueries<UniformGrid>(row, GridRays());
+  ExpectSameQueries<HashedGrid>(row, GridRays());
+}
+
+TEST(Grid, constexpr_traversal) {
+  constexpr auto closest = [](bool hashed) {
+    std::vector<ShapeWrapper> shapes;
+    for (int i = 0; i < 20; i++) {
+      shapes.emplace_back(Sphere{MatrixUtils::Translation(
+          Real(3 * (i % 5)), Real(3 * (i / 5)), Real(i % 3))});
+    }
+    const Ray ray{MakePoint(6, 6, -10), MakeNormalizedVector(0.01, 0.02, 1)};
+    const auto hit = hashed ? HashedGrid{shapes}.ClosestHit(shapes, ray)
+                            : UniformGrid{shapes}.ClosestHit(shapes, ray);
+    return hit ? hit->shapeIndex : std::uint32_t(-1);
+  };
+  static_assert(closest(false) == 12u);
+  static_assert(closest(true) == 12u);
+}
+
+TEST(Grid, world_renders_like_linear_world) {
+  const auto shapes = Particles(300, 3);
+  using Shapes = std::vector<ShapeWrapper>;
+  World<Shapes, Lights> linearWorld{Shapes(shapes), TestLights()};
+  World<Shapes, Lights, 10, UniformGrid> gridWorld{Shapes(shapes),
+                                                   TestLights()};
+  World<Shapes, Lights, 10, HashedGrid> hashedWorld{Shapes(shapes),
+                                                    TestLights()};
+  ExpectSameColours(gridWorld, linearWorld, RandomRays(500, 5));
+  ExpectSameColours(hashedWorld, linearWorld, RandomRays(500, 5));
+  // moved shapes are binned again
+  gridWorld.shapes[1].SetTransform(MatrixUtils::Translation(0, 0, 0));
+  EXPECT_TRUE(gridWorld.UpdateAccelerator());
+  const Ray ray{MakePoint(0, 0, -20), MakeVector(0, 0, 1)};
+  EXPECT_EQ(gridWorld.ClosestHit(ray)->t, 19);
+}
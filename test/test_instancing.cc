@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <accel/instancing.hh>
+#include <accel_test_utils.hh>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <world.hh>
+using namespace RayTracer;
+using namespace RayTracer::AccelTestUtils;
+
+namespace {
+
+using Shapes = std::vector<ShapeWrapper>;
+
+/* A small cluster of spheres around the origin */
+Shapes MakeAsset() {
+  Shapes shapes;
+  for (int i = 0; i < 6; i++) {
+    shapes.emplace_back(Sphere{Transform(
+        MatrixUtils::Translation(Real(i % 3) - 1, Real(i / 3), 0) *
+        MatrixUtils::Scale(0.4, 0.6, 0.4))});
+  }
+  return shapes;
+}
+
+std::vector<Transform> MakePlacements(std::size_t count, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<Real> position(-10, 10);
+  std::uniform_real_distribution<Real> angle(0, 6);
+  std::uniform_real_distribution<Real> scale(0.5, 1.5);
+  std::vector<Transform> placements;
+  for (std::size_t i = 0; i < count; i++) {
+    placements.push_back(Transform(
+        MatrixUtils::Translation(position(gen), position(gen), position(gen)) *
+        MatrixUtils::RotateY(angle(gen)) *
+        MatrixUtils::Scale(scale(gen), scale(gen), scale(gen))));
+  }
+  return placements;
+}
+
+}  // namespace
+
+TEST(Instancing, geometry_bounds_and_queries) {
+  const SharedGeometry geometry{MakeAsset()};
+  EXPECT_EQ(geometry.Bounds(),
+            BoundingBox(MakePoint(-1.4, -0.6, -0.4), MakePoint(1.4, 1.6, 0.4)));
+  const Ray ray{MakePoint(1, 1, -5), MakeVector(0, 0, 1)};
+  const auto hit = geometry.ClosestHit(ray);
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_EQ(hit->shapeIndex, 5u);
+  EXPECT_TRUE(MathUtils::ApproxEqual(hit->t, Real(4.6)));
+  EXPECT_TRUE(geometry.Occluded(ray));
+  EXPECT_FALSE(geometry.Occluded(Ray{MakePoint(3, 1, -5), MakeVector(0, 0, 1)}));
+
+  // planes make the geometry unbounded, and its instances too
+  const SharedGeometry floor{Shapes{ShapeWrapper{Plane{}}}};
+  EXPECT_FALSE(floor.Bounds().IsFinite());
+  const Shapes instances{ShapeWrapper{Instance{floor}},
+                         ShapeWrapper{Instance{geometry}}};
+  const BVH bvh{instances};
+  ASSERT_EQ(bvh.GetUnbounded().size(), 1);
+  EXPECT_EQ(bvh.GetUnbounded()[0], 0u);
+}
+
+TEST(Instancing, nested_instances_are_rejected) {
+  const SharedGeometry geometry{MakeAsset()};
+  EXPECT_THROW(SharedGeometry{Shapes{ShapeWrapper{Instance{geometry}}}},
+               std::invalid_argument);
+}
+
+TEST(Instancing, instance_hits_carry_the_geometry_shape) {
+  const SharedGeometry geometry{MakeAsset()};
+  const Instance instance{geometry, MatrixUtils::Translation(0, 0, 10)};
+  HitBuffer<Instance::MaxHits> hits;
+  instance.IntersectInto(Ray{MakePoint(1, 1, -5), MakeVector(0, 0, 1)}, 3,
+                         hits);
+  ASSERT_EQ(hits.size(), 1);
+  EXPECT_EQ(hits[0].shapeIndex, 3u);
+  EXPECT_EQ(hits[0].primIndex, 5u);
+  EXPECT_TRUE(MathUtils::ApproxEqual(hits[0].t, Real(14.6)));
+  // the normal is the one of the sphere hit, facing the ray
+  const ShapeWrapper wrapped{instance};
+  EXPECT_EQ(wrapped.GetWorldNormalAt(MakePoint(1, 1, 9.6), hits[0].primIndex),
+            MakeVector(0, 0, -1));
+  EXPECT_EQ(wrapped.GetShapeType(), InstanceTag);
+  EXPECT_TRUE(wrapped == ShapeWrapper{instance});
+  EXPECT_FALSE(wrapped == ShapeWrapper{Instance{geometry}});
+}
+
+TEST(Instancing, world_renders_like_flattened_copies) {
+  const Shapes asset = MakeAsset();
+  const SharedGeometry geometry{asset};
+  Shapes flat;
+  Shapes instances;
+  flat.emplace_back(Plane{MatrixUtils::Translation(0, -11, 0)});
+  instances.emplace_back(Plane{MatrixUtils::Translation(0, -11, 0)});
+  for (const Transform& placement : MakePlacements(40, 5)) {
+    instances.emplace_back(Instance{geometry, placement});
+    for (const ShapeWrapper& shape : asset) {
+      ShapeWrapper copy = shape;
+      copy.SetTransform(Transform(placement * shape.GetTransform()));
+      flat.push_back(copy);
+    }
+  }
+  World<Shapes, Lights, 10, BVH> flatWorld{Shapes(flat), TestLights()};
+  World<Shapes, Lights, 10, BVH> instancedWorld{Shapes(instances),
+                                                TestLights()};
+  // the top level only holds one shape per instance
+  EXPECT_LT(instancedWorld.GetAccelerator().GetNodes().size(),
+            flatWorld.GetAccelerator().GetNodes().size());
+  for (const Ray& ray : RandomRays(1000, 9)) {
+    const auto expected = flatWorld.ClosestHit(ray);
+    const auto hit = instancedWorld.ClosestHit(ray);
+    ASSERT_EQ(hit.has_value(), expected.has_value());
+    if (expected) {
+      EXPECT_TRUE(Near(hit->t, expected->t));
+      EXPECT_TRUE(NearVec(hit->PrepareComputation(ray).normalV,
+                          expected->PrepareComputation(ray).normalV));
+    }
+  }
+  ExpectSameColours(instancedWorld, flatWorld, RandomRays(1000, 9));
+}
+
+TEST(Instancing, constexpr_instanced_world) {
+  constexpr auto closest = [] {
+    std::vector<ShapeWrapper> asset;
+    asset.emplace_back(Sphere{});
+    asset.emplace_back(Sphere{MatrixUtils::Translation(3, 0, 0)});
+    const SharedGeometry geometry{std::move(asset)};
+    std::vector<ShapeWrapper> shapes;
+    for (int i = 0; i < 4; i++)
+      shapes.emplace_back(
+          Instance{geometry, MatrixUtils::Translation(0, Real(3 * i), 0)});
+    const BVH tlas{shapes};
+    const auto hit = tlas.ClosestHit(
+        shapes, Ray{MakePoint(3, 6, -5), MakeVector(0, 0, 1)});
+    return hit ? hit->shapeIndex * 10 + hit->primIndex : std::uint32_t(-1);
+  };
+  static_assert(closest() == 21);
+}
@@ -32,8 +32,7 @@ TEST(SphereIntersection, intersection_object) {
   constexpr Tuple origin = MakePoint(0, 0, -5);
   constexpr Tuple direction = MakeVector(0, 0, 1);
   constexpr Ray ray{origin, direction};
-  constexpr auto xsVariant = sphere.IntersectWith(ray, &shapeWrapper);
-  const auto xs = std::get<StaticVector<Intersection, 2>>(xsVariant);
+  constexpr auto xs = sphere.IntersectWith(ray, &shapeWrapper);
   EXPECT_EQ(xs.size(), 2);
   EXPECT_EQ(xs[0].GetShapeType(), ShapeType::SphereTag);
   EXPECT_EQ(xs[1].GetShapeType(), ShapeType::SphereTag);
@@ -88,8 +87,7 @@ TEST(SphereIntersection, intersect_with_scaled_sphere) {
   constexpr Tuple origin = MakePoint(0, 0, -5);
   constexpr Tuple direction = MakeVector(0, 0, 1);
   constexpr Ray ray{origin, direction};
-  constexpr auto xsVariant = sphere.IntersectWith(ray, &shapeWrapper);
-  const auto xs = std::get<StaticVector<Intersection, 2>>(xsVariant);
+  constexpr auto xs = sphere.IntersectWith(ray, &shapeWrapper);
   EXPECT_EQ(xs.size(), 2);
   EXPECT_EQ(xs[0].GetIntersectDistance(), 3);
   EXPECT_EQ(xs[1].GetIntersectDistance(), 7);
@@ -102,15 +100,36 @@ TEST(SphereIntersection, intersect_with_translated_sphere) {
   constexpr Tuple origin = MakePoint(0, 0, -5);
   constexpr Tuple direction = MakeVector(0, 0, 1);
   constexpr Ray ray{origin, direction};
-  constexpr auto xsVariant = sphere.IntersectWith(ray, &shapeWrapper);
-  const auto xs = std::get<StaticVector<Intersection, 2>>(xsVariant);
-  EXPECT_EQ(xs.size(), 2);
-  // TODO: a workaround for non-hitting : see shape.h for more details
-  // This is different from book's illustrations
-  constexpr auto I = IntersectionUtils::VisibleHitFromVariant(xsVariant);
+  constexpr auto xs = sphere.IntersectWith(ray, &shapeWrapper);
+  EXPECT_EQ(xs.size(), 0);
+  constexpr auto I = IntersectionUtils::VisibleHit(xs);
   EXPECT_EQ(I, std::nullopt);
 }
 
+TEST(SphereIntersection, hits_outside_ray_interval_are_rejected) {
+  constexpr Sphere sphere;
+  static constexpr ShapeWrapper shapeWrapper = ShapeWrapper(sphere);
+  // from inside the sphere, the root at t = -1 lies behind the origin
+  constexpr Ray inside{MakePoint(0, 0, 0), MakeVector(0, 0, 1)};
+  constexpr auto insideXs = sphere.IntersectWith(inside, &shapeWrapper);
+  static_assert(insideXs.size() == 1);
+  static_assert(insideXs[0].GetIntersectDistance() == 1);
+  // both roots (4 and 6) are past tMax
+  constexpr Ray clipped{MakePoint(0, 0, -5), MakeVector(0, 0, 1), 0, 3.5};
+  static_assert(sphere.IntersectWith(clipped, &shapeWrapper).empty());
+  // only the far root is past tMin
+  constexpr Ray far{MakePoint(0, 0, -5), MakeVector(0, 0, 1), 5, 10};
+  constexpr auto farXs = sphere.IntersectWith(far, &shapeWrapper);
+  static_assert(farXs.size() == 1);
+  static_assert(farXs[0].GetIntersectDistance() == 6);
+  // the interval is kept in object space, t does not depend on the transform
+  constexpr Sphere scaled{MatrixUtils::Scale(2, 2, 2)};
+  static constexpr ShapeWrapper scaledWrapper = ShapeWrapper(scaled);
+  constexpr auto scaledXs = scaled.IntersectWith(far, &scaledWrapper);
+  static_assert(scaledXs.size() == 1);
+  static_assert(scaledXs[0].GetIntersectDistance() == 7);
+}
+
 TEST(SphereIntersection, hit_should_fall_above_point) {
   constexpr Tuple origin = MakePoint(0, 0, -5);
   constexpr Tuple direction = MakeVector(0, 0, 1);
@@ -131,12 +150,9 @@ TEST(PlaneIntersection, intersect_with_ray_parallel_to_plane) {
   constexpr Ray ray{origin, direction};
   constexpr Plane plane;
   static constexpr ShapeWrapper shapeWrapper = ShapeWrapper(plane);
-  constexpr auto xsVariant = plane.IntersectWith(ray, &shapeWrapper);
-  const auto xs = std::get<StaticVector<Intersection, 1>>(xsVariant);
-  EXPECT_EQ(xs.size(), 1);
-  // TODO: a workaround for non-hitting : see shape.h for more details
-  // This is different from book's illustrations
-  constexpr auto I = IntersectionUtils::VisibleHitFromVariant(xsVariant);
+  constexpr auto xs = plane.IntersectWith(ray, &shapeWrapper);
+  EXPECT_EQ(xs.size(), 0);
+  constexpr auto I = IntersectionUtils::VisibleHit(xs);
   EXPECT_EQ(I, std::nullopt);
 }
 
@@ -146,12 +162,9 @@ TEST(PlaneIntersection, intersect_with_ray_coplaner_to_plane) {
   constexpr Ray ray{origin, direction};
   constexpr Plane plane;
   static constexpr ShapeWrapper shapeWrapper = ShapeWrapper(plane);
-  constexpr auto xsVariant = plane.IntersectWith(ray, &shapeWrapper);
-  const auto xs = std::get<StaticVector<Intersection, 1>>(xsVariant);
-  EXPECT_EQ(xs.size(), 1);
-  // TODO: a workaround for non-hitting : see shape.h for more details
-  // This is different from book's illustrations
-  constexpr auto I = IntersectionUtils::VisibleHitFromVariant(xsVariant);
+  constexpr auto xs = plane.IntersectWith(ray, &shapeWrapper);
+  EXPECT_EQ(xs.size(), 0);
+  constexpr auto I = IntersectionUtils::VisibleHit(xs);
   EXPECT_EQ(I, std::nullopt);
 }
 
@@ -161,20 +174,26 @@ TEST(PlaneIntersection, intersect_with_ray_from_above) {
   constexpr Ray ray{origin, direction};
   constexpr Plane plane;
   static constexpr ShapeWrapper shapeWrapper = ShapeWrapper(plane);
-  constexpr auto xsVariant = plane.IntersectWith(ray, &shapeWrapper);
-  const auto xs = std::get<StaticVector<Intersection, 1>>(xsVariant);
+  constexpr auto xs = plane.IntersectWith(ray, &shapeWrapper);
   EXPECT_EQ(xs.size(), 1);
   EXPECT_EQ(xs[0].GetIntersectDistance(), 1);
 }
 
+TEST(PlaneIntersection, hit_behind_ray_origin_is_rejected) {
+  constexpr Ray ray{MakePoint(0, 1, 0), MakeVector(0, 1, 0)};
+  constexpr Plane plane;
+  static constexpr ShapeWrapper shapeWrapper = ShapeWrapper(plane);
+  constexpr auto xs = plane.IntersectWith(ray, &shapeWrapper);
+  static_assert(xs.empty());
+}
+
 TEST(PlaneIntersection, intersect_with_ray_from_below) {
   constexpr Tuple origin = MakePoint(0, -1, 0);
   constexpr Tuple direction = MakeVector(0, 1, 0);
   constexpr Ray ray{origin, direction};
   constexpr Plane plane;
   static constexpr ShapeWrapper shapeWrapper = ShapeWrapper(plane);
-  constexpr auto xsVariant = plane.IntersectWith(ray, &shapeWrapper);
-  const auto xs = std::get<StaticVector<Intersection, 1>>(xsVariant);
+  constexpr auto xs = plane.IntersectWith(ray, &shapeWrapper);
   EXPECT_EQ(xs.size(), 1);
   EXPECT_EQ(xs[0].GetIntersectDistance(), 1);
 }
\ No newline at end of file
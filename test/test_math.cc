@@ -125,4 +125,80 @@ TEST(Math, ceil) {
 
   constexpr auto y4 = Ceil(x4);
   EXPECT_EQ(y4, -2.0);
-}
\ No newline at end of file
+}
+/*
+  Math functions dispatch to <cmath> at run time and to the ConstExpr kernels
+  during constant evaluation, pin the two modes against each other.
+*/
+TEST(Math, constant_evaluation_uses_constexpr_kernels) {
+  static_assert(ConstExprSqrtf(2.0) == ConstExpr::Sqrt(2.0));
+  static_assert(Sine(1.0) == ConstExpr::Sine(1.0));
+  static_assert(Cosine(1.0) == ConstExpr::Cosine(1.0));
+  static_assert(ConstExprExp(0.9, 200) == ConstExpr::Pow(0.9, 200));
+  static_assert(Floor(-2.7) == ConstExpr::Floor(-2.7));
+  static_assert(Ceil(-2.7) == ConstExpr::Ceil(-2.7));
+  static_assert(Modulo(7.5, 2.0) == ConstExpr::Modulo(7.5, 2.0));
+  static_assert(ArcCosine(0.3) == ConstExpr::ArcCosine(0.3));
+}
+
+TEST(Math, runtime_matches_constexpr_kernels) {
+  constexpr auto piRad = MathConstants::PI<double>;
+  for (int i = -64; i <= 64; ++i) {
+    const double rad = i * piRad / 32;
+    EXPECT_TRUE(ApproxEqual(Sine(rad), ConstExpr::Sine(rad))) << rad;
+    EXPECT_TRUE(ApproxEqual(Cosine(rad), ConstExpr::Cosine(rad))) << rad;
+    EXPECT_TRUE(ApproxEqual(Floor(rad), ConstExpr::Floor(rad))) << rad;
+    EXPECT_TRUE(ApproxEqual(Ceil(rad), ConstExpr::Ceil(rad))) << rad;
+    EXPECT_TRUE(ApproxEqual(Modulo(rad, 2.0), ConstExpr::Modulo(rad, 2.0)))
+        << rad;
+  }
+  // keep away from the poles at +-pi/2
+  for (int i = -15; i <= 15; ++i) {
+    const double rad = i * piRad / 32;
+    EXPECT_TRUE(ApproxEqual(Tangent(rad),
+                            ConstExpr::Sine(rad) / ConstExpr::Cosine(rad)))
+        << rad;
+  }
+  for (int i = -100; i <= 100; ++i) {
+    const double x = i / 100.0;
+    EXPECT_TRUE(ApproxEqual(ArcCosine(x), ConstExpr::ArcCosine(x))) << x;
+  }
+  for (int i = 0; i <= 1000; ++i) {
+    const double x = i * 0.37;
+    EXPECT_TRUE(ApproxEqual(ConstExprSqrtf(x), ConstExpr::Sqrt(x))) << x;
+  }
+  // material shininess exponents on a cosine base
+  for (int i = 0; i <= 20; ++i) {
+    const double base = i / 20.0;
+    for (int exponent : {0, 1, 2, 10, 50, 200, 300}) {
+      EXPECT_TRUE(ApproxEqual(ConstExprExp(base, exponent),
+                              ConstExpr::Pow(base, exponent)))
+          << base << "^" << exponent;
+    }
+  }
+}
+
+TEST(Math, constexpr_kernels_large_and_small_arguments) {
+  constexpr auto piRad = MathConstants::PI<double>;
+  // range reduction keeps sine/cosine accurate far away from zero
+  static_assert(ApproxEqual(ConstExpr::Sine(200 * piRad + piRad / 6), 0.5));
+  static_assert(ApproxEqual(ConstExpr::Cosine(-200 * piRad + piRad / 3), 0.5));
+  static_assert(ApproxEqual(ConstExpr::Sine(-3 * piRad / 2), 1.0));
+  static_assert(ApproxEqual(ConstExpr::Cosine(3 * piRad), -1.0));
+  // exponent based sqrt guess across magnitudes, both precisions
+  static_assert(ConstExpr::Sqrt(0.0) == 0.0);
+  static_assert(ApproxEqual(ConstExpr::Sqrt(1e-6), 1e-3));
+  static_assert(ApproxEqual(ConstExpr::Sqrt(1e12) / 1e6, 1.0));
+  static_assert(ApproxEqual(ConstExpr::Sqrt(2.0f), 1.41421356f));
+  static_assert(ApproxEqual(ConstExpr::Sqrt(1e10f) / 1e5f, 1.0f));
+  // exponentiation by squaring
+  static_assert(ConstExpr::Pow(2.0, 10) == 1024.0);
+  static_assert(ConstExpr::Pow(3.0, 0) == 1.0);
+  static_assert(ApproxEqual(ConstExpr::Pow(0.99, 200), 0.13397967485796175));
+  // arc cosine over the whole domain, including both ends
+  static_assert(ConstExpr::ArcCosine(1.0) == 0.0);
+  static_assert(ApproxEqual(ConstExpr::ArcCosine(-1.0), piRad));
+  static_assert(ApproxEqual(ConstExpr::ArcCosine(0.5), piRad / 3));
+  static_assert(ApproxEqual(ConstExpr::ArcCosine(0.5f), float(piRad / 3)));
+  static_assert(ConstExpr::ArcCosine(2.0) != ConstExpr::ArcCosine(2.0));
+}
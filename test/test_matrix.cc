@@ -148,6 +148,20 @@ TEST(Mat, operator_div) {
   EXPECT_EQ(m3, divide2Expected);
 }
 
+TEST(Mat, expression_templates) {
+  constexpr Matrix<double, 2, 2> m1 = {1., 2., 3., 4.};
+  constexpr Matrix<double, 2, 2> m2 = {4., 3., 2., 1.};
+  constexpr auto lazy = (m1 + m2) * 2.0 - m1 / 1.0;
+  static_assert(MatrixUtils::LazyMatrix<decltype(lazy)>);
+  constexpr Matrix<double, 2, 2> expected = {9., 8., 7., 6.};
+  constexpr Matrix<double, 2, 2> evaluated = lazy;
+  static_assert(evaluated == expected);
+  static_assert(lazy[1][0] == 7.);
+  // products are eager and evaluate lazy operands first
+  static_assert((m1 + m2) * m1 == Matrix<double, 2, 2>{20., 30., 20., 30.});
+  static_assert(m1 * (Vec{1., 1.} * 2.0) == Vec{6., 14.});
+}
+
 TEST(Mat, transpose) {
   constexpr Matrix<double, 3, 4> mat = {1., 2., 3., 4., 2., 4.,
                                         4., 2., 8., 6., 4., 1.};
@@ -256,3 +270,67 @@ TEST(Mat, inverse) {
   constexpr Matrix<double, 4, 4> I4_ = M2 * invM2;
   EXPECT_EQ(I4, I4_);
 }
+
+TEST(Mat, try_inverse_reports_singular) {
+  constexpr Matrix<double, 4, 4> m = {-4., 2.,  -2., -3., 9., 6., 2., 6.,
+                                      0,   -5., 1.,  -5., 0,  0,  0,  0};
+  constexpr auto inv = TryInverse(m);
+  EXPECT_FALSE(inv.has_value());
+
+  constexpr Matrix<double, 3, 3> m2 = {1., 2., 3., 2., 4., 6., 7., 8., 9.};
+  constexpr auto inv2 = TryInverse(m2);
+  EXPECT_FALSE(inv2.has_value());
+
+  // nearly singular matrices agree with `Invertible` rather than blowing up
+  constexpr Matrix<double, 4, 4> m3 = {-4., 2.,  -2., -3., 9., 6., 2.,
+                                       6.,  0,   -5., 1.,  -5., 0,  -5.,
+                                       1.,  -5. + 1e-9};
+  static_assert(!Invertible(m3));
+  EXPECT_FALSE(TryInverse(m3).has_value());
+  constexpr Matrix<double, 3, 3> m4 = {1., 2., 3., 2., 4., 6. + 1e-9,
+                                       7., 8., 9.};
+  static_assert(!Invertible(m4));
+  EXPECT_FALSE(TryInverse(m4).has_value());
+  // the tolerance is relative to the scale of the rows
+  constexpr Matrix<double, 4, 4> tiny = {0.01, 0, 0, 0, 0, 0.01, 0, 0,
+                                         0,    0, 0.01, 0, 0, 0, 0, 1};
+  static_assert(Invertible(tiny));
+  EXPECT_TRUE(TryInverse(tiny).has_value());
+  // and ignores the translation column of an affine matrix
+  constexpr Matrix<double, 4, 4> moved = {0.1, 0, 0,   100, 0, 0.1, 0, 100,
+                                          0,   0, 0.1, 100, 0, 0,   0, 1};
+  static_assert(Invertible(moved));
+  constexpr auto invMoved = TryInverse(moved);
+  static_assert(invMoved.has_value());
+  constexpr Matrix<double, 4, 4> I4 = PredefinedMatrices::I<double, 4>;
+  EXPECT_EQ(moved * invMoved.value(), I4);
+}
+
+TEST(Mat, inverse_generic_size) {
+  // Gauss-Jordan elimination needs pivoting for a zero leading entry
+  constexpr Matrix<double, 3, 3> m = {0., 2., 1., 1., 0., 0., 3., 1., 1.};
+  constexpr auto inv = TryInverse(m);
+  static_assert(inv.has_value());
+  constexpr Matrix<double, 3, 3> expected = {0.,  1., 0.,  1., 3.,
+                                             -1., -1., -6., 2.};
+  EXPECT_EQ(inv.value(), expected);
+  EXPECT_EQ(m * inv.value(), (PredefinedMatrices::I<double, 3>));
+
+  constexpr Matrix<double, 5, 5> m5 = {2., 0., 0., 1., 0., 1., 3., 0., 0., 2.,
+                                       0., 1., 4., 0., 0., 0., 0., 1., 5., 1.,
+                                       1., 0., 0., 0., 6.};
+  constexpr auto inv5 = Inverse(m5);
+  EXPECT_EQ(m5 * inv5, (PredefinedMatrices::I<double, 5>));
+  EXPECT_EQ(inv5 * m5, (PredefinedMatrices::I<double, 5>));
+}
+
+TEST(Mat, inverse_closed_form_matches_cofactor) {
+  constexpr Matrix<double, 4, 4> M = {-5., 2., 6., -8., 1., -5., 1., 8.,
+                                      7.,  7., -6., -7., 1., -3., 7., 4.};
+  constexpr auto inv = Inverse(M);
+  constexpr double det = Determinant(M);
+  for (std::size_t row = 0; row < 4; row++)
+    for (std::size_t col = 0; col < 4; col++)
+      EXPECT_TRUE(
+          MathUtils::ApproxEqual(inv[col][row], Cofactor(M, row, col) / det));
+}
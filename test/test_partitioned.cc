@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <accel/instancing.hh>
+#include <accel/partitioned.hh>
+#include <accel_test_utils.hh>
+#include <random>
+#include <vector>
+#include <world.hh>
+using namespace RayTracer;
+using namespace RayTracer::AccelTestUtils;
+
+namespace {
+
+/* Random spheres and a few tilted planes, every tenth shape an instance */
+std::vector<ShapeWrapper> MixedShapes(std::size_t count, unsigned seed,
+                                      const Geometry& geometry) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<Real> position(-10, 10);
+  std::uniform_real_distribution<Real> scale(0.2, 1.5);
+  std::vector<ShapeWrapper> shapes;
+  shapes.emplace_back(Plane{MatrixUtils::Translation(0, -11, 0)});
+  shapes.emplace_back(Plane{Transform(MatrixUtils::Translation(0, 0, 14) *
+                                      MatrixUtils::RotateX(1.2))});
+  for (std::size_t i = 0; i < count; i++) {
+    const Transform transform(
+        MatrixUtils::Translation(position(gen), position(gen), position(gen)) *
+        MatrixUtils::RotateZ(position(gen)) *
+        MatrixUtils::Scale(scale(gen), scale(gen), scale(gen)));
+    if (i % 10 == 9)
+      shapes.emplace_back(Instance{geometry, transform});
+    else
+      shapes.emplace_back(Sphere{transform});
+  }
+  return shapes;
+}
+
+SharedGeometry MakeGeometry() {
+  std::vector<ShapeWrapper> shapes;
+  shapes.emplace_back(Sphere{MatrixUtils::Translation(-1, 0, 0)});
+  shapes.emplace_back(Sphere{MatrixUtils::Translation(1, 0, 0)});
+  return SharedGeometry{std::move(shapes)};
+}
+
+}  // namespace
+
+TEST(PartitionedAccel, shapes_are_grouped_by_type) {
+  const SharedGeometry geometry = MakeGeometry();
+  const auto shapes = MixedShapes(50, 3, geometry);
+  const PartitionedAccel accel{shapes};
+  EXPECT_EQ(accel.GetSpheres().size(), 45);
+  EXPECT_EQ(accel.GetPlanes().size(), 2);
+  EXPECT_EQ(accel.GetOthers().size(), 5);
+  // ids map back to the shapes of the world
+  for (std::size_t i = 0; i < accel.GetSpheres().size(); i++) {
+    const std::uint32_t id = accel.GetSpheres().ids[i];
+    EXPECT_EQ(shapes[id].GetShapeType(), SphereTag);
+    EXPECT_EQ(accel.GetSpheres().inverse[7][i],
+              shapes[id].GetInverseTransform()[1][3]);
+  }
+  EXPECT_EQ(accel.GetPlanes().ids[1], 1u);
+  EXPECT_EQ(shapes[accel.GetOthers()[0]].GetShapeType(), InstanceTag);
+}
+
+TEST(PartitionedAccel, queries_match_linear_scan) {
+  const SharedGeometry geometry = MakeGeometry();
+  const auto shapes = MixedShapes(300, 7, geometry);
+  ExpectSameQueries<PartitionedAccel>(shapes, RandomRays(1000, 11));
+}
+
+TEST(PartitionedAccel, batched_spheres_match_sphere_scan) {
+  const SharedGeometry geometry = MakeGeometry();
+  const auto shapes = MixedShapes(40, 13, geometry);
+  const auto rays = RandomRays(300, 17);
+  // every count up to two registers of 8 floats, so that each tail length is
+  // covered whatever the lane count
+  for (std::size_t count = 0; count <= 16; count++) {
+    PartitionedUtils::SphereBuffer spheres;
+    for (std::size_t i = 2; spheres.size() < count; i++) {
+      if (shapes[i].GetShapeType() == SphereTag)
+        spheres.push_back(shapes[i].GetInverseTransform(),
+                          static_cast<std::uint32_t>(i));
+    }
+    for (const Ray& ray : rays) {
+      std::size_t expected = count;
+      Ray clipped = ray;
+      for (std::size_t i = 0; i < count; i++) {
+        const Real t = spheres.NearestRoot(i, clipped);
+        if (t < MathUtils::MathConstants::INF<Real>) {
+          expected = i;
+          clipped.ClipTo(t);
+        }
+      }
+      const auto [nearest, t] = spheres.Nearest(ray);
+      ASSERT_EQ(nearest, expected);
+      if (nearest < count) {
+        EXPECT_TRUE(Near(t, clipped.GetTMax()));
+      }
+      // the any-hit kernel returns early, for a hit in any lane or the tail
+      EXPECT_EQ(spheres.Any(ray), expected < count);
+    }
+  }
+  // on a tie the later sphere wins, whichever lane or tail it sits in
+  const Sphere sphere{MatrixUtils::Translation(1, 2, 3)};
+  const Ray ray{MakePoint(1, 2, -5), MakeVector(0, 0, 1)};
+  for (const std::uint32_t count : {7u, 16u, 19u}) {
+    PartitionedUtils::SphereBuffer same;
+    for (std::uint32_t i = 0; i < count; i++)
+      same.push_back(sphere.GetInverseTransform(), i);
+    EXPECT_EQ(same.Nearest(ray).first, count - 1);
+  }
+}
+
+TEST(PartitionedAccel, world_renders_like_linear_world) {
+  const SharedGeometry geometry = MakeGeometry();
+  const auto shapes = MixedShapes(100, 5, geometry);
+  using Shapes = std::vector<ShapeWrapper>;
+  const Lights lights = TestLights();
+  World<Shapes, Lights> linearWorld{Shapes(shapes), Lights(lights)};
+  World<Shapes, Lights, 10, PartitionedAccel> world{Shapes(shapes),
+                                                    Lights(lights)};
+  ExpectSameColours(world, linearWorld, RandomRays(500, 9));
+  // buffers hold copies of the transforms, refreshed on update
+  world.shapes[2].SetTransform(MatrixUtils::Translation(0, 0, 30));
+  EXPECT_TRUE(world.UpdateAccelerator());
+  const Ray ray{MakePoint(0, 0, 40), MakeVector(0, 0, -1)};
+  const auto hit = world.ClosestHit(ray);
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_EQ(hit->shapePtr, &world.shapes[2]);
+  EXPECT_EQ(hit->GetIntersectDistance(), 9);
+}
+
+TEST(PartitionedAccel, constexpr_queries) {
+  constexpr auto closest = [] {
+    std::vector<ShapeWrapper> shapes;
+    shapes.emplace_back(Plane{MatrixUtils::Translation(0, -1, 0)});
+    for (int i = 0; i < 5; i++)
+      shapes.emplace_back(Sphere{MatrixUtils::Translation(Real(3 * i), 0, 0)});
+    const PartitionedAccel accel{shapes};
+    const Ray ray{MakePoint(6, 0, -5), MakeVector(0, 0, 1)};
+    const Ray down{MakePoint(20, 5, 0), MakeVector(0, -1, 0)};
+    return std::pair{accel.ClosestHit(shapes, ray)->shapeIndex,
+                     accel.ClosestHit(shapes, down)->t};
+  };
+  static_assert(closest() == std::pair{3u, Real(6)});
+}
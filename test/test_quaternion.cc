@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include <quaternion.hh>
+#include <transform.hh>
+using namespace RayTracer;
+
+TEST(Quaternion, identity) {
+  constexpr Quaternion q;
+  constexpr auto p = MakePoint(1, -2, 3);
+  EXPECT_EQ(q.Rotate(p), p);
+  EXPECT_EQ(q.ToMatrix(), (PredefinedMatrices::I<Real, 3>));
+}
+
+TEST(Quaternion, matches_rotation_matrices) {
+  constexpr auto piRad = MathUtils::MathConstants::PI<Real>;
+  constexpr auto v = MakeVector(1, 2, 3);
+  constexpr Quaternion qx = Quaternion::RotateX(piRad / 3);
+  constexpr Quaternion qy = Quaternion::RotateY(-piRad / 5);
+  constexpr Quaternion qz = Quaternion::RotateZ(piRad / 7);
+  static_assert(qx.Rotate(v) == MatrixUtils::RotateX(piRad / 3) * v);
+  static_assert(qy.Rotate(v) == MatrixUtils::RotateY(-piRad / 5) * v);
+  static_assert(qz.Rotate(v) == MatrixUtils::RotateZ(piRad / 7) * v);
+  // the book's example: a quarter turn around x maps y to z
+  EXPECT_EQ(Quaternion::RotateX(piRad / 2).Rotate(MakePoint(0, 1, 0)),
+            MakePoint(0, 0, 1));
+  EXPECT_EQ(Quaternion::FromAxisAngle(MakeVector(0, 2, 0), -piRad / 5), qy);
+}
+
+TEST(Quaternion, composition_and_conjugate) {
+  constexpr auto piRad = MathUtils::MathConstants::PI<Real>;
+  constexpr Quaternion qx = Quaternion::RotateX(piRad / 2);
+  constexpr Quaternion qy = Quaternion::RotateY(piRad / 4);
+  constexpr auto p = MakePoint(1, 2, 3);
+  // (qy * qx) rotates by qx first
+  static_assert((qy * qx).Rotate(p) == qy.Rotate(qx.Rotate(p)));
+  static_assert(qx.Conjugate().Rotate(qx.Rotate(p)) == p);
+  static_assert(qx * qx.Conjugate() == Quaternion{});
+  // q and -q are the same rotation
+  static_assert(Quaternion{-qx.w, -qx.x, -qx.y, -qx.z} == qx);
+  EXPECT_NE(qx, qy);
+  // while close but different rotations are not
+  static_assert(Quaternion::RotateX(piRad / 180) != Quaternion{});
+  static_assert(Quaternion::RotateY(piRad / 4 + Real(0.001)) != qy);
+}
+
+TEST(Quaternion, slerp) {
+  constexpr auto piRad = MathUtils::MathConstants::PI<Real>;
+  constexpr Quaternion from;
+  constexpr Quaternion to = Quaternion::RotateZ(piRad / 2);
+  static_assert(Slerp(from, to, 0) == from);
+  static_assert(Slerp(from, to, 1) == to);
+  static_assert(Slerp(from, to, 0.5) == Quaternion::RotateZ(piRad / 4));
+  static_assert(Slerp(from, to, 0.25) == Quaternion::RotateZ(piRad / 8));
+  static_assert(Slerp(from, to, 0.26) != Quaternion::RotateZ(piRad / 8));
+  // the shorter arc is taken whatever the sign of the end point
+  constexpr Quaternion flipped{-to.w, -to.x, -to.y, -to.z};
+  static_assert(Slerp(from, flipped, 0.5) == Quaternion::RotateZ(piRad / 4));
+  // run-time and compile-time results agree
+  Quaternion runtimeTo = to;
+  EXPECT_EQ(Slerp(from, runtimeTo, Real(0.3)), Slerp(from, to, 0.3));
+}
@@ -16,6 +16,45 @@ TEST(Ray, constructor) {
   EXPECT_EQ(ray.GetDirection(), direction);
 }
 
+TEST(Ray, interval) {
+  constexpr Ray ray{MakePoint(0, 0, 0), MakeVector(0, 0, 1)};
+  static_assert(ray.GetTMin() == 0);
+  static_assert(ray.GetTMax() == MathUtils::MathConstants::INF<Real>);
+  static_assert(ray.Contains(0) && ray.Contains(1e6) && !ray.Contains(-1));
+
+  constexpr Ray clipped = [] {
+    Ray r{MakePoint(0, 0, 0), MakeVector(0, 0, 1), 1, 10};
+    r.ClipTo(5);
+    // clipping never grows the interval
+    r.ClipTo(7);
+    return r;
+  }();
+  static_assert(clipped.GetTMin() == 1 && clipped.GetTMax() == 5);
+  static_assert(!clipped.Contains(0.5) && clipped.Contains(5) &&
+                !clipped.Contains(6));
+}
+
+TEST(Ray, inverse_direction_and_signs) {
+  constexpr Real inf = MathUtils::MathConstants::INF<Real>;
+  constexpr Ray ray{MakePoint(1, 2, 3), MakeVector(2, 0, -4)};
+  static_assert(ray.GetInvDirection() == MakeVector(0.5, inf, -0.25));
+  static_assert(!ray.IsNegative(0) && !ray.IsNegative(1) && ray.IsNegative(2));
+  // recomputed for the transformed direction
+  constexpr Ray scaled =
+      ray.Transform(AffineTransform(MatrixUtils::Scale(-1, 1, 0.5)));
+  static_assert(scaled.GetInvDirection() == MakeVector(-0.5, inf, -0.5));
+  static_assert(scaled.IsNegative(0) && scaled.IsNegative(2));
+}
+
+TEST(Ray, constructor_validates_arguments) {
+  // unit tests are never built with RAYTRACER_UNCHECKED
+  static_assert(Checks::Enabled);
+  EXPECT_THROW(Ray(MakeVector(1, 0, 0), MakeVector(1, 0, 0)),
+               std::invalid_argument);
+  EXPECT_THROW(Ray(MakePoint(1, 0, 0), MakePoint(1, 0, 0)),
+               std::invalid_argument);
+}
+
 TEST(Ray, translation) {
   constexpr Tuple origin = MakePoint(1, 2, 3);
   constexpr Tuple direction = MakeVector(0, 1, 0);
@@ -35,3 +74,38 @@ TEST(Ray, Scaling) {
   EXPECT_EQ(rayT.GetOrigin(), MakePoint(2, 6, 12));
   EXPECT_EQ(rayT.GetDirection(), MakeVector(0, 3, 0));
 }
+
+TEST(Ray, affine_transform) {
+  constexpr Tuple origin = MakePoint(1, 2, 3);
+  constexpr Tuple direction = MakeVector(0, 1, 0);
+  constexpr Transform m =
+      MatrixUtils::Translation(3, 4, 5) * MatrixUtils::Scale(2, 3, 4);
+  constexpr Ray ray{origin, direction};
+  constexpr Ray rayT = ray.Transform(AffineTransform(m));
+  EXPECT_EQ(rayT.GetOrigin(), MakePoint(5, 10, 17));
+  EXPECT_EQ(rayT.GetDirection(), MakeVector(0, 3, 0));
+}
+
+TEST(Ray, transform_keeps_interval) {
+  constexpr Ray ray{MakePoint(1, 2, 3), MakeVector(0, 1, 0), 2, 8};
+  constexpr Transform m =
+      MatrixUtils::Translation(3, 4, 5) * MatrixUtils::Scale(2, 3, 4);
+  constexpr Ray rayT = ray.Transform(m);
+  constexpr Ray rayA = ray.Transform(AffineTransform(m));
+  static_assert(rayT.GetTMin() == 2 && rayT.GetTMax() == 8);
+  static_assert(rayA.GetTMin() == 2 && rayA.GetTMax() == 8);
+}
+
+TEST(Ray, transform_to_shape) {
+  constexpr Ray ray{MakePoint(1, 2, 3), MakeVector(0, 1, 0), 2, 8};
+  constexpr AffineTransform m{MatrixUtils::Translation(3, 4, 5) *
+                              MatrixUtils::Scale(2, -3, 4)};
+  constexpr Ray rayA = ray.Transform(m);
+  constexpr Ray rayS = ray.TransformToShape(m);
+  static_assert(rayS.GetOrigin() == rayA.GetOrigin());
+  static_assert(rayS.GetDirection() == rayA.GetDirection());
+  static_assert(rayS.GetTMin() == 2 && rayS.GetTMax() == 8);
+  // no inverse direction nor signs for a ray which is never slab tested
+  static_assert(rayS.GetInvDirection() == PredefinedTuples::ZeroVector);
+  static_assert(!rayS.IsNegative(1) && rayA.IsNegative(1));
+}
@@ -15,10 +15,10 @@ TEST(PointLight, default_constructor) {
 TEST(Material, default_properties) {
   constexpr Material m;
   EXPECT_EQ(m.color, PredefinedColours::WHITE);
-  EXPECT_EQ(m.ambient, 0.1);
-  EXPECT_EQ(m.diffuse, 0.9);
-  EXPECT_EQ(m.specular, 0.9);
-  EXPECT_EQ(m.shininess, 200.0);
+  EXPECT_EQ(m.ambient, Real(0.1));
+  EXPECT_EQ(m.diffuse, Real(0.9));
+  EXPECT_EQ(m.specular, Real(0.9));
+  EXPECT_EQ(m.shininess, Real(200.0));
 }
 
 TEST(Material, sphere_material_assign) {
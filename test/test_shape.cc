@@ -53,6 +53,56 @@ TEST(Sphere, normal_on_a_translated_sphere_2) {
   EXPECT_EQ(n, MakeVector(0, 0.97014, -0.24254));
 }
 
+TEST(Shape, cached_inverse_transform) {
+  constexpr auto pi = MathUtils::MathConstants::PI<double>;
+  constexpr Transform M =
+      MatrixUtils::Translation(1, 2, 3) * MatrixUtils::RotateY(pi / 3);
+  constexpr Sphere s{M};
+  EXPECT_EQ(s.GetTransform(), M);
+  EXPECT_EQ(s.GetInverseTransform().ToMatrix(), Inverse(M));
+
+  // re-assigning the transform keeps the cached matrices in sync
+  constexpr Transform scale = MatrixUtils::Scale(2, 4, 8);
+  constexpr Sphere s2 = [&]() {
+    Sphere ret{M};
+    ret.SetTransform(scale);
+    return ret;
+  }();
+  EXPECT_EQ(s2.GetTransform(), scale);
+  EXPECT_EQ(s2.GetInverseTransform().ToMatrix(),
+            MatrixUtils::Scale(0.5, 0.25, 0.125));
+}
+
+TEST(Shape, trs_transform) {
+  constexpr auto pi = MathUtils::MathConstants::PI<Real>;
+  constexpr TRS trs{MakeVector(1, 2, 3), Quaternion::RotateY(pi / 3),
+                    MakeVector(2, 4, 8)};
+  constexpr Sphere s{trs};
+  EXPECT_EQ(s.GetTransform(), trs.ToMatrix());
+  EXPECT_EQ(s.GetInverseTransform().ToMatrix(), Inverse(trs.ToMatrix()));
+  constexpr Sphere fromMatrix{trs.ToMatrix()};
+  EXPECT_EQ(s.WorldNormalAt(MakePoint(1, 2, 11)),
+            fromMatrix.WorldNormalAt(MakePoint(1, 2, 11)));
+}
+
+TEST(Shape, occludes_matches_intersections) {
+  constexpr Plane plane;
+  constexpr Ray down{MakePoint(0, 1, 0), MakeVector(0, -1, 0)};
+  static_assert(plane.Occludes(down, 1.5));
+  static_assert(!plane.Occludes(down, 0.5));
+  constexpr Ray parallel{MakePoint(0, 1, 0), MakeVector(1, 0, 0)};
+  static_assert(!plane.Occludes(parallel, 100));
+
+  constexpr Sphere sphere{MatrixUtils::Translation(0, 0, 3)};
+  constexpr Ray ray{MakePoint(0, 0, 0), MakeVector(0, 0, 1)};
+  static_assert(sphere.Occludes(ray, 2.5));
+  static_assert(!sphere.Occludes(ray, 1.5));
+  // from inside, only the far root is in front of the origin
+  constexpr Ray inside{MakePoint(0, 0, 3), MakeVector(0, 0, 1)};
+  static_assert(sphere.Occludes(inside, 1.5));
+  static_assert(!sphere.Occludes(inside, 0.5));
+}
+
 TEST(Plane, normal_of_plane_constant_everywhere) {
   constexpr Plane p;
   constexpr auto p1 = MakePoint(0, 0, 0);
@@ -65,3 +115,14 @@ TEST(Plane, normal_of_plane_constant_everywhere) {
   EXPECT_EQ(n2, MakeVector(0, 1, 0));
   EXPECT_EQ(n3, MakeVector(0, 1, 0));
 }
+
+TEST(Plane, world_normal_follows_transform) {
+  constexpr auto pi = MathUtils::MathConstants::PI<Real>;
+  constexpr Plane p{Transform(MatrixUtils::Translation(0, 0, 14) *
+                              MatrixUtils::RotateX(pi / 2))};
+  // defined at the origin of the plane, and the same across it
+  constexpr auto n1 = p.WorldNormalAt(MakePoint(0, 0, 14));
+  constexpr auto n2 = p.WorldNormalAt(MakePoint(3, -4, 14));
+  EXPECT_EQ(n1, MakeVector(0, 0, 1));
+  EXPECT_EQ(n2, MakeVector(0, 0, 1));
+}
@@ -32,3 +32,22 @@ TEST(StaticVector, iterator_constructor) {
     EXPECT_EQ(staticVector.data()[i], i + 1);
   }
 }
+
+TEST(StaticVector, clear) {
+  constexpr auto refilled = [] {
+    StaticVector<int, 4> staticVector{1, 2, 3};
+    staticVector.clear();
+    staticVector.push_back(5);
+    return staticVector;
+  }();
+  static_assert(refilled.size() == 1 && refilled[0] == 5);
+  static_assert(refilled.capacity() == 4);
+}
+
+TEST(StaticVector, push_back_past_capacity) {
+  StaticVector<int, 2> staticVector{1, 2};
+  if constexpr (Checks::Enabled) {
+    EXPECT_THROW(staticVector.push_back(3), std::length_error);
+  }
+  EXPECT_EQ(staticVector.size(), 2);
+}
@@ -202,3 +202,100 @@ TEST(Transform, chaining) {
   constexpr auto T3 = Transform().Chain(C, B, A);
   EXPECT_EQ(T2, T3);
 }
+
+TEST(Transform, affine_point_and_vector) {
+  constexpr auto piRad = MathUtils::MathConstants::PI<double>;
+  constexpr Transform M = MatrixUtils::Translation(10, 5, 7) *
+                          MatrixUtils::RotateX(piRad / 3.0) *
+                          MatrixUtils::Shearing(1, 0, 0, 2, 0, 0);
+  constexpr AffineTransform A{M};
+  EXPECT_EQ(A.ToMatrix(), M);
+
+  constexpr auto p = MakePoint(1, -2, 3);
+  constexpr auto v = MakeVector(1, -2, 3);
+  EXPECT_EQ(A.TransformPoint(p), M * p);
+  EXPECT_EQ(A.TransformVector(v), M * v);
+  EXPECT_EQ(A * p, M * p);
+  EXPECT_EQ(A * v, M * v);
+  EXPECT_EQ(A.TransposeTransformVector(v), ToVector(Transpose(M) * v));
+}
+
+TEST(Transform, affine_composition) {
+  constexpr auto piRad = MathUtils::MathConstants::PI<double>;
+  constexpr Transform M1 = MatrixUtils::RotateY(piRad / 5.0);
+  constexpr Transform M2 =
+      MatrixUtils::Translation(1, 2, 3) * MatrixUtils::Scale(2, 3, 4);
+  constexpr auto composed = AffineTransform(M1) * AffineTransform(M2);
+  EXPECT_EQ(composed.ToMatrix(), M1 * M2);
+}
+
+TEST(Transform, affine_inverse) {
+  constexpr auto piRad = MathUtils::MathConstants::PI<double>;
+  constexpr Transform M = MatrixUtils::Translation(-3, 4, 1) *
+                          MatrixUtils::RotateZ(piRad / 7.0) *
+                          MatrixUtils::Scale(0.5, 2, 3);
+  constexpr auto inv = Inverse(AffineTransform(M));
+  EXPECT_EQ(inv.ToMatrix(), Inverse(M));
+  EXPECT_EQ((inv * AffineTransform(M)).ToMatrix(),
+            (PredefinedMatrices::I<double, 4>));
+
+  constexpr auto singular =
+      TryInverse(AffineTransform(MatrixUtils::Scale(1, 0, 1)));
+  EXPECT_FALSE(singular.has_value());
+  // the first two rows of the linear part are nearly dependent
+  constexpr TransformMatrix nearlyDependent = {
+      1., 2., 3., 0., 2., 4., 6. + 1e-9, 0., 7., 8., 9., 0., 0., 0., 0., 1.};
+  constexpr auto nearlySingular =
+      TryInverse(AffineTransform(nearlyDependent));
+  EXPECT_FALSE(nearlySingular.has_value());
+  // a uniformly small transform is not singular, e.g a tiny sphere
+  constexpr auto tiny =
+      TryInverse(AffineTransform(MatrixUtils::Scale(0.01, 0.01, 0.01)));
+  EXPECT_TRUE(tiny.has_value());
+}
+
+TEST(Transform, trs_matches_matrix_chain) {
+  constexpr auto piRad = MathUtils::MathConstants::PI<Real>;
+  constexpr TRS trs{MakeVector(1, 2, 3), Quaternion::RotateY(piRad / 3),
+                    MakeVector(2, 0.5, 4)};
+  constexpr Transform M = MatrixUtils::Translation(1, 2, 3) *
+                          MatrixUtils::RotateY(piRad / 3) *
+                          MatrixUtils::Scale(2, 0.5, 4);
+  EXPECT_EQ(trs.ToMatrix(), M);
+  EXPECT_EQ(Transform(trs), M);
+  // the inverse needs no matrix inversion, even with a non-uniform scale
+  EXPECT_EQ(trs.InverseAffine().ToMatrix(), Inverse(M));
+
+  constexpr auto p = MakePoint(-1, 2, 0.5);
+  constexpr auto v = MakeVector(-1, 2, 0.5);
+  EXPECT_EQ(trs.TransformPoint(p), M * p);
+  EXPECT_EQ(trs.TransformVector(v), M * v);
+}
+
+TEST(Transform, trs_composition_and_inverse) {
+  constexpr auto piRad = MathUtils::MathConstants::PI<Real>;
+  constexpr TRS outer{MakeVector(0, 0, 5), Quaternion::RotateY(-piRad / 4),
+                      MakeVector(2, 2, 2)};
+  constexpr TRS inner = TRS::Rotation(Quaternion::RotateX(piRad / 2)) *
+                        TRS::Scale(10, 0.01, 10);
+  constexpr TRS composed = outer * inner;
+  EXPECT_EQ(composed.ToMatrix(), outer.ToMatrix() * inner.ToMatrix());
+  EXPECT_EQ(TRS::Translation(1, 2, 3) * TRS::Scale(2, 3, 4),
+            (TRS{MakeVector(1, 2, 3), Quaternion{}, MakeVector(2, 3, 4)}));
+
+  constexpr TRS inv = Inverse(outer);
+  EXPECT_EQ(inv * outer, TRS{});
+  EXPECT_EQ(inv.ToMatrix(), Inverse(outer.ToMatrix()));
+}
+
+TEST(Transform, trs_interpolation) {
+  constexpr auto piRad = MathUtils::MathConstants::PI<Real>;
+  constexpr TRS from = TRS::Translation(0, 0, 0);
+  constexpr TRS to{MakeVector(2, 4, 6), Quaternion::RotateY(piRad / 2),
+                   MakeVector(3, 3, 3)};
+  EXPECT_EQ(Interpolate(from, to, 0), from);
+  EXPECT_EQ(Interpolate(from, to, 1), to);
+  constexpr TRS half = Interpolate(from, to, 0.5);
+  EXPECT_EQ(half, (TRS{MakeVector(1, 2, 3), Quaternion::RotateY(piRad / 4),
+                       MakeVector(2, 2, 2)}));
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include <accel/instancing.hh>
+#include <accel_test_utils.hh>
+#include <vector>
+#include <world.hh>
+using namespace RayTracer;
+using namespace RayTracer::AccelTestUtils;
+
+namespace {
+
+constexpr CheckerPattern floorPattern = [] {
+  CheckerPattern ret;
+  ret.SetColourA(PredefinedColours::GREEN);
+  ret.SetColourB(PredefinedColours::BLUE);
+  return ret;
+}();
+
+constexpr PatternWrapper floorPatternWrapper = PatternWrapper(floorPattern);
+
+using SceneShapes = std::tuple<std::array<Sphere, 3>, std::array<Plane, 1>>;
+using SceneLights = std::array<PointLight, 2>;
+
+/* A patterned floor under three spheres, lit by two lights */
+constexpr std::pair<SceneShapes, SceneLights> Scene() {
+  Material floorMaterial;
+  floorMaterial.patternPtr = &floorPatternWrapper;
+  floorMaterial.specular = 0;
+  Plane floor = Plane{MatrixUtils::Translation(0, -1, 0)};
+  floor.SetMaterial(floorMaterial);
+  Material shiny;
+  shiny.color = MakeColour(0.1, 1, 0.5);
+  shiny.diffuse = 0.7;
+  shiny.specular = 0.3;
+  Sphere middle = Sphere{MatrixUtils::Translation(-0.5, 0, 0.5)};
+  middle.SetMaterial(shiny);
+  const Sphere right = Sphere{Transform(
+      MatrixUtils::Translation(1.5, -0.5, -0.5) *
+      MatrixUtils::Scale(0.5, 0.5, 0.5))};
+  const Sphere left = Sphere{Transform(
+      MatrixUtils::Translation(-1.5, -0.67, -0.75) *
+      MatrixUtils::Scale(0.33, 0.33, 0.33))};
+  SceneShapes shapes{std::array<Sphere, 3>{middle, right, left},
+                     std::array<Plane, 1>{floor}};
+  SceneLights lights = {
+      PointLight(MakePoint(-10, 10, -10), MakeColour(1, 1, 1)),
+      PointLight(MakePoint(10, 5, -10), MakeColour(0.3, 0.3, 0.3))};
+  return {shapes, lights};
+}
+
+/* The same shapes, wrapped in the order of their flat index */
+constexpr auto WrappedScene() {
+  auto [shapes, lights] = Scene();
+  std::array<ShapeWrapper, 4> wrapped = {
+      std::get<0>(shapes)[0], std::get<0>(shapes)[1], std::get<0>(shapes)[2],
+      std::get<1>(shapes)[0]};
+  return World<decltype(wrapped), SceneLights,
+               NumXSOf<Sphere, Sphere, Sphere, Plane>::numXS>{
+      std::move(wrapped), std::move(lights)};
+}
+
+constexpr auto TypedScene() {
+  auto [shapes, lights] = Scene();
+  return TypedWorld<SceneShapes, SceneLights>{std::move(shapes),
+                                              std::move(lights)};
+}
+
+/* Rays from the eye of the scene through its middle */
+std::vector<Ray> SceneRays(std::size_t count, unsigned seed) {
+  return EyeRays(count, seed, MakePoint(0, 1.5, -5), 3);
+}
+
+}  // namespace
+
+TEST(TypedWorld, hit_capacity_and_flat_indices) {
+  using Typed = TypedWorld<SceneShapes, SceneLights>;
+  static_assert(Typed::NumXS == NumXSOf<Sphere, Sphere, Sphere, Plane>::numXS);
+  static_assert(Typed::NumShapes == 4);
+  static_assert(Typed::Offsets == std::array<std::size_t, 3>{0, 3, 4});
+  // an empty array still leaves room for one hit
+  using Empty =
+      TypedWorld<std::tuple<std::array<Sphere, 0>>, std::array<PointLight, 0>>;
+  static_assert(Empty::NumXS == 1);
+  // only fixed size arrays of shapes
+  static_assert(TypedShapeArray<std::array<Plane, 2>>);
+  static_assert(!TypedShapeArray<std::vector<Sphere>>);
+  static_assert(!TypedShapeArray<std::array<Real, 2>>);
+
+  constexpr static auto world = TypedScene();
+  EXPECT_TRUE(world.ContainShape(std::get<1>(world.shapes)[0]));
+  EXPECT_FALSE(world.ContainShape(Sphere{MatrixUtils::Translation(9, 9, 9)}));
+  EXPECT_EQ(world.VisitShape(3,
+                             [](const auto& shape) {
+                               return shape.GetShapeType();
+                             }),
+            PlaneTag);
+}
+
+TEST(TypedWorld, queries_match_wrapped_world) {
+  const auto typed = TypedScene();
+  const auto wrapped = WrappedScene();
+  const auto rays = SceneRays(500, 3);
+  for (const Ray& ray : rays) {
+    const auto hits = typed.IntersectWithRay(ray);
+    const auto xs = wrapped.IntersectWithRay(ray);
+    ASSERT_EQ(hits.size(), xs.size());
+    for (std::size_t i = 0; i < hits.size(); i++) {
+      EXPECT_EQ(hits[i].t, xs[i].GetIntersectDistance());
+      EXPECT_EQ(&wrapped.shapes[hits[i].shapeIndex], xs[i].shapePtr);
+    }
+    const auto hit = typed.ClosestHit(ray);
+    ASSERT_EQ(hit.has_value(), !xs.empty());
+    if (hit) {
+      EXPECT_EQ(hit->t, xs[0].GetIntersectDistance());
+    }
+    EXPECT_EQ(typed.Occluded(ray, 4), wrapped.Occluded(ray, 4));
+  }
+  ExpectSameColours(typed, wrapped, rays);
+}
+
+TEST(TypedWorld, instances_shade_their_geometry) {
+  std::vector<ShapeWrapper> parts;
+  parts.emplace_back(Sphere{MatrixUtils::Translation(-1, 0, 0)});
+  parts.emplace_back(Plane{MatrixUtils::Translation(0, -1, 0)});
+  const SharedGeometry geometry{std::move(parts)};
+  using Shapes = std::tuple<std::array<Instance, 2>>;
+  const Lights lights = TestLights();
+  const Instance first{geometry, MatrixUtils::RotateZ(0.3)};
+  const Instance second{geometry, MatrixUtils::Translation(0, 0, 5)};
+  TypedWorld<Shapes, Lights> typed{Shapes{{first, second}}, Lights(lights)};
+  World<std::array<ShapeWrapper, 2>, Lights> wrapped{
+      std::array<ShapeWrapper, 2>{first, second}, Lights(lights)};
+  const auto rays = SceneRays(300, 7);
+  for (const Ray& ray : rays) {
+    const auto hit = typed.ClosestHit(ray);
+    const auto expected = wrapped.ClosestHit(ray);
+    ASSERT_EQ(hit.has_value(), expected.has_value());
+    if (hit) {
+      EXPECT_EQ(hit->primIndex, expected->primIndex);
+    }
+  }
+  ExpectSameColours(typed, wrapped, rays);
+}
+
+TEST(TypedWorld, constexpr_render) {
+  constexpr static auto typed = TypedScene();
+  constexpr static auto wrapped = WrappedScene();
+  constexpr Ray center{MakePoint(0, 0, -5), MakeVector(0, 0, 1)};
+  constexpr Ray floor{MakePoint(0, 1.5, -5),
+                      MakeNormalizedVector(0.2, -0.5, 1)};
+  static_assert(typed.ColorAt(center) == wrapped.ColorAt(center));
+  static_assert(typed.ColorAt(floor) == wrapped.ColorAt(floor));
+  static_assert(typed.ClosestHit(floor)->shapeIndex == 3);
+}
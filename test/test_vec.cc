@@ -112,6 +112,12 @@ TEST(Vec, opeartor_div) {
   EXPECT_EQ(v4, v2);
 }
 
+TEST(Vec, checked_access) {
+  Vec<double, 3> v{1., 2., 3.};
+  EXPECT_THROW(v[3], std::out_of_range);
+  EXPECT_THROW(std::as_const(v)[3], std::out_of_range);
+}
+
 TEST(Vec, dot_product) {
   constexpr Vec v1{1.0, 2.0, 3.0};
   constexpr Vec v2{2.0, 4.0, 6.0};
@@ -394,3 +400,80 @@ TEST(Colour, valid) {
   constexpr Colour invalidC{1.2, -0.2, 0.4};
   EXPECT_FALSE(IsValidColour(invalidC));
 }
+
+TEST(Tuple, runtime_kernels_match_constexpr) {
+  // constexpr evaluation takes the scalar path, non-constant operands take the
+  // SIMD kernels, both must agree (including the untouched w component)
+  constexpr Tuple a = MakePoint(1.5, -2.0, 3.25);
+  constexpr Tuple b = MakeVector(-0.5, 4.0, 2.0);
+  constexpr Tuple n = MakeNormalizedVector(1, 1, 0);
+  // expressions are lazy, bind them to constexpr Tuples to fold them here
+  constexpr Tuple sum = a + b, diff = a - b, prod = a * b;
+  constexpr Tuple scaled = a * 3.0, divided = a / 4.0;
+  Tuple ra = a, rb = b, rn = n;
+  EXPECT_EQ(ra + rb, sum);
+  EXPECT_EQ(ra - rb, diff);
+  EXPECT_EQ(ra * rb, prod);
+  EXPECT_EQ(ra * 3.0, scaled);
+  EXPECT_EQ(3.0 * ra, scaled);
+  EXPECT_EQ(ra / 4.0, divided);
+  EXPECT_EQ((ra + rb)[TupleConstants::w], TupleConstants::PointFlag);
+  EXPECT_EQ((rb * 2.0)[TupleConstants::w], TupleConstants::VectorFlag);
+  EXPECT_DOUBLE_EQ(ra.DotProduct(rb), a.DotProduct(b));
+  EXPECT_EQ(ToVector(ra).CrossProduct(rb), ToVector(a).CrossProduct(b));
+  EXPECT_EQ(rb.Normalize(), b.Normalize());
+  EXPECT_EQ(ra.Normalize()[TupleConstants::w], TupleConstants::PointFlag);
+  EXPECT_EQ(rb.Reflect(rn), b.Reflect(n));
+  // nested trees are computed in registers and stored once, lane w included
+  constexpr Tuple nested = -(a - b * 0.75 + 2.0 * n) / 2.0;
+  const Tuple rnested = -(ra - rb * 0.75 + 2.0 * rn) / 2.0;
+  EXPECT_EQ(rnested, nested);
+  EXPECT_EQ(rnested[TupleConstants::w], TupleConstants::PointFlag);
+  const Tuple leftScalar = 2.0 * rb + ra;
+  EXPECT_EQ(leftScalar[TupleConstants::w], TupleConstants::VectorFlag);
+}
+
+TEST(Colour, runtime_kernels_match_constexpr) {
+  constexpr Colour c1{0.9, 0.6, 0.75};
+  constexpr Colour c2{0.7, 0.1, 0.25};
+  constexpr Colour sum = c1 + c2, diff = c1 - c2, prod = c1 * c2;
+  constexpr Colour scaled = c1 * 0.5;
+  Colour r1 = c1, r2 = c2;
+  EXPECT_EQ(r1 + r2, sum);
+  EXPECT_EQ(r1 - r2, diff);
+  EXPECT_EQ(r1 * r2, prod);
+  EXPECT_EQ(r1 * 0.5, scaled);
+  EXPECT_EQ(0.5 * r1, scaled);
+  constexpr Colour mixed = c1 * c2 + c1 * 0.5 - c2;
+  EXPECT_EQ(r1 * r2 + r1 * 0.5 - r2, mixed);
+  r1 += r2;
+  EXPECT_EQ(r1, sum);
+}
+
+TEST(Vec, expression_templates) {
+  // arithmetic yields lazy nodes, evaluated once converted to a Vec
+  constexpr Tuple point = MakePoint(1, 2, 3);
+  constexpr Tuple normal = MakeVector(0, 1, 0);
+  constexpr auto offset = point + normal * 0.5;
+  static_assert(!std::is_same_v<std::remove_cv_t<decltype(offset)>, Tuple>);
+  static_assert(VecUtils::LazyVec<decltype(offset)>);
+  constexpr Tuple evaluated = offset;
+  static_assert(evaluated == MakePoint(1, 2.5, 3));
+  static_assert(offset == MakePoint(1, 2.5, 3));
+  // lane w follows the vector operand through the whole tree
+  static_assert((-(normal * 2 - point))[TupleConstants::w] ==
+                TupleConstants::VectorFlag);
+  static_assert((2 * normal + point)[TupleConstants::w] ==
+                TupleConstants::VectorFlag);
+  static_assert(offset.Magnitude() == Tuple(offset).Magnitude());
+
+  constexpr Colour c{0.5, 0.25, 1};
+  constexpr Colour shaded = c * c + c * 0.5 - Colour{0.25, 0.25, 0.25};
+  static_assert(shaded == Colour{0.25, -0.0625, 1.25});
+
+  Tuple runtime = point;
+  runtime += normal * 0.5;
+  EXPECT_EQ(runtime, evaluated);
+  runtime -= runtime - point;
+  EXPECT_EQ(runtime, point);
+}
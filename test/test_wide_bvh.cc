@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <accel/wide_bvh.hh>
+#include <accel_test_utils.hh>
+#include <vector>
+#include <world.hh>
+using namespace RayTracer;
+using namespace RayTracer::AccelTestUtils;
+
+namespace {
+
+template <typename WideType>
+void ExpectValidTree(const WideType& wide,
+                     const std::vector<ShapeWrapper>& shapes) {
+  const auto& nodes = wide.GetNodes();
+  const auto& indices = wide.GetShapeIndices();
+  ASSERT_EQ(wide.GetUnbounded().size(), 1);
+  ASSERT_EQ(indices.size(), shapes.size() - 1);
+  std::vector<int> seen(shapes.size(), 0);
+  std::vector<int> parents(nodes.size(), 0);
+  for (const auto& node : nodes) {
+    ASSERT_GE(node.numChildren, 1);
+    ASSERT_LE(node.numChildren, nodes.size() > 1 ? 8 : 1);
+    for (std::size_t slot = 0; slot < node.numChildren; slot++) {
+      const BoundingBox bounds = node.GetBounds(slot);
+      if (node.count[slot] > 0) {
+        for (std::size_t j = 0; j < node.count[slot]; j++) {
+          const auto index = indices[node.child[slot] + j];
+          seen[index]++;
+          EXPECT_EQ(Union(bounds, shapes[index].WorldBounds()), bounds);
+        }
+      } else {
+        ASSERT_LT(node.child[slot], nodes.size());
+        parents[node.child[slot]]++;
+      }
+    }
+    // unused slots are never crossed
+    for (std::size_t slot = node.numChildren; slot < node.child.size(); slot++)
+      EXPECT_TRUE(node.GetBounds(slot).IsEmpty());
+  }
+  for (std::size_t i = 1; i < shapes.size(); i++)
+    EXPECT_EQ(seen[i], 1);
+  for (std::size_t i = 1; i < nodes.size(); i++)
+    EXPECT_EQ(parents[i], 1);
+}
+
+}  // namespace
+
+TEST(WideBVH, collapsed_nodes_cover_every_shape) {
+  const auto shapes = RandomShapes(600, 7);
+  const BVH binary{shapes};
+  const BVH4 wide4{shapes};
+  const BVH8 wide8{shapes};
+  ExpectValidTree(wide4, shapes);
+  ExpectValidTree(wide8, shapes);
+  // wider nodes, fewer of them
+  EXPECT_LT(wide4.GetNodes().size(), binary.GetNodes().size() / 2);
+  EXPECT_LT(wide8.GetNodes().size(), wide4.GetNodes().size());
+  // a collapsed LBVH is just as valid
+  BVH4 fromMorton;
+  fromMorton.Collapse(LBVH{shapes});
+  ExpectValidTree(fromMorton, shapes);
+}
+
+TEST(WideBVH, queries_match_linear_scan) {
+  const auto shapes = RandomShapes(400, 11);
+  ExpectSameQueries<BVH4>(shapes);
+  ExpectSameQueries<BVH8>(shapes);
+}
+
+TEST(WideBVH, degenerate_inputs) {
+  const Ray ray{MakePoint(0, 1, 0), MakeVector(0, -1, 0)};
+  const std::vector<ShapeWrapper> none;
+  EXPECT_FALSE(BVH4{none}.ClosestHit(none, ray).has_value());
+  std::vector<ShapeWrapper> planes;
+  planes.emplace_back(Plane{});
+  EXPECT_EQ(BVH8{planes}.ClosestHit(planes, ray)->t, 1);
+  // a single leaf ends up as the only child of the root
+  const std::vector<ShapeWrapper> one{ShapeWrapper{Sphere{}}};
+  const BVH4 single{one};
+  ASSERT_EQ(single.GetNodes().size(), 1);
+  EXPECT_EQ(single.GetNodes()[0].numChildren, 1);
+  EXPECT_EQ(single.ClosestHit(one, Ray{MakePoint(0, 0, -5),
+                                       MakeVector(0, 0, 1)})->t, 4);
+}
+
+TEST(WideBVH, constexpr_traversal_matches_run_time) {
+  // the scalar constant-evaluated node test agrees with the SIMD one
+  constexpr auto closest = [](bool wide8) {
+    std::vector<ShapeWrapper> shapes;
+    for (int i = 0; i < 20; i++) {
+      shapes.emplace_back(Sphere{MatrixUtils::Translation(
+          Real(3 * (i % 5)), Real(3 * (i / 5)), Real(i % 3))});
+    }
+    const Ray ray{MakePoint(6, 6, -10), MakeNormalizedVector(0.01, 0.02, 1)};
+    const auto hit = wide8 ? BVH8{shapes}.ClosestHit(shapes, ray)
+                           : BVH4{shapes}.ClosestHit(shapes, ray);
+    return hit ? hit->shapeIndex : std::uint32_t(-1);
+  };
+  static_assert(closest(false) == closest(true));
+  EXPECT_EQ(closest(false), 12u);
+  EXPECT_EQ(closest(true), 12u);
+}
+
+TEST(WideBVH, world_renders_like_binary_bvh_world) {
+  const auto shapes = RandomShapes(150, 3);
+  using Shapes = std::vector<ShapeWrapper>;
+  World<Shapes, Lights, 10, BVH> binaryWorld{Shapes(shapes), TestLights()};
+  World<Shapes, Lights, 10, BVH8> wideWorld{Shapes(shapes), TestLights()};
+  ExpectSameColours(wideWorld, binaryWorld, RandomRays(500, 5));
+  EXPECT_TRUE(wideWorld.UpdateAccelerator());
+}
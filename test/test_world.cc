@@ -42,6 +42,31 @@ TEST(World, intersect_world_with_a_ray) {
   EXPECT_EQ(xs.size(), 4);
 }
 
+TEST(World, closest_hit_matches_sorted_intersections) {
+  constexpr auto static defaultWorld = WorldUtils::DefaultWorld();
+  constexpr Ray ray{MakePoint(0, 0, -5), MakeVector(0, 0, 1)};
+  constexpr auto hit = defaultWorld.ClosestHit(ray);
+  static_assert(hit.has_value() && hit->GetIntersectDistance() == 4.0);
+  static_assert(hit->shapePtr == &defaultWorld.GetShapes()[0]);
+
+  // from inside both spheres, from behind them and missing them
+  for (const auto& [origin, direction] :
+       {std::pair{MakePoint(0, 0, 0), MakeVector(0, 0, 1)},
+        std::pair{MakePoint(0, 0, 0.75), MakeVector(0, 0, -1)},
+        std::pair{MakePoint(0, 0, 5), MakeVector(0, 0, 1)},
+        std::pair{MakePoint(0, 2, -5), MakeVector(0, 0, 1)},
+        std::pair{MakePoint(0.3, -0.2, -5), MakeNormalizedVector(0, 0.1, 1)}}) {
+    const Ray r{origin, direction};
+    const auto expected =
+        IntersectionUtils::VisibleHit(defaultWorld.IntersectWithRay(r));
+    const auto closest = defaultWorld.ClosestHit(r);
+    ASSERT_EQ(closest.has_value(), expected.has_value());
+    if (expected.has_value()) {
+      EXPECT_EQ(closest.value(), expected.value());
+    }
+  }
+}
+
 TEST(World, precompute_state_of_an_interdection) {
   constexpr auto static defaultWorld = WorldUtils::DefaultWorld();
   constexpr Tuple origin = MakePoint(0, 0, -5);
@@ -166,3 +191,72 @@ TEST(World, intersection_in_shadow) {
   constexpr auto colour = world.ShadeHit(hitRecord);
   EXPECT_EQ(colour, MakeColour(0.1, 0.1, 0.1));
 }
+
+TEST(World, occluded_any_hit_query) {
+  constexpr auto static defaultWorld = WorldUtils::DefaultWorld();
+  constexpr Ray ray{MakePoint(0, 0, -5), MakeVector(0, 0, 1)};
+  // the outer sphere is first hit at t = 4
+  static_assert(defaultWorld.Occluded(ray, 10));
+  static_assert(defaultWorld.Occluded(ray, 4.1));
+  static_assert(!defaultWorld.Occluded(ray, 3.9));
+  // hits behind the origin (or at it) do not occlude
+  constexpr Ray outward{MakePoint(0, 0, -1), MakeVector(0, 0, -1)};
+  static_assert(!defaultWorld.Occluded(outward, 100));
+  constexpr Ray miss{MakePoint(0, 2, -5), MakeVector(0, 0, 1)};
+  static_assert(!defaultWorld.Occluded(miss, 100));
+}
+
+TEST(World, shapes_append_into_hit_buffer) {
+  // the distance then the shape and primitive indices, without padding
+  static_assert(sizeof(Hit) == sizeof(Real) + 2 * sizeof(std::uint32_t));
+  constexpr auto static defaultWorld = WorldUtils::DefaultWorld();
+  constexpr auto hits = [] {
+    const Ray ray{MakePoint(0, 0, -5), MakeVector(0, 0, 1)};
+    HitBuffer<decltype(defaultWorld)::NumXS> buffer;
+    const auto& shapes = defaultWorld.GetShapes();
+    for (std::uint32_t i = 0; i < shapes.size(); i++)
+      shapes[i].IntersectInto(ray, i, buffer);
+    return buffer;
+  }();
+  // each shape appends its own hits from near to far, tagged with its index
+  static_assert(hits.size() == 4);
+  static_assert(hits[0].t == 4 && hits[0].shapeIndex == 0);
+  static_assert(hits[1].t == 6 && hits[1].shapeIndex == 0);
+  static_assert(hits[2].t == 4.5 && hits[2].shapeIndex == 1);
+  static_assert(hits[3].t == 5.5 && hits[3].shapeIndex == 1);
+  static_assert(defaultWorld.ToIntersection(hits[2]).shapePtr ==
+                &defaultWorld.GetShapes()[1]);
+}
+
+TEST(World, hit_lists_hold_every_hit) {
+  // 20 spheres in a row, each hit twice by a ray along the row
+  constexpr std::size_t count = 20;
+  using Lights = std::array<PointLight, 1>;
+  const Lights lights = {
+      PointLight(MakePoint(-10, 10, -10), MakeColour(1, 1, 1))};
+  std::vector<ShapeWrapper> row;
+  auto fixedRow = []<std::size_t... I>(std::index_sequence<I...>) {
+    return std::array<ShapeWrapper, count>{
+        ShapeWrapper{Sphere{MatrixUtils::Translation(0, 0, Real(3 * I))}}...};
+  }(std::make_index_sequence<count>{});
+  for (const ShapeWrapper& shape : fixedRow)
+    row.push_back(shape);
+  const Ray ray{MakePoint(0, 0, -5), MakeVector(0, 0, 1)};
+
+  // a std::vector of shapes collects its hits in a std::vector
+  const World<std::vector<ShapeWrapper>, Lights> world{std::move(row),
+                                                       Lights(lights)};
+  const auto xs = world.IntersectWithRay(ray);
+  ASSERT_EQ(xs.size(), 2 * count);
+  // a std::array of shapes sizes its buffer after them, whatever `NXs`
+  using FixedWorld = World<std::array<ShapeWrapper, count>, Lights>;
+  static_assert(FixedWorld::NumXS == 2 * count);
+  const FixedWorld fixedWorld{std::move(fixedRow), Lights(lights)};
+  const auto fixedXs = fixedWorld.IntersectWithRay(ray);
+  ASSERT_EQ(fixedXs.size(), 2 * count);
+  for (std::size_t i = 0; i < 2 * count; i++) {
+    const Real expected = 4 + 3 * Real(i / 2) + 2 * Real(i % 2);
+    EXPECT_EQ(xs[i].GetIntersectDistance(), expected);
+    EXPECT_EQ(fixedXs[i].GetIntersectDistance(), xs[i].GetIntersectDistance());
+  }
+}